@@ -2,208 +2,982 @@
 
 #include "AbilityFramework.h"
 #include "Effects/GAEffectCue.h"
+#include "Effects/GAEffectCueSequence.h"
+#include "ActorSequencePlayer.h"
+#include "GameFramework/PlayerController.h"
 #include "AFCueSet.h"
+#include "Effects/GAGameEffect.h"
+#include "Engine/AssetManager.h"
 #include "AFCueManager.h"
-#if WITH_EDITOR
-#include "Editor.H"
-#endif
 
-UAFCueManager* UAFCueManager::ManagerInstance = nullptr;
-//UWorld* UAFCueManager::CurrentWorld = nullptr;
+DEFINE_STAT(STAT_CuePoolHits);
+DEFINE_STAT(STAT_CuePoolMisses);
+DEFINE_STAT(STAT_DormantCues);
+DEFINE_STAT(STAT_ActiveCues);
+DEFINE_STAT(STAT_CueInstigators);
+DEFINE_STAT(STAT_CuesEvicted);
+DEFINE_STAT(STAT_CuePoolMemory);
+DEFINE_STAT(STAT_CuesStarted);
+DEFINE_STAT(STAT_CuesCulled);
+DEFINE_STAT(STAT_CuesDeferred);
+DEFINE_STAT(STAT_PendingCues);
+DEFINE_STAT(STAT_HandleCue);
+DEFINE_STAT(STAT_CuesHandled);
+DEFINE_STAT(STAT_SpawnCue);
+DEFINE_STAT(STAT_CueClassesStreamed);
+DEFINE_STAT(STAT_CuesNotResident);
+DEFINE_STAT(STAT_TickCueSequences);
+DEFINE_STAT(STAT_CueSequencesEvaluated);
+DEFINE_STAT(STAT_CueSequencesShared);
 
-UAFCueManager* UAFCueManager::Get()
+static FAutoConsoleCommandWithWorldArgsAndOutputDevice CmdCueStats(
+	TEXT("AbilityFramework.Cues.Stats"),
+	TEXT("Prints cue counters of current world: handled cues per tag, pool hits and misses, average spawn time.\n")
+	TEXT("AbilityFramework.Cues.Stats reset - clears counters."),
+	FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* InWorld, FOutputDevice& Ar)
 {
-	if (ManagerInstance)
+	//only inspects, doesn't create manager (and it's pools and tick) for world which has none.
+	UAFCueManager* Manager = UAFCueManager::Find(InWorld);
+	if (!Manager)
 	{
-		return ManagerInstance;
+		Ar.Logf(TEXT("No cue manager in %s"), *GetNameSafe(InWorld));
+		return;
 	}
-	ManagerInstance = NewObject<UAFCueManager>(GEngine, UAFCueManager::StaticClass(), "UAFCueManagerInstance",
+	if (Args.Num() > 0 && Args[0] == TEXT("reset"))
+	{
+		Manager->ResetCounters();
+		return;
+	}
+	Manager->DumpCounters(Ar);
+}));
+
+void FAFCueManagerTickFunction::ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent)
+{
+	if (Manager)
+	{
+		Manager->TickPendingCues();
+		Manager->TickSequenceGroups(DeltaTime);
+	}
+}
+
+FString FAFCueManagerTickFunction::DiagnosticMessage()
+{
+	return FString(TEXT("UAFCueManager[TickPendingCues]"));
+}
+
+TMap<FObjectKey, UAFCueManager*> UAFCueManager::WorldManagers;
+TSet<FObjectKey> UAFCueManager::CleanedUpWorlds;
+TSharedPtr<FStreamableHandle> UAFCueManager::DefaultCueSetHandle;
+
+UAFCueManager::UAFCueManager(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	World = nullptr;
+	DefaultPrewarmCount = 0;
+	MaxIdleCues = 256;
+	MaxIdleCuesPerTag = 32;
+	NumIdleCues = 0;
+	NumActiveCues = 0;
+	MaxCueStartsPerFrame = 0;
+	SequenceShareFrames = 2;
+	NextPendingId = 1;
+	StartsThisFrame = 0;
+	StartsFrame = 0;
+	ViewLocationsFrame = MAX_uint64;
+	CueSetLoadStartTime = 0;
+	NumPoolHits = 0;
+	NumPoolMisses = 0;
+	NumEvicted = 0;
+	NumSpawns = 0;
+	SpawnCycles = 0;
+	TickFunction.Manager = this;
+	TickFunction.TickGroup = TG_PrePhysics;
+	TickFunction.bCanEverTick = true;
+	TickFunction.bStartWithTickEnabled = true;
+}
+void UAFCueManager::AddReferencedObjects(UObject* InThis, FReferenceCollector& Collector)
+{
+	UAFCueManager* This = CastChecked<UAFCueManager>(InThis);
+	for (auto It = This->InstancedCues.CreateIterator(); It; ++It)
+	{
+		for (FAFIdleCue& Idle : It->Value)
+		{
+			Collector.AddReferencedObject(Idle.Cue, This);
+		}
+	}
+	for (auto It = This->UsedCues.CreateIterator(); It; ++It)
+	{
+		for (auto TagIt = It->Value.CreateIterator(); TagIt; ++TagIt)
+		{
+			for (FAFUsedCue& Used : TagIt->Value)
+			{
+				Collector.AddReferencedObject(Used.Cue, This);
+			}
+		}
+	}
+	for (FAFCueSequenceGroup& Group : This->SequenceGroups)
+	{
+		for (FAFCueSequenceMember& Member : Group.Members)
+		{
+			Collector.AddReferencedObject(Member.Cue, This);
+		}
+	}
+	Super::AddReferencedObjects(InThis, Collector);
+}
+
+UAFCueManager* UAFCueManager::Get(UWorld* InWorld)
+{
+	if (!InWorld)
+	{
+		return nullptr;
+	}
+	if (UAFCueManager** Manager = WorldManagers.Find(FObjectKey(InWorld)))
+	{
+		return *Manager;
+	}
+	//don't register new tick on world which is going away.
+	if (InWorld->bIsTearingDown || CleanedUpWorlds.Contains(FObjectKey(InWorld)))
+	{
+		return nullptr;
+	}
+	UAFCueManager* Manager = NewObject<UAFCueManager>(GEngine, UAFCueManager::StaticClass(), NAME_None,
 		RF_MarkAsRootSet);
-	ManagerInstance->AddToRoot();
-	ManagerInstance->Initialize();
-	ManagerInstance->LoadCueSet();
+	Manager->AddToRoot();
+	Manager->Initialize(InWorld);
+	WorldManagers.Add(FObjectKey(InWorld), Manager);
+#if WITH_AF_CUES
+	Manager->LoadCueSet();
+#endif //WITH_AF_CUES
 
-	return ManagerInstance;
+	return Manager;
+}
+UAFCueManager* UAFCueManager::Find(UWorld* InWorld)
+{
+	UAFCueManager** Manager = InWorld ? WorldManagers.Find(FObjectKey(InWorld)) : nullptr;
+	return Manager ? *Manager : nullptr;
 }
-void UAFCueManager::Initialize()
+void UAFCueManager::Initialize(UWorld* InWorld)
 {
-#if WITH_EDITOR
-	FEditorDelegates::EndPIE.AddUObject(this, &UAFCueManager::HandleOnPIEEnd);
-#endif //WITH_EDITOR
+	World = InWorld;
+	if (World->PersistentLevel)
+	{
+		TickFunction.RegisterTickFunction(World->PersistentLevel);
+	}
 }
 void UAFCueManager::LoadCueSet()
 {
-	CueSet = DefaultCueSet.LoadSynchronous();
+	if (CueSet || CueSetHandle.IsValid() || DefaultCueSet.IsNull())
+	{
+		return;
+	}
+	//loaded on engine init, or by other world.
+	if (UAFCueSet* LoadedCueSet = DefaultCueSet.Get())
+	{
+		CueSet = LoadedCueSet;
+		return;
+	}
+	//no asset manager in commandlets.
+	if (!UAssetManager::IsValid())
+	{
+		CueSet = DefaultCueSet.LoadSynchronous();
+		return;
+	}
+	CueSetLoadStartTime = FPlatformTime::Seconds();
+	CueSetHandle = UAssetManager::GetStreamableManager().RequestAsyncLoad(DefaultCueSet.ToStringReference(),
+		FStreamableDelegate::CreateUObject(this, &UAFCueManager::HandleCueSetLoaded), FStreamableManager::AsyncLoadHighPriority);
+}
+void UAFCueManager::HandleCueSetLoaded()
+{
+	CueSet = DefaultCueSet.Get();
+	UE_LOG(AbilityFramework, Log, TEXT("UAFCueManager: %s loaded in %.2f ms"), *DefaultCueSet.ToString(),
+		(FPlatformTime::Seconds() - CueSetLoadStartTime) * 1000.0);
+	//world started before cue set was there.
+	if (CueSet && World)
+	{
+		Prewarm();
+	}
+}
+void UAFCueManager::HandlePostEngineInit()
+{
+#if WITH_AF_CUES
+	const TAssetPtr<UAFCueSet>& CueSetPtr = GetDefault<UAFCueManager>()->DefaultCueSet;
+	if (CueSetPtr.IsNull() || DefaultCueSetHandle.IsValid() || !UAssetManager::IsValid())
+	{
+		return;
+	}
+	DefaultCueSetHandle = UAssetManager::GetStreamableManager().RequestAsyncLoad(CueSetPtr.ToStringReference(),
+		FStreamableDelegate(), FStreamableManager::AsyncLoadHighPriority);
+#endif //WITH_AF_CUES
+}
+void UAFCueManager::SetCueSet(UAFCueSet* InCueSet)
+{
+	ClearPools(true);
+	if (CueSetHandle.IsValid())
+	{
+		CueSetHandle->CancelHandle();
+		CueSetHandle.Reset();
+	}
+	CueClassHandles.Empty();
+	CueSet = InCueSet;
+}
+TSubclassOf<AGAEffectCue> UAFCueManager::GetCueClass(const FGameplayTag& InTag, TAsyncLoadPriority InPriority)
+{
+	const TAssetSubclassOf<AGAEffectCue>* CueClassPtr = CueSet ? CueSet->CueClasses.Find(InTag) : nullptr;
+	if (!CueClassPtr || CueClassPtr->IsNull())
+	{
+		return nullptr;
+	}
+	if (UClass* CueClass = CueClassPtr->Get())
+	{
+		return CueClass;
+	}
+	//already streaming.
+	if (CueClassHandles.Contains(InTag) || !UAssetManager::IsValid())
+	{
+		return nullptr;
+	}
+	CueClassHandles.Add(InTag, UAssetManager::GetStreamableManager().RequestAsyncLoad(CueClassPtr->ToStringReference(),
+		FStreamableDelegate::CreateUObject(this, &UAFCueManager::HandleCueClassLoaded, InTag), InPriority));
+	INC_DWORD_STAT(STAT_CueClassesStreamed);
+	return nullptr;
+}
+void UAFCueManager::HandleCueClassLoaded(FGameplayTag InTag)
+{
+	const TAssetSubclassOf<AGAEffectCue>* CueClassPtr = CueSet ? CueSet->CueClasses.Find(InTag) : nullptr;
+	if (!CueClassPtr || !CueClassPtr->Get())
+	{
+		UE_LOG(AbilityFramework, Warning, TEXT("UAFCueManager: failed to load cue %s for %s"),
+			CueClassPtr ? *CueClassPtr->ToString() : TEXT("None"), *InTag.ToString());
+		return;
+	}
+	if (World)
+	{
+		PrewarmTag(InTag, CueClassPtr->Get());
+		UpdatePoolStats();
+	}
+}
+void UAFCueManager::PreloadCues(const FGameplayTagContainer& InTags)
+{
+	for (const FGameplayTag& Tag : InTags)
+	{
+		GetCueClass(Tag, FStreamableManager::AsyncLoadHighPriority);
+	}
+}
+void UAFCueManager::PreloadAbilityCues(UClass* InAbilityClass)
+{
+	if (!InAbilityClass || !CueSet)
+	{
+		return;
+	}
+	UObject* AbilityCDO = InAbilityClass->GetDefaultObject();
+	FGameplayTagContainer CueTags;
+	for (TFieldIterator<UStructProperty> It(InAbilityClass); It; ++It)
+	{
+		if (It->Struct != FGAEffectProperty::StaticStruct())
+		{
+			continue;
+		}
+		const FGAEffectProperty* EffectProperty = It->ContainerPtrToValuePtr<FGAEffectProperty>(AbilityCDO);
+		if (UGAGameEffectSpec* Spec = EffectProperty->GetClass().GetDefaultObject())
+		{
+			CueTags.AppendTags(Spec->Cues.CueTags);
+		}
+	}
+	PreloadCues(CueTags);
+}
+void UAFCueManager::HandleWorldCleanup(UWorld* InWorld, bool bSessionEnded, bool bCleanupResources)
+{
+	//forget destroyed worlds.
+	for (auto It = CleanedUpWorlds.CreateIterator(); It; ++It)
+	{
+		if (!It->ResolveObjectPtr())
+		{
+			It.RemoveCurrent();
+		}
+	}
+	CleanedUpWorlds.Add(FObjectKey(InWorld));
+	UAFCueManager* Manager = nullptr;
+	if (!WorldManagers.RemoveAndCopyValue(FObjectKey(InWorld), Manager) || !Manager)
+	{
+		return;
+	}
+	//actors are going away with the world.
+	Manager->ClearPools(false);
+	if (Manager->TickFunction.IsTickFunctionRegistered())
+	{
+		Manager->TickFunction.UnRegisterTickFunction();
+	}
+	if (Manager->CueSetHandle.IsValid())
+	{
+		Manager->CueSetHandle->CancelHandle();
+	}
+	Manager->World = nullptr;
+	Manager->RemoveFromRoot();
+	Manager->UpdatePoolStats();
 }
-#if WITH_EDITOR
-void UAFCueManager::HandleOnPIEEnd(bool InVal)
+void UAFCueManager::ClearPools(bool bDestroyActors)
 {
-	CurrentWorld = nullptr;
 	for (auto It = InstancedCues.CreateIterator(); It; ++It)
 	{
-		if (It->Value.IsValid())
+		for (FAFIdleCue& Idle : It->Value)
 		{
-			while (!It->Value->IsEmpty())
+			if (Idle.Cue && bDestroyActors)
 			{
-				AGAEffectCue* ToDestroy = nullptr;
-				It->Value->Dequeue(ToDestroy);
-				if (ToDestroy)
-				{
-					ToDestroy->Destroy();
-				}
+				Idle.Cue->Destroy();
 			}
 		}
 	}
 	for (auto It = UsedCues.CreateIterator(); It; ++It)
 	{
-		if (It->Value.Num() <= 0)
+		if (AActor* Instigator = Cast<AActor>(It->Key.ResolveObjectPtr()))
 		{
-			UsedCues.Remove(It->Key);
+			Instigator->OnDestroyed.RemoveDynamic(this, &UAFCueManager::HandleInstigatorDestroyed);
 		}
-		for (auto QIt = It->Value.CreateIterator(); QIt; ++QIt)
+		for (auto TagIt = It->Value.CreateIterator(); TagIt; ++TagIt)
 		{
-			if (QIt->Value.IsValid())
+			for (const FAFUsedCue& Used : TagIt->Value)
 			{
-				while (!QIt->Value->IsEmpty())
+				if (Used.Cue && bDestroyActors)
 				{
-					AGAEffectCue* ToDestroy = nullptr;
-					QIt->Value->Dequeue(ToDestroy);
-					if (ToDestroy)
-					{
-						ToDestroy->Destroy();
-					}
+					Used.Cue->Destroy();
 				}
 			}
-			if (It->Value.Num() <= 0)
-			{
-				UsedCues.Remove(It->Key);
-			}
 		}
-		
 	}
+	InstancedCues.Empty();
+	UsedCues.Empty();
+	PendingCues.Empty();
+	SequenceGroups.Empty();
+	ActiveCuesPerTag.Empty();
+	NumIdleCues = 0;
+	NumActiveCues = 0;
+	UpdatePoolStats();
+}
+void UAFCueManager::HandlePostWorldInitialization(UWorld* InWorld, const UWorld::InitializationValues IVS)
+{
+	//world can be initialized again after cleanup.
+	CleanedUpWorlds.Remove(FObjectKey(InWorld));
+#if WITH_AF_CUES
+	//cues are cosmetic.
+	if (!InWorld || !InWorld->IsGameWorld() || IsRunningDedicatedServer())
+	{
+		return;
+	}
+	if (UAFCueManager* Manager = UAFCueManager::Get(InWorld))
+	{
+		Manager->Prewarm();
+	}
+#endif //WITH_AF_CUES
+}
+void UAFCueManager::Prewarm()
+{
+	//pre-warmed from HandleCueSetLoaded.
+	if (!CueSet || !World)
+	{
+		return;
+	}
+	for (auto It = CueSet->CueClasses.CreateConstIterator(); It; ++It)
+	{
+		const int32* Count = CueSet->PrewarmCounts.Find(It->Key);
+		if ((Count ? *Count : DefaultPrewarmCount) <= 0)
+		{
+			continue;
+		}
+		//not resident ones are pre-warmed from HandleCueClassLoaded.
+		if (TSubclassOf<AGAEffectCue> CueClass = GetCueClass(It->Key, FStreamableManager::DefaultAsyncLoadPriority))
+		{
+			PrewarmTag(It->Key, CueClass);
+		}
+	}
+	UpdatePoolStats();
+}
+void UAFCueManager::PrewarmTag(const FGameplayTag& InTag, TSubclassOf<AGAEffectCue> InCueClass)
+{
+	const int32* Count = CueSet->PrewarmCounts.Find(InTag);
+	int32 NumToSpawn = Count ? *Count : DefaultPrewarmCount;
+	if (MaxIdleCuesPerTag > 0)
+	{
+		NumToSpawn = FMath::Min(NumToSpawn, MaxIdleCuesPerTag);
+	}
+	TArray<FAFIdleCue>& Cues = InstancedCues.FindOrAdd(InTag);
+	NumToSpawn -= Cues.Num();
+	if (MaxIdleCues > 0)
+	{
+		NumToSpawn = FMath::Min(NumToSpawn, MaxIdleCues - NumIdleCues);
+	}
+	const double Now = FPlatformTime::Seconds();
+	for (int32 Idx = 0; Idx < NumToSpawn; Idx++)
+	{
+		if (AGAEffectCue* Cue = SpawnCue(InCueClass, FVector::ZeroVector, FRotator::ZeroRotator))
+		{
+			FAFIdleCue Idle;
+			Idle.Cue = Cue;
+			Idle.ReleaseTime = Now;
+			Cues.Add(Idle);
+			NumIdleCues++;
+		}
+	}
+}
+AGAEffectCue* UAFCueManager::SpawnCue(TSubclassOf<AGAEffectCue> InCueClass, const FVector& InLocation, const FRotator& InRotation)
+{
+	SCOPE_CYCLE_COUNTER(STAT_SpawnCue);
+	const uint32 StartCycles = FPlatformTime::Cycles();
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	SpawnParams.ObjectFlags |= RF_Transient;
+	AGAEffectCue* Cue = World->SpawnActor<AGAEffectCue>(InCueClass, InLocation, InRotation, SpawnParams);
+	if (Cue)
+	{
+		Cue->SetManagedSequence(true);
+		Cue->SetDormant(true);
+	}
+	NumSpawns++;
+	SpawnCycles += FPlatformTime::Cycles() - StartCycles;
+	return Cue;
 }
-#endif //WITH_EDITOR
 void UAFCueManager::HandleCue(const FGameplayTagContainer& Tags, 
 	const FGAEffectCueParams& CueParams)
 {
-	if (!CurrentWorld)
-		CurrentWorld = CueParams.Instigator->GetWorld();
+#if WITH_AF_CUES
+	SCOPE_CYCLE_COUNTER(STAT_HandleCue);
+	if (!CueSet || !World)
+		return;
 	for (const FGameplayTag& Tag : CueParams.CueTags)
 	{
-		TSubclassOf<AGAEffectCue> CueClass = CueSet->Cues.FindRef(Tag);
+		//still streaming, this event is not played.
+		TSubclassOf<AGAEffectCue> CueClass = GetCueClass(Tag, FStreamableManager::AsyncLoadHighPriority);
 		if (!CueClass)
+		{
+			if (CueSet->CueClasses.Contains(Tag))
+			{
+				INC_DWORD_STAT(STAT_CuesNotResident);
+			}
 			continue;
+		}
 		
-		ENetRole mode = CueParams.Instigator->GetRemoteRole();
-		FString role;
-		switch (mode)
-		{
-		case ROLE_None:
-			role = "ROLE_None";
-			break;
-		case ROLE_SimulatedProxy:
-			role = "ROLE_SimulatedProxy";
-			break;
-		case ROLE_AutonomousProxy:
-			role = "ROLE_AutonomousProxy";
-			break;
-		case ROLE_Authority:
-			role = "ROLE_Authority";
-			break;
-		case ROLE_MAX:
-			role = "ROLE_MAX";
-			break;
-		default:
-			break;
+		HandledPerTag.FindOrAdd(Tag)++;
+		INC_DWORD_STAT(STAT_CuesHandled);
+		UE_LOG(AFCues, Verbose, TEXT("HandleCue: %s, Instigator: %s, Location: %s, World: %s"),
+			*Tag.ToString(), *GetNameSafe(CueParams.Instigator.Get()), *CueParams.HitResult.Location.ToString(), *World->GetName());
+
+		FAFUsedCue Used;
+		if (!IsCueRelevant(Tag, CueParams.HitResult.Location))
+		{
+			INC_DWORD_STAT(STAT_CuesCulled);
+		}
+		//something is already waiting, it goes through the queue so priority and order are kept.
+		else if (PendingCues.Num() > 0 || !HasStartBudget())
+		{
+			const FAFCueRelevancy* Relevancy = CueSet->Relevancy.Find(Tag);
+			FAFPendingCue& Pending = PendingCues[PendingCues.AddDefaulted()];
+			Pending.Id = NextPendingId++;
+			Pending.Priority = Relevancy ? Relevancy->Priority : 0;
+			Pending.Tag = Tag;
+			Pending.CueClass = CueClass;
+			Pending.CueParams = CueParams;
+			Used.PendingId = Pending.Id;
+			INC_DWORD_STAT(STAT_CuesDeferred);
+		}
+		else
+		{
+			Used.Cue = StartCue(Tag, CueClass, CueParams);
 		}
 
-		FString prefix = "";
-		if (mode == ENetMode::NM_Client)
+		FObjectKey InstigatorKey(CueParams.Instigator.Get());
+		TMap<FGameplayTag, TArray<FAFUsedCue>>* UsedCuesMap = UsedCues.Find(InstigatorKey);
+		if (!UsedCuesMap)
 		{
-			prefix = FString::Printf(TEXT("Client %d: "), GPlayInEditorID - 1);
+			UsedCuesMap = &UsedCues.Add(InstigatorKey);
+			if (CueParams.Instigator.IsValid())
+			{
+				CueParams.Instigator->OnDestroyed.AddUniqueDynamic(this, &UAFCueManager::HandleInstigatorDestroyed);
+			}
 		}
+		UsedCuesMap->FindOrAdd(Tag).Add(Used);
+	}
+	UpdatePoolStats();
+#endif //WITH_AF_CUES
+}
+void UAFCueManager::HandleRemoveCue(const FGameplayTagContainer& Tags,
+	const FGAEffectCueParams& CueParams)
+{
+#if WITH_AF_CUES
+	if (!CueSet || !World)
+		return;
+	for (const FGameplayTag& Tag : CueParams.CueTags)
+	{
+		//cues which were not resident are not in UsedCues either.
+		if (!CueSet->CueClasses.Contains(Tag))
+			continue;
 
-		UE_LOG(AbilityFramework, Log, TEXT("%s : CueManager HandleCue: %s, Instigator: %s, Location: %s, World: %s, Role: %s"),
-			*prefix,
-			*Tag.ToString(),
-			CueParams.Instigator.IsValid() ? *CueParams.Instigator->GetName() : TEXT("Invalid Instigator"),
-			*CueParams.HitResult.Location.ToString(),
-			*CurrentWorld->GetName(),
-			*role
-		);
+		FObjectKey InstigatorKey(CueParams.Instigator.Get());
+		TMap<FGameplayTag, TArray<FAFUsedCue>>* UsedCuesMap = UsedCues.Find(InstigatorKey);
+		TArray<FAFUsedCue>* UsedCuesQueue = UsedCuesMap ? UsedCuesMap->Find(Tag) : nullptr;
+		if (!UsedCuesQueue || UsedCuesQueue->Num() == 0)
+			continue;
 
-		FActorSpawnParameters SpawnParams;
-		FVector Location = CueParams.HitResult.Location;
-		FRotator Rotation = FRotator::ZeroRotator;
-		AGAEffectCue* actor = nullptr;
-		TUniquePtr<TQueue<AGAEffectCue*>>& Cues = InstancedCues.FindOrAdd(Tag);
-		if (!Cues.IsValid())
+		const FAFUsedCue Used = (*UsedCuesQueue)[0];
+		UsedCuesQueue->RemoveAt(0, 1, false);
+		if (UsedCuesQueue->Num() == 0)
 		{
-			Cues = MakeUnique<TQueue<AGAEffectCue*>>();
+			UsedCuesMap->Remove(Tag);
 		}
-		FObjectKey InstigatorKey(CueParams.Instigator.Get());
-		TMap<FGameplayTag, TUniquePtr<TQueue<AGAEffectCue*>>>& UsedCuesMap = UsedCues.FindOrAdd(InstigatorKey);
-		TUniquePtr<TQueue<AGAEffectCue*>>& UseCuesQueue = UsedCuesMap.FindOrAdd(Tag);
+		if (UsedCuesMap->Num() == 0)
+		{
+			if (CueParams.Instigator.IsValid())
+			{
+				CueParams.Instigator->OnDestroyed.RemoveDynamic(this, &UAFCueManager::HandleInstigatorDestroyed);
+			}
+			UsedCues.Remove(InstigatorKey);
+		}
+		StopCue(Tag, Used);
+	}
+	UpdatePoolStats();
+#endif //WITH_AF_CUES
+}
 
-		if (!UseCuesQueue.IsValid())
+AGAEffectCue* UAFCueManager::StartCue(const FGameplayTag& InTag, TSubclassOf<AGAEffectCue> InCueClass, const FGAEffectCueParams& InCueParams)
+{
+	FVector Location = InCueParams.HitResult.Location;
+	FRotator Rotation = FRotator::ZeroRotator;
+	AGAEffectCue* actor = AcquireCue(InTag);
+	if (actor)
+	{
+		INC_DWORD_STAT(STAT_CuePoolHits);
+		NumPoolHits++;
+		actor->SetActorLocationAndRotation(Location, Rotation);
+	}
+	else
+	{
+		INC_DWORD_STAT(STAT_CuePoolMisses);
+		NumPoolMisses++;
+		actor = SpawnCue(InCueClass, Location, Rotation);
+	}
+	if (!actor)
+	{
+		return nullptr;
+	}
+	NumActiveCues++;
+	ActiveCuesPerTag.FindOrAdd(InTag)++;
+	StartsThisFrame++;
+	INC_DWORD_STAT(STAT_CuesStarted);
+	actor->SetDormant(false);
+	
+	actor->NativeBeginCue(InCueParams.Instigator.Get(), InCueParams.HitResult.Actor.Get(),
+		InCueParams.Causer.Get(), InCueParams.HitResult, InCueParams);
+	AddToSequenceGroup(actor);
+	return actor;
+}
+void UAFCueManager::StopCue(const FGameplayTag& InTag, const FAFUsedCue& InUsedCue)
+{
+	if (InUsedCue.PendingId != 0)
+	{
+		RemovePendingCue(InUsedCue.PendingId);
+		return;
+	}
+	if (!InUsedCue.Cue)
+	{
+		//culled.
+		return;
+	}
+	NumActiveCues--;
+	if (int32* ActiveCount = ActiveCuesPerTag.Find(InTag))
+	{
+		(*ActiveCount)--;
+	}
+	RemoveFromSequenceGroup(InUsedCue.Cue);
+	if (!InUsedCue.Cue->IsPendingKill())
+	{
+		InUsedCue.Cue->NativeOnRemoved();
+		ReleaseCue(InTag, InUsedCue.Cue);
+	}
+}
+void UAFCueManager::AddToSequenceGroup(AGAEffectCue* InCue)
+{
+	if (!InCue->SequencePlayer)
+	{
+		return;
+	}
+	FAFCueSequenceMember Member;
+	Member.Cue = InCue;
+	TInlineComponentArray<USceneComponent*> Components(InCue);
+	for (USceneComponent* Component : Components)
+	{
+		if (Component != InCue->GetRootComponent())
 		{
-			UseCuesQueue = MakeUnique<TQueue<AGAEffectCue*>>();
+			Member.Components.Add(Component);
 		}
-		
-		if (Cues->IsEmpty())
+	}
+	UObject* SequenceArchetype = InCue->Sequence ? InCue->Sequence->GetArchetype() : nullptr;
+	const bool bShared = InCue->bShareSequenceEvaluation && SequenceShareFrames > 0;
+	if (bShared)
+	{
+		for (FAFCueSequenceGroup& Group : SequenceGroups)
 		{
-			actor = CurrentWorld->SpawnActor<AGAEffectCue>(CueClass, Location, Rotation, SpawnParams);
-			Cues->Enqueue(actor);
-			Cues->Dequeue(actor);
-			UseCuesQueue->Enqueue(actor);
+			if (!Group.bShared || Group.CueClass != InCue->GetClass() || Group.SequenceArchetype != SequenceArchetype
+				|| GFrameCounter - Group.StartFrame >= (uint64)SequenceShareFrames)
+			{
+				continue;
+			}
+			//components added at runtime, can't be mapped to leader.
+			if (Group.Members[0].Components.Num() != Member.Components.Num())
+			{
+				continue;
+			}
+			Group.Members.Add(Member);
+			return;
 		}
-		else
+	}
+	FAFCueSequenceGroup& Group = SequenceGroups[SequenceGroups.AddDefaulted()];
+	Group.CueClass = InCue->GetClass();
+	Group.SequenceArchetype = SequenceArchetype;
+	Group.StartFrame = GFrameCounter;
+	Group.bShared = bShared;
+	Group.Members.Add(Member);
+}
+void UAFCueManager::RemoveFromSequenceGroup(AGAEffectCue* InCue)
+{
+	for (int32 GroupIdx = 0; GroupIdx < SequenceGroups.Num(); GroupIdx++)
+	{
+		FAFCueSequenceGroup& Group = SequenceGroups[GroupIdx];
+		const int32 MemberIdx = Group.Members.IndexOfByPredicate([InCue](const FAFCueSequenceMember& Member) { return Member.Cue == InCue; });
+		if (MemberIdx == INDEX_NONE)
 		{
-			Cues->Dequeue(actor);
-			UseCuesQueue->Enqueue(actor);
+			continue;
 		}
-		
-		//actor = CurrentWorld->SpawnActor<AGAEffectCue>(CueClass, Location, Rotation, SpawnParams);
-		actor->NativeBeginCue(CueParams.Instigator.Get(), CueParams.HitResult.Actor.Get(),
-			CueParams.Causer.Get(), CueParams.HitResult, CueParams);
-
-		/*UseCues->Dequeue(actor);
-		Cues->Enqueue(actor);*/
+		//next member takes over from where leader was.
+		if (MemberIdx == 0 && Group.Members.Num() > 1 && InCue->SequencePlayer && Group.Members[1].Cue)
+		{
+			Group.Members[1].Cue->SequencePlayer->JumpToPosition(InCue->SequencePlayer->GetPlaybackPosition());
+		}
+		Group.Members.RemoveAt(MemberIdx);
+		if (Group.Members.Num() == 0)
+		{
+			SequenceGroups.RemoveAtSwap(GroupIdx);
+		}
+		return;
 	}
 }
-void UAFCueManager::HandleRemoveCue(const FGameplayTagContainer& Tags,
-	const FGAEffectCueParams& CueParams)
+void UAFCueManager::TickSequenceGroups(float InDeltaTime)
 {
-	if (!CurrentWorld)
-		CurrentWorld = CueParams.Instigator->GetWorld();
-	for (const FGameplayTag& Tag : CueParams.CueTags)
+	SCOPE_CYCLE_COUNTER(STAT_TickCueSequences);
+	for (int32 GroupIdx = SequenceGroups.Num() - 1; GroupIdx >= 0; GroupIdx--)
 	{
-		TSubclassOf<AGAEffectCue> CueClass = CueSet->Cues.FindRef(Tag);
-		if (!CueClass)
+		FAFCueSequenceGroup& Group = SequenceGroups[GroupIdx];
+		//destroyed outside of manager.
+		Group.Members.RemoveAll([](const FAFCueSequenceMember& Member) { return !Member.Cue || Member.Cue->IsPendingKill(); });
+		if (Group.Members.Num() == 0)
+		{
+			SequenceGroups.RemoveAtSwap(GroupIdx);
 			continue;
-
-		AGAEffectCue* actor = nullptr;
-		TUniquePtr<TQueue<AGAEffectCue*>>& Cues = InstancedCues.FindOrAdd(Tag);
-		if (!Cues.IsValid())
+		}
+		UActorSequencePlayer* Player = Group.Members[0].Cue->SequencePlayer;
+		Player->Update(InDeltaTime);
+		INC_DWORD_STAT(STAT_CueSequencesEvaluated);
+		const TArray<USceneComponent*>& LeaderComponents = Group.Members[0].Components;
+		for (int32 MemberIdx = 1; MemberIdx < Group.Members.Num(); MemberIdx++)
 		{
-			Cues = MakeUnique<TQueue<AGAEffectCue*>>();
+			TArray<USceneComponent*>& Components = Group.Members[MemberIdx].Components;
+			for (int32 ComponentIdx = 0; ComponentIdx < Components.Num(); ComponentIdx++)
+			{
+				USceneComponent* Source = LeaderComponents[ComponentIdx];
+				USceneComponent* Target = Components[ComponentIdx];
+				if (!Source || !Target)
+				{
+					continue;
+				}
+				const FTransform& SourceTransform = Source->GetRelativeTransform();
+				if (!Target->GetRelativeTransform().Equals(SourceTransform))
+				{
+					Target->SetRelativeTransform(SourceTransform);
+				}
+				if (Target->bVisible != Source->bVisible)
+				{
+					Target->SetVisibility(Source->bVisible);
+				}
+			}
 		}
-		FObjectKey InstigatorKey(CueParams.Instigator.Get());
-		TMap<FGameplayTag, TUniquePtr<TQueue<AGAEffectCue*>>>& UsedCuesMap = UsedCues.FindOrAdd(InstigatorKey);
-		TUniquePtr<TQueue<AGAEffectCue*>>& UseCuesQueue = UsedCuesMap.FindOrAdd(Tag);
-
-		if (!UseCuesQueue.IsValid())
+		INC_DWORD_STAT_BY(STAT_CueSequencesShared, Group.Members.Num() - 1);
+		if (!Player->IsPlaying())
 		{
-			UseCuesQueue = MakeUnique<TQueue<AGAEffectCue*>>();
+			SequenceGroups.RemoveAtSwap(GroupIdx);
 		}
+	}
+}
+bool UAFCueManager::IsCueRelevant(const FGameplayTag& InTag, const FVector& InLocation)
+{
+	const FAFCueRelevancy* Relevancy = CueSet->Relevancy.Find(InTag);
+	if (!Relevancy)
+	{
+		return true;
+	}
+	if (Relevancy->MaxConcurrent > 0 && ActiveCuesPerTag.FindRef(InTag) >= Relevancy->MaxConcurrent)
+	{
+		return false;
+	}
+	if (Relevancy->MaxDistance <= 0 || !World)
+	{
+		return true;
+	}
+	if (ViewLocationsFrame != GFrameCounter)
+	{
+		ViewLocationsFrame = GFrameCounter;
+		ViewLocations.Reset();
+		for (FConstPlayerControllerIterator It = World->GetPlayerControllerIterator(); It; ++It)
+		{
+			APlayerController* PC = It->Get();
+			if (PC && PC->IsLocalController())
+			{
+				FVector ViewLocation;
+				FRotator ViewRotation;
+				PC->GetPlayerViewPoint(ViewLocation, ViewRotation);
+				ViewLocations.Add(ViewLocation);
+			}
+		}
+	}
+	//nobody is watching (ie. listen server without local player), nothing to cull against.
+	if (ViewLocations.Num() == 0)
+	{
+		return true;
+	}
+	const float MaxDistanceSq = FMath::Square(Relevancy->MaxDistance);
+	for (const FVector& ViewLocation : ViewLocations)
+	{
+		if (FVector::DistSquared(ViewLocation, InLocation) <= MaxDistanceSq)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+bool UAFCueManager::HasStartBudget()
+{
+	if (StartsFrame != GFrameCounter)
+	{
+		StartsFrame = GFrameCounter;
+		StartsThisFrame = 0;
+	}
+	return MaxCueStartsPerFrame <= 0 || StartsThisFrame < MaxCueStartsPerFrame;
+}
+void UAFCueManager::RemovePendingCue(uint32 InPendingId)
+{
+	for (int32 Idx = 0; Idx < PendingCues.Num(); Idx++)
+	{
+		if (PendingCues[Idx].Id == InPendingId)
+		{
+			PendingCues.RemoveAt(Idx, 1, false);
+			return;
+		}
+	}
+}
+void UAFCueManager::TickPendingCues()
+{
+	if (PendingCues.Num() == 0 || !CueSet)
+	{
+		return;
+	}
+	//ids grow, so sorting by it keeps handling order within priority.
+	PendingCues.Sort([](const FAFPendingCue& A, const FAFPendingCue& B)
+	{
+		return A.Priority > B.Priority || (A.Priority == B.Priority && A.Id < B.Id);
+	});
+	while (PendingCues.Num() > 0 && HasStartBudget())
+	{
+		const FAFPendingCue Pending = PendingCues[0];
+		PendingCues.RemoveAt(0, 1, false);
 
-		UseCuesQueue->Dequeue(actor);
-		
-
-		if (actor)
+		AGAEffectCue* Cue = nullptr;
+		if (IsCueRelevant(Pending.Tag, Pending.CueParams.HitResult.Location))
+		{
+			Cue = StartCue(Pending.Tag, Pending.CueClass, Pending.CueParams);
+		}
+		else
+		{
+			INC_DWORD_STAT(STAT_CuesCulled);
+		}
+		TMap<FGameplayTag, TArray<FAFUsedCue>>* UsedCuesMap = UsedCues.Find(FObjectKey(Pending.CueParams.Instigator.Get()));
+		TArray<FAFUsedCue>* UsedCuesQueue = UsedCuesMap ? UsedCuesMap->Find(Pending.Tag) : nullptr;
+		FAFUsedCue* Used = UsedCuesQueue ? UsedCuesQueue->FindByPredicate([&Pending](const FAFUsedCue& InUsed)
+		{
+			return InUsed.PendingId == Pending.Id;
+		}) : nullptr;
+		if (Used)
+		{
+			Used->PendingId = 0;
+			Used->Cue = Cue;
+		}
+		else if (Cue)
 		{
-			Cues->Enqueue(actor);
-			actor->NativeOnRemoved();
+			//event was removed while cue was beginning.
+			FAFUsedCue Orphan;
+			Orphan.Cue = Cue;
+			StopCue(Pending.Tag, Orphan);
 		}
 	}
-}
\ No newline at end of file
+	UpdatePoolStats();
+}
+AGAEffectCue* UAFCueManager::AcquireCue(const FGameplayTag& InTag)
+{
+	TArray<FAFIdleCue>* Cues = InstancedCues.Find(InTag);
+	if (!Cues)
+	{
+		return nullptr;
+	}
+	while (Cues->Num() > 0)
+	{
+		AGAEffectCue* Cue = Cues->Pop(false).Cue;
+		NumIdleCues--;
+		//destroyed outside of manager (GC cleared reference).
+		if (Cue && !Cue->IsPendingKill())
+		{
+			return Cue;
+		}
+	}
+	return nullptr;
+}
+void UAFCueManager::ReleaseCue(const FGameplayTag& InTag, AGAEffectCue* InCue)
+{
+	if (!InCue || InCue->IsPendingKill())
+	{
+		return;
+	}
+	InCue->SetDormant(true);
+	TArray<FAFIdleCue>& Cues = InstancedCues.FindOrAdd(InTag);
+	if (MaxIdleCuesPerTag > 0 && Cues.Num() >= MaxIdleCuesPerTag)
+	{
+		if (Cues[0].Cue)
+		{
+			Cues[0].Cue->Destroy();
+		}
+		Cues.RemoveAt(0, 1, false);
+		NumIdleCues--;
+		NumEvicted++;
+		INC_DWORD_STAT(STAT_CuesEvicted);
+	}
+	FAFIdleCue Idle;
+	Idle.Cue = InCue;
+	Idle.ReleaseTime = FPlatformTime::Seconds();
+	Cues.Add(Idle);
+	NumIdleCues++;
+	while (MaxIdleCues > 0 && NumIdleCues > MaxIdleCues)
+	{
+		EvictOldestCue();
+	}
+}
+void UAFCueManager::EvictOldestCue()
+{
+	TArray<FAFIdleCue>* Oldest = nullptr;
+	for (auto It = InstancedCues.CreateIterator(); It; ++It)
+	{
+		if (It->Value.Num() > 0 && (!Oldest || It->Value[0].ReleaseTime < (*Oldest)[0].ReleaseTime))
+		{
+			Oldest = &It->Value;
+		}
+	}
+	if (!Oldest)
+	{
+		NumIdleCues = 0;
+		return;
+	}
+	if ((*Oldest)[0].Cue)
+	{
+		(*Oldest)[0].Cue->Destroy();
+	}
+	Oldest->RemoveAt(0, 1, false);
+	NumIdleCues--;
+	NumEvicted++;
+	INC_DWORD_STAT(STAT_CuesEvicted);
+}
+void UAFCueManager::ReleaseInstigator(const FObjectKey& InInstigatorKey)
+{
+	TMap<FGameplayTag, TArray<FAFUsedCue>> InstigatorCues;
+	if (!UsedCues.RemoveAndCopyValue(InInstigatorKey, InstigatorCues))
+	{
+		return;
+	}
+	for (auto It = InstigatorCues.CreateIterator(); It; ++It)
+	{
+		for (const FAFUsedCue& Used : It->Value)
+		{
+			StopCue(It->Key, Used);
+		}
+	}
+	UpdatePoolStats();
+}
+void UAFCueManager::HandleInstigatorDestroyed(AActor* DestroyedActor)
+{
+	ReleaseInstigator(FObjectKey(DestroyedActor));
+}
+double UAFCueManager::GetAverageSpawnTimeMs() const
+{
+	return NumSpawns > 0 ? FPlatformTime::ToMilliseconds64(SpawnCycles) / NumSpawns : 0.0;
+}
+void UAFCueManager::ResetCounters()
+{
+	HandledPerTag.Empty();
+	NumPoolHits = 0;
+	NumPoolMisses = 0;
+	NumEvicted = 0;
+	NumSpawns = 0;
+	SpawnCycles = 0;
+}
+void UAFCueManager::SetPoolLimits(int32 InMaxIdleCues, int32 InMaxIdleCuesPerTag)
+{
+	MaxIdleCues = InMaxIdleCues;
+	MaxIdleCuesPerTag = InMaxIdleCuesPerTag;
+}
+void UAFCueManager::DumpCounters(FOutputDevice& Ar) const
+{
+	Ar.Logf(TEXT("Cues of %s: %d active, %d idle, %d pending"), *GetNameSafe(World), NumActiveCues, NumIdleCues, PendingCues.Num());
+	const uint32 NumAcquired = NumPoolHits + NumPoolMisses;
+	Ar.Logf(TEXT("  pool hits %u, misses %u (%.1f%% hit), %u evicted, %u spawns, average spawn %.3f ms"), NumPoolHits, NumPoolMisses,
+		NumAcquired > 0 ? 100.0 * NumPoolHits / NumAcquired : 0.0, NumEvicted, NumSpawns, GetAverageSpawnTimeMs());
+	TArray<TPair<FGameplayTag, uint32>> Handled;
+	for (auto It = HandledPerTag.CreateConstIterator(); It; ++It)
+	{
+		Handled.Add(TPair<FGameplayTag, uint32>(It->Key, It->Value));
+	}
+	Handled.Sort([](const TPair<FGameplayTag, uint32>& A, const TPair<FGameplayTag, uint32>& B) { return A.Value > B.Value; });
+	for (const TPair<FGameplayTag, uint32>& Entry : Handled)
+	{
+		Ar.Logf(TEXT("  %s handled %u"), *Entry.Key.ToString(), Entry.Value);
+	}
+}
+void UAFCueManager::UpdatePoolStats()
+{
+#if STATS
+	//stats are process wide, sum of all worlds.
+	int32 IdleCues = 0;
+	int32 ActiveCues = 0;
+	int32 Instigators = 0;
+	int32 Pending = 0;
+	SIZE_T PoolMemory = 0;
+	for (auto ManagerIt = WorldManagers.CreateConstIterator(); ManagerIt; ++ManagerIt)
+	{
+		const UAFCueManager* Manager = ManagerIt->Value;
+		IdleCues += Manager->NumIdleCues;
+		ActiveCues += Manager->NumActiveCues;
+		Instigators += Manager->UsedCues.Num();
+		Pending += Manager->PendingCues.Num();
+		PoolMemory += Manager->InstancedCues.GetAllocatedSize() + Manager->UsedCues.GetAllocatedSize()
+			+ Manager->PendingCues.GetAllocatedSize() + Manager->ActiveCuesPerTag.GetAllocatedSize();
+		for (auto It = Manager->InstancedCues.CreateConstIterator(); It; ++It)
+		{
+			PoolMemory += It->Value.GetAllocatedSize();
+		}
+		for (auto It = Manager->UsedCues.CreateConstIterator(); It; ++It)
+		{
+			PoolMemory += It->Value.GetAllocatedSize();
+			for (auto TagIt = It->Value.CreateConstIterator(); TagIt; ++TagIt)
+			{
+				PoolMemory += TagIt->Value.GetAllocatedSize();
+			}
+		}
+	}
+	SET_DWORD_STAT(STAT_DormantCues, IdleCues);
+	SET_DWORD_STAT(STAT_ActiveCues, ActiveCues);
+	SET_DWORD_STAT(STAT_CueInstigators, Instigators);
+	SET_DWORD_STAT(STAT_PendingCues, Pending);
+	SET_MEMORY_STAT(STAT_CuePoolMemory, PoolMemory);
+#endif //STATS
+}
@@ -4,43 +4,265 @@
 
 #include "CoreMinimal.h"
 #include "UObject/NoExportTypes.h"
+#include "Engine/World.h"
+#include "Engine/StreamableManager.h"
 #include "GameplayTags.h"
 #include "GAGlobalTypes.h"
 #include "Effects/GAEffectCue.h"
 #include "AFCueManager.generated.h"
 
-/**
- * 
- */
+/*
+	Set by AbilityFramework.Build.cs, 0 on dedicated server targets. Without cues HandleCue/HandleRemoveCue
+	are no-ops, cue set is not loaded and worlds are not pre-warmed. Server still replicates cue events.
+*/
+#ifndef WITH_AF_CUES
+#define WITH_AF_CUES 1
+#endif
+
+DECLARE_STATS_GROUP(TEXT("Cues"), STATGROUP_Cues, STATCAT_Advanced);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Cue Pool Hits"), STAT_CuePoolHits, STATGROUP_Cues, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Cue Pool Misses"), STAT_CuePoolMisses, STATGROUP_Cues, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Dormant Cues"), STAT_DormantCues, STATGROUP_Cues, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Active Cues"), STAT_ActiveCues, STATGROUP_Cues, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Cue Instigators"), STAT_CueInstigators, STATGROUP_Cues, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Cues Evicted"), STAT_CuesEvicted, STATGROUP_Cues, );
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Cue Pool Memory"), STAT_CuePoolMemory, STATGROUP_Cues, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Cues Started"), STAT_CuesStarted, STATGROUP_Cues, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Cues Culled"), STAT_CuesCulled, STATGROUP_Cues, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Cues Deferred"), STAT_CuesDeferred, STATGROUP_Cues, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Pending Cues"), STAT_PendingCues, STATGROUP_Cues, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Handle Cue"), STAT_HandleCue, STATGROUP_Cues, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Cues Handled"), STAT_CuesHandled, STATGROUP_Cues, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Spawn Cue"), STAT_SpawnCue, STATGROUP_Cues, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Cue Classes Streamed"), STAT_CueClassesStreamed, STATGROUP_Cues, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Cues Not Resident"), STAT_CuesNotResident, STATGROUP_Cues, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Tick Cue Sequences"), STAT_TickCueSequences, STATGROUP_Cues, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Cue Sequences Evaluated"), STAT_CueSequencesEvaluated, STATGROUP_Cues, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Cue Sequences Shared"), STAT_CueSequencesShared, STATGROUP_Cues, );
+
+USTRUCT()
+struct FAFCueManagerTickFunction : public FTickFunction
+{
+	GENERATED_USTRUCT_BODY()
+	class UAFCueManager* Manager;
+
+	virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent) override;
+	virtual FString DiagnosticMessage() override;
+};
+template<>
+struct TStructOpsTypeTraits<FAFCueManagerTickFunction> : public TStructOpsTypeTraitsBase2<FAFCueManagerTickFunction>
+{
+	enum
+	{
+		WithCopy = false
+	};
+};
+
+/*
+	One manager per world, created on first use and destroyed on world cleanup, so every world has it's own
+	pools, budgets and tick. Config and cue set asset are shared.
+*/
 UCLASS(config = Game)
 class ABILITYFRAMEWORK_API UAFCueManager : public UObject
 {
 	GENERATED_BODY()
 protected:
-	//UPROPERTY()
-		static UAFCueManager* ManagerInstance;
-		UWorld* CurrentWorld;
+	static TMap<FObjectKey, UAFCueManager*> WorldManagers;
+	/* Worlds which were cleaned up, and not initialized again. Manager is never created for them. */
+	static TSet<FObjectKey> CleanedUpWorlds;
+	/* Keeps DefaultCueSet loaded from engine init, before any world asks for it. */
+	static TSharedPtr<FStreamableHandle> DefaultCueSetHandle;
+	UWorld* World;
 	UPROPERTY(config, EditAnywhere, Category = "Cue Set")
 		TAssetPtr<class UAFCueSet> DefaultCueSet;
 
+	/* Pre-warm count for tags which are not in UAFCueSet::PrewarmCounts. */
+	UPROPERTY(config, EditAnywhere, Category = "Pool")
+		int32 DefaultPrewarmCount;
+
+	/* Max dormant cues of all tags. Least recently used are destroyed above it. 0 - no limit. */
+	UPROPERTY(config, EditAnywhere, Category = "Pool")
+		int32 MaxIdleCues;
+	/* Max dormant cues of single tag. 0 - no limit. */
+	UPROPERTY(config, EditAnywhere, Category = "Pool")
+		int32 MaxIdleCuesPerTag;
+
+	/*
+		How many cues can start in single frame. Cues over budget are deferred to next frames,
+		higher FAFCueRelevancy::Priority first. 0 - no limit.
+	*/
+	UPROPERTY(config, EditAnywhere, Category = "Relevancy")
+		int32 MaxCueStartsPerFrame;
+
+	/*
+		Cues of the same class and sequence started within this many frames share one sequence evaluation
+		(see AGAEffectCue::bShareSequenceEvaluation). 0 - every cue evaluates it's own sequence.
+	*/
+	UPROPERTY(config, EditAnywhere, Category = "Sequence")
+		int32 SequenceShareFrames;
+
 	UPROPERTY()
 		UAFCueSet* CueSet;
+	/* Async load of DefaultCueSet. */
+	TSharedPtr<FStreamableHandle> CueSetHandle;
+	double CueSetLoadStartTime;
+	/* Requested cue classes, handle keeps class loaded. */
+	TMap<FGameplayTag, TSharedPtr<FStreamableHandle>> CueClassHandles;
 	
-	//store per instigator ? Causer ? or global pool ?
-	//stores unused instanced cues.
-	TMap<FGameplayTag, TUniquePtr<TQueue<AGAEffectCue*>>> InstancedCues;
-	//store per instigator ? Causer ?
-	//stores used cues.
-	TMap<FObjectKey, TMap<FGameplayTag, TUniquePtr<TQueue<AGAEffectCue*>>>> UsedCues;
+	struct FAFIdleCue
+	{
+		AGAEffectCue* Cue;
+		double ReleaseTime;
+	};
+	/* Dormant cues per tag, oldest first. Reuse takes newest, eviction takes oldest. */
+	TMap<FGameplayTag, TArray<FAFIdleCue>> InstancedCues;
+	/*
+		Cue event which was handled, but might not be playing. Culled cues have neither Cue nor PendingId,
+		they are kept so HandleRemoveCue removes the same event it would remove if cue was playing.
+	*/
+	struct FAFUsedCue
+	{
+		AGAEffectCue* Cue;
+		/* Waiting in PendingCues for start budget. */
+		uint32 PendingId;
+
+		FAFUsedCue()
+			: Cue(nullptr),
+			PendingId(0)
+		{}
+	};
+	/* Handled cues per instigator and tag, oldest first. Entry is released when instigator is destroyed. */
+	TMap<FObjectKey, TMap<FGameplayTag, TArray<FAFUsedCue>>> UsedCues;
+	int32 NumIdleCues;
+	int32 NumActiveCues;
+
+	struct FAFPendingCue
+	{
+		uint32 Id;
+		int32 Priority;
+		FGameplayTag Tag;
+		TSubclassOf<AGAEffectCue> CueClass;
+		FGAEffectCueParams CueParams;
+	};
+	/* Cues deferred by start budget, in order they were handled. */
+	TArray<FAFPendingCue> PendingCues;
+	uint32 NextPendingId;
+	/* Playing cues per tag, for FAFCueRelevancy::MaxConcurrent. */
+	TMap<FGameplayTag, int32> ActiveCuesPerTag;
+	int32 StartsThisFrame;
+	uint64 StartsFrame;
+	/* Local player view locations, refreshed once per frame. */
+	TArray<FVector> ViewLocations;
+	uint64 ViewLocationsFrame;
+
+	struct FAFCueSequenceMember
+	{
+		AGAEffectCue* Cue;
+		/* Non root scene components, in the same order for every member of group. */
+		TArray<USceneComponent*> Components;
+	};
+	/*
+		Playing cues evaluated together. Only sequence player of first member is updated,
+		rest copies it's animated components. Group is dropped when sequence finishes, so finished cues cost nothing.
+	*/
+	struct FAFCueSequenceGroup
+	{
+		UClass* CueClass;
+		UObject* SequenceArchetype;
+		uint64 StartFrame;
+		bool bShared;
+		TArray<FAFCueSequenceMember> Members;
+	};
+	TArray<FAFCueSequenceGroup> SequenceGroups;
+
+	FAFCueManagerTickFunction TickFunction;
+
+	/* Counters since world start (or AbilityFramework.Cues.Stats reset), printed by console command. */
+	TMap<FGameplayTag, uint32> HandledPerTag;
+	uint32 NumPoolHits;
+	uint32 NumPoolMisses;
+	uint32 NumEvicted;
+	uint32 NumSpawns;
+	uint64 SpawnCycles;
 public:
-	void Initialize();
+	UAFCueManager(const FObjectInitializer& ObjectInitializer);
+	/* Pooled cues are referenced, so cue destroyed outside of manager is nulled instead of dangling. */
+	static void AddReferencedObjects(UObject* InThis, FReferenceCollector& Collector);
+	virtual UWorld* GetWorld() const override { return World; }
+	void Initialize(UWorld* InWorld);
+	/* Starts async load of DefaultCueSet. Cues are skipped until it's loaded. */
 	void LoadCueSet();
-#if WITH_EDITOR
-	//handle clearing up cache when PIE mode is ending.
-	void HandleOnPIEEnd(bool InVal);
-#endif //WITH_EDITOR
+	/* Bound on module startup, starts loading cue set before any world needs it. */
+	static void HandlePostEngineInit();
+	/* Bound on module startup, destroys manager of world which goes away (actors go with the world). */
+	static void HandleWorldCleanup(UWorld* InWorld, bool bSessionEnded, bool bCleanupResources);
+	void ClearPools(bool bDestroyActors);
+	/* Starts deferred cues within this frame budget. */
+	void TickPendingCues();
+	/* Updates sequence of every cue group and copies results to other members. */
+	void TickSequenceGroups(float InDeltaTime);
+	/* Spawns dormant cues for every tag in cue set. */
+	void Prewarm();
+	/* Bound on module startup, pre-warms game worlds. */
+	static void HandlePostWorldInitialization(UWorld* InWorld, const UWorld::InitializationValues IVS);
+	void SetCueSet(UAFCueSet* InCueSet);
+	/* Streams cue classes of tags with high priority, ahead of first use. */
+	void PreloadCues(const FGameplayTagContainer& InTags);
+	/* Preloads cues of every effect (FGAEffectProperty) ability class has, ie. when ability is equipped. */
+	void PreloadAbilityCues(UClass* InAbilityClass);
+	inline int32 GetNumRequestedCueClasses() const { return CueClassHandles.Num(); }
+	inline int32 GetNumIdleCues() const { return NumIdleCues; }
+	inline int32 GetNumActiveCues() const { return NumActiveCues; }
+	inline int32 GetNumActiveCues(const FGameplayTag& InTag) const { return ActiveCuesPerTag.FindRef(InTag); }
+	inline int32 GetNumInstigators() const { return UsedCues.Num(); }
+	inline int32 GetNumPendingCues() const { return PendingCues.Num(); }
+	inline int32 GetNumSequenceGroups() const { return SequenceGroups.Num(); }
+	inline uint32 GetNumHandled(const FGameplayTag& InTag) const { return HandledPerTag.FindRef(InTag); }
+	inline uint32 GetNumPoolHits() const { return NumPoolHits; }
+	inline uint32 GetNumPoolMisses() const { return NumPoolMisses; }
+	inline uint32 GetNumEvicted() const { return NumEvicted; }
+	inline int32 GetMaxIdleCues() const { return MaxIdleCues; }
+	inline int32 GetMaxIdleCuesPerTag() const { return MaxIdleCuesPerTag; }
+	/* Overrides config limits of this world pools. Cues over new limits are evicted on next release. */
+	void SetPoolLimits(int32 InMaxIdleCues, int32 InMaxIdleCuesPerTag);
+	inline int32 GetMaxCueStartsPerFrame() const { return MaxCueStartsPerFrame; }
+	inline void SetMaxCueStartsPerFrame(int32 InMaxCueStartsPerFrame) { MaxCueStartsPerFrame = InMaxCueStartsPerFrame; }
+	double GetAverageSpawnTimeMs() const;
+	void ResetCounters();
+	void DumpCounters(FOutputDevice& Ar) const;
+protected:
+	AGAEffectCue* SpawnCue(TSubclassOf<AGAEffectCue> InCueClass, const FVector& InLocation, const FRotator& InRotation);
+	void HandleCueSetLoaded();
+	/* Loaded cue class, or nullptr after requesting it to stream in. */
+	TSubclassOf<AGAEffectCue> GetCueClass(const FGameplayTag& InTag, TAsyncLoadPriority InPriority);
+	void HandleCueClassLoaded(FGameplayTag InTag);
+	/* Spawns dormant cues of tag up to its pre-warm count. */
+	void PrewarmTag(const FGameplayTag& InTag, TSubclassOf<AGAEffectCue> InCueClass);
+	/* Newest dormant cue of tag, or nullptr. */
+	AGAEffectCue* AcquireCue(const FGameplayTag& InTag);
+	/* Makes cue dormant and puts it back into pool, evicting least recently used cues over limits. */
+	void ReleaseCue(const FGameplayTag& InTag, AGAEffectCue* InCue);
+	void EvictOldestCue();
+	/* Takes cue from pool (or spawns it) and begins it. */
+	AGAEffectCue* StartCue(const FGameplayTag& InTag, TSubclassOf<AGAEffectCue> InCueClass, const FGAEffectCueParams& InCueParams);
+	/* Stops playing or pending cue and puts it back into pool. */
+	void StopCue(const FGameplayTag& InTag, const FAFUsedCue& InUsedCue);
+	void AddToSequenceGroup(AGAEffectCue* InCue);
+	void RemoveFromSequenceGroup(AGAEffectCue* InCue);
+	bool IsCueRelevant(const FGameplayTag& InTag, const FVector& InLocation);
+	bool HasStartBudget();
+	void RemovePendingCue(uint32 InPendingId);
+	/* Stops and releases all cues of instigator. */
+	void ReleaseInstigator(const FObjectKey& InInstigatorKey);
+	UFUNCTION()
+		void HandleInstigatorDestroyed(AActor* DestroyedActor);
+	void UpdatePoolStats();
 public:
-	static UAFCueManager* Get();
+	/* Manager of InWorld, created if there is none yet. Null for worlds being torn down or cleaned up. */
+	static UAFCueManager* Get(UWorld* InWorld);
+	/* Manager of InWorld, if it was already created. */
+	static UAFCueManager* Find(UWorld* InWorld);
+	inline static int32 GetNumWorldManagers() { return WorldManagers.Num(); }
 	void HandleCue(const FGameplayTagContainer& Tags,
 		const FGAEffectCueParams& CueParams);
 	void HandleRemoveCue(const FGameplayTagContainer& Tags,
@@ -0,0 +1,324 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AbilityFramework.h"
+#include "GameplayTagsManager.h"
+#include "Engine/NetSerialization.h"
+#include "Math/Float16.h"
+#include "GameFramework/PlayerController.h"
+#include "AFCueManager.h"
+#include "AFCueReplication.h"
+
+DEFINE_STAT(STAT_CueEventsReplicated);
+DEFINE_STAT(STAT_CueEventsNotRelevant);
+DEFINE_STAT(STAT_CueBatchesSent);
+
+TArray<UAFCueReplicationComponent*> UAFCueReplicationComponent::ReplicationComponents;
+
+FAFPackedCueEvent FAFPackedCueEvent::Pack(const FGameplayTag& InTag, const FGAEffectCueParams& InCueParams, bool bInRemove)
+{
+	FAFPackedCueEvent Event;
+	Event.TagIndex = UGameplayTagsManager::Get().GetNetIndexFromTag(InTag);
+	Event.Location = InCueParams.HitResult.Location;
+	Event.Normal = InCueParams.HitResult.ImpactNormal;
+	Event.Period = InCueParams.Period;
+	Event.Duration = InCueParams.Duration;
+	Event.bRemove = bInRemove;
+	Event.Instigator = InCueParams.Instigator;
+	return Event;
+}
+bool FAFPackedCueEvent::Unpack(FGameplayTag& OutTag, FGAEffectCueParams& OutCueParams) const
+{
+	OutTag = UGameplayTagsManager::Get().GetTagFromNetIndex(TagIndex);
+	if (!OutTag.IsValid())
+	{
+		return false;
+	}
+	OutCueParams.HitResult.Location = Location;
+	OutCueParams.HitResult.ImpactPoint = Location;
+	OutCueParams.HitResult.Normal = Normal;
+	OutCueParams.HitResult.ImpactNormal = Normal;
+	OutCueParams.Period = Period;
+	OutCueParams.Duration = Duration;
+	OutCueParams.CueTags.AddTag(OutTag);
+	OutCueParams.Instigator = Instigator;
+	return true;
+}
+
+bool FAFPackedCueEvent::NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess)
+{
+	uint8 Flags = 0;
+	if (Ar.IsSaving())
+	{
+		Flags = (bRemove ? 1 : 0)
+			| (!Normal.IsNearlyZero() ? 2 : 0)
+			| (Period > 0 ? 4 : 0)
+			| (Duration > 0 ? 8 : 0);
+	}
+	Ar.SerializeBits(&Flags, 4);
+	bRemove = (Flags & 1) != 0;
+
+	uint32 Index = TagIndex;
+	Ar.SerializeIntPacked(Index);
+	TagIndex = (uint16)Index;
+
+	bOutSuccess = true;
+	UObject* InstigatorObject = Instigator.Get();
+	if (Map)
+	{
+		bOutSuccess &= Map->SerializeObject(Ar, AActor::StaticClass(), InstigatorObject);
+	}
+	if (Ar.IsLoading())
+	{
+		Instigator = Cast<AActor>(InstigatorObject);
+	}
+	//removal only needs to find cue.
+	if (!bRemove)
+	{
+		bOutSuccess &= SerializePackedVector<10, 24>(Location, Ar);
+		if (Flags & 2)
+		{
+			bOutSuccess &= SerializeFixedVector<1, 8>(Normal, Ar);
+		}
+		else
+		{
+			Normal = FVector::ZeroVector;
+		}
+	}
+	FFloat16 HalfPeriod(Period);
+	FFloat16 HalfDuration(Duration);
+	if (Flags & 4)
+	{
+		Ar << HalfPeriod;
+	}
+	if (Flags & 8)
+	{
+		Ar << HalfDuration;
+	}
+	if (Ar.IsLoading())
+	{
+		Period = (Flags & 4) ? (float)HalfPeriod : 0;
+		Duration = (Flags & 8) ? (float)HalfDuration : 0;
+	}
+	return true;
+}
+
+UAFCueReplicationComponent::UAFCueReplicationComponent(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.bStartWithTickEnabled = true;
+	//after gameplay had chance to fire cues this frame.
+	PrimaryComponentTick.TickGroup = TG_PostUpdateWork;
+	bReplicates = true;
+	CueNetCullDistance = 15000;
+	//roughly 20 bytes per event, well under bunch size.
+	MaxCueEventsPerFlush = 64;
+	LastFlushTime = 0;
+}
+void UAFCueReplicationComponent::OnRegister()
+{
+	Super::OnRegister();
+	ReplicationComponents.AddUnique(this);
+}
+void UAFCueReplicationComponent::OnUnregister()
+{
+	ReplicationComponents.RemoveSingleSwap(this, false);
+	Super::OnUnregister();
+}
+void UAFCueReplicationComponent::TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction *ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+	if (PendingBatch.Events.Num() == 0)
+	{
+		return;
+	}
+	AActor* Owner = GetOwner();
+	const float Now = GetWorld()->GetTimeSeconds();
+	const float NetUpdateInterval = Owner && Owner->NetUpdateFrequency > 0 ? 1.0f / Owner->NetUpdateFrequency : 0;
+	if (Now - LastFlushTime >= NetUpdateInterval)
+	{
+		FlushCueEvents();
+	}
+}
+
+void UAFCueReplicationComponent::ReplicateCue(UWorld* InWorld, const FGameplayTagContainer& InTags,
+	const FGAEffectCueParams& InCueParams, bool bInRemove)
+{
+	if (!InWorld)
+	{
+		return;
+	}
+	const ENetMode NetMode = InWorld->GetNetMode();
+	if (NetMode == NM_Standalone || NetMode == NM_Client)
+	{
+		return;
+	}
+	//packed once, shared by all connections.
+	TArray<FGameplayTag, TInlineAllocator<4>> Tags;
+	TArray<FAFPackedCueEvent, TInlineAllocator<4>> Events;
+	for (const FGameplayTag& Tag : InTags)
+	{
+		Tags.Add(Tag);
+		Events.Add(FAFPackedCueEvent::Pack(Tag, InCueParams, bInRemove));
+	}
+	const FObjectKey InstigatorKey(InCueParams.Instigator.Get());
+	for (UAFCueReplicationComponent* Component : ReplicationComponents)
+	{
+		if (!Component || Component->GetWorld() != InWorld)
+		{
+			continue;
+		}
+		APlayerController* PC = Cast<APlayerController>(Component->GetOwner());
+		//listen server host plays cues locally.
+		if (PC && PC->IsLocalController())
+		{
+			continue;
+		}
+		if (!bInRemove && !Component->IsCueRelevant(InCueParams))
+		{
+			INC_DWORD_STAT_BY(STAT_CueEventsNotRelevant, Events.Num());
+			continue;
+		}
+		//removal is sent where add was sent, even if client is out of range now.
+		TMap<FGameplayTag, int32>& Sent = Component->SentCues.FindOrAdd(InstigatorKey);
+		for (int32 Idx = 0; Idx < Events.Num(); Idx++)
+		{
+			if (bInRemove)
+			{
+				int32* Count = Sent.Find(Tags[Idx]);
+				if (!Count)
+				{
+					INC_DWORD_STAT(STAT_CueEventsNotRelevant);
+					continue;
+				}
+				if (--(*Count) <= 0)
+				{
+					Sent.Remove(Tags[Idx]);
+				}
+			}
+			else
+			{
+				Sent.FindOrAdd(Tags[Idx])++;
+			}
+			Component->PendingBatch.Events.Add(Events[Idx]);
+			INC_DWORD_STAT(STAT_CueEventsReplicated);
+		}
+		if (Sent.Num() == 0)
+		{
+			Component->SentCues.Remove(InstigatorKey);
+		}
+	}
+}
+void UAFCueReplicationComponent::ExecuteCue(UWorld* InWorld, const FGameplayTagContainer& InTags,
+	const FGAEffectCueParams& InCueParams, bool bInExpire)
+{
+#if WITH_AF_CUES
+	if (UAFCueManager* CueManager = UAFCueManager::Get(InWorld))
+	{
+		CueManager->HandleCue(InTags, InCueParams);
+	}
+#endif //WITH_AF_CUES
+	ReplicateCue(InWorld, InTags, InCueParams, false);
+	if (bInExpire && InCueParams.Duration > 0 && InWorld)
+	{
+		FTimerHandle ExpireHandle;
+		FTimerDelegate ExpireDelegate = FTimerDelegate::CreateStatic(&UAFCueReplicationComponent::HandleCueExpired,
+			TWeakObjectPtr<UWorld>(InWorld), InTags, InCueParams);
+		InWorld->GetTimerManager().SetTimer(ExpireHandle, ExpireDelegate, InCueParams.Duration, false);
+	}
+}
+void UAFCueReplicationComponent::RemoveCue(UWorld* InWorld, const FGameplayTagContainer& InTags,
+	const FGAEffectCueParams& InCueParams)
+{
+#if WITH_AF_CUES
+	if (UAFCueManager* CueManager = UAFCueManager::Get(InWorld))
+	{
+		CueManager->HandleRemoveCue(InTags, InCueParams);
+	}
+#endif //WITH_AF_CUES
+	ReplicateCue(InWorld, InTags, InCueParams, true);
+}
+void UAFCueReplicationComponent::HandleCueExpired(TWeakObjectPtr<UWorld> InWorld, FGameplayTagContainer InTags, FGAEffectCueParams InCueParams)
+{
+	if (InWorld.IsValid())
+	{
+		RemoveCue(InWorld.Get(), InTags, InCueParams);
+	}
+}
+
+bool UAFCueReplicationComponent::IsCueRelevant(const FGAEffectCueParams& InCueParams) const
+{
+	if (CueNetCullDistance <= 0)
+	{
+		return true;
+	}
+	APlayerController* PC = Cast<APlayerController>(GetOwner());
+	if (!PC)
+	{
+		return true;
+	}
+	AActor* Instigator = InCueParams.Instigator.Get();
+	if (Instigator && (Instigator == PC->GetPawn() || Instigator == PC->GetViewTarget()))
+	{
+		return true;
+	}
+	FVector ViewLocation;
+	FRotator ViewRotation;
+	PC->GetPlayerViewPoint(ViewLocation, ViewRotation);
+	return FVector::DistSquared(ViewLocation, InCueParams.HitResult.Location) <= FMath::Square(CueNetCullDistance);
+}
+void UAFCueReplicationComponent::FlushCueEvents()
+{
+	LastFlushTime = GetWorld()->GetTimeSeconds();
+	//destroyed instigators, client releases their cues on it's own.
+	for (auto It = SentCues.CreateIterator(); It; ++It)
+	{
+		if (It->Key != FObjectKey() && !It->Key.ResolveObjectPtr())
+		{
+			It.RemoveCurrent();
+		}
+	}
+	if (PendingBatch.Events.Num() == 0)
+	{
+		return;
+	}
+	INC_DWORD_STAT(STAT_CueBatchesSent);
+	const int32 MaxEvents = FMath::Max(MaxCueEventsPerFlush, 1);
+	if (PendingBatch.Events.Num() <= MaxEvents)
+	{
+		ClientReceiveCueBatch(PendingBatch);
+		PendingBatch.Events.Reset();
+		return;
+	}
+	//oldest first, removal can't overtake it's add.
+	FAFCueEventBatch Batch;
+	Batch.Events.Append(PendingBatch.Events.GetData(), MaxEvents);
+	PendingBatch.Events.RemoveAt(0, MaxEvents, false);
+	ClientReceiveCueBatch(Batch);
+}
+
+void UAFCueReplicationComponent::ClientReceiveCueBatch_Implementation(const FAFCueEventBatch& Batch)
+{
+	UAFCueManager* CueManager = UAFCueManager::Get(GetWorld());
+	if (!CueManager)
+	{
+		return;
+	}
+	for (const FAFPackedCueEvent& Event : Batch.Events)
+	{
+		FGameplayTag Tag;
+		FGAEffectCueParams CueParams;
+		if (!Event.Unpack(Tag, CueParams))
+		{
+			continue;
+		}
+		if (Event.bRemove)
+		{
+			CueManager->HandleRemoveCue(CueParams.CueTags, CueParams);
+		}
+		else
+		{
+			CueManager->HandleCue(CueParams.CueTags, CueParams);
+		}
+	}
+}
@@ -0,0 +1,128 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "GameplayTags.h"
+#include "GAGlobalTypes.h"
+#include "AFCueManager.h"
+#include "AFCueReplication.generated.h"
+
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Cue Events Replicated"), STAT_CueEventsReplicated, STATGROUP_Cues, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Cue Events Not Relevant"), STAT_CueEventsNotRelevant, STATGROUP_Cues, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Cue Batches Sent"), STAT_CueBatchesSent, STATGROUP_Cues, );
+
+/*
+	Single cue event, as it goes over the wire:
+	tag net index, quantized location (and normal), instigator and optional period/duration.
+	Instigator goes trough package map, so it's exported to connection which doesn't know it yet.
+	Everything else from FGAEffectCueParams (full hit result, causer, ability) stays on server.
+*/
+USTRUCT()
+struct ABILITYFRAMEWORK_API FAFPackedCueEvent
+{
+	GENERATED_BODY()
+public:
+	uint16 TagIndex;
+	FVector Location;
+	FVector Normal;
+	TWeakObjectPtr<AActor> Instigator;
+	float Period;
+	float Duration;
+	bool bRemove;
+
+	FAFPackedCueEvent()
+		: TagIndex(0),
+		Location(FVector::ZeroVector),
+		Normal(FVector::ZeroVector),
+		Period(0),
+		Duration(0),
+		bRemove(false)
+	{}
+
+	static FAFPackedCueEvent Pack(const FGameplayTag& InTag, const FGAEffectCueParams& InCueParams, bool bInRemove);
+	/* Returns false if tag is not known on this side. */
+	bool Unpack(FGameplayTag& OutTag, FGAEffectCueParams& OutCueParams) const;
+
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess);
+};
+template<>
+struct TStructOpsTypeTraits<FAFPackedCueEvent> : public TStructOpsTypeTraitsBase2<FAFPackedCueEvent>
+{
+	enum
+	{
+		WithNetSerializer = true
+	};
+};
+
+USTRUCT()
+struct ABILITYFRAMEWORK_API FAFCueEventBatch
+{
+	GENERATED_BODY()
+public:
+	UPROPERTY()
+		TArray<FAFPackedCueEvent> Events;
+};
+
+/*
+	Per connection cue event buffer. Add it to player controller.
+
+	Server calls ReplicateCue for every cue event. Event is packed once and appended to buffer
+	of every connection it's relevant to (close enough to connection view, or instigated by
+	connection's pawn). Removal is appended only to connections which got the cue.
+	Buffer is sent as single RPC once per owner net update, instead of RPC per cue per effect.
+	Batch is reliable, so removal of cue is never lost. At most MaxCueEventsPerFlush events go
+	in one batch, the rest waits for next net update, so burst of cues can't overflow bunch
+	or reliable buffer.
+*/
+UCLASS(ClassGroup = (AbilityFramework), meta = (BlueprintSpawnableComponent))
+class ABILITYFRAMEWORK_API UAFCueReplicationComponent : public UActorComponent
+{
+	GENERATED_BODY()
+public:
+	/* Cues further than this from connection view are not sent. 0 - send everything. */
+	UPROPERTY(EditAnywhere, Category = "Replication")
+		float CueNetCullDistance;
+	/* Max events in single batch RPC. Events over it are sent with next net updates, in order. */
+	UPROPERTY(EditAnywhere, Category = "Replication", meta = (ClampMin = "1"))
+		int32 MaxCueEventsPerFlush;
+
+protected:
+	FAFCueEventBatch PendingBatch;
+	float LastFlushTime;
+	/* Cues sent to this connection and not removed yet, per instigator and tag. */
+	TMap<FObjectKey, TMap<FGameplayTag, int32>> SentCues;
+	/* Registered components of all worlds. */
+	static TArray<UAFCueReplicationComponent*> ReplicationComponents;
+
+public:
+	UAFCueReplicationComponent(const FObjectInitializer& ObjectInitializer);
+
+	virtual void OnRegister() override;
+	virtual void OnUnregister() override;
+	virtual void TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction *ThisTickFunction) override;
+
+	/* Server only, does nothing on clients and in standalone. */
+	static void ReplicateCue(UWorld* InWorld, const FGameplayTagContainer& InTags,
+		const FGAEffectCueParams& InCueParams, bool bInRemove);
+	/*
+		Plays cue locally and replicates it. If bInExpire is true and cue has Duration,
+		it's removed (locally and on clients) when duration runs out.
+	*/
+	static void ExecuteCue(UWorld* InWorld, const FGameplayTagContainer& InTags,
+		const FGAEffectCueParams& InCueParams, bool bInExpire);
+	/* Removes cue locally and on clients which got it. */
+	static void RemoveCue(UWorld* InWorld, const FGameplayTagContainer& InTags,
+		const FGAEffectCueParams& InCueParams);
+protected:
+	static void HandleCueExpired(TWeakObjectPtr<UWorld> InWorld, FGameplayTagContainer InTags, FGAEffectCueParams InCueParams);
+public:
+
+	bool IsCueRelevant(const FGAEffectCueParams& InCueParams) const;
+	void FlushCueEvents();
+	inline int32 GetNumPendingCueEvents() const { return PendingBatch.Events.Num(); }
+
+	UFUNCTION(Client, Reliable)
+		void ClientReceiveCueBatch(const FAFCueEventBatch& Batch);
+};
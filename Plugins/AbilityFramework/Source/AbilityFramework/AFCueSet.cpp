@@ -1,8 +1,19 @@
 // Fill out your copyright notice in the Description page of Project Settings.
 
 #include "AbilityFramework.h"
+#include "Effects/GAEffectCue.h"
 #include "AFCueSet.h"
 
-
-
-
+void UAFCueSet::PostLoad()
+{
+	Super::PostLoad();
+	//classes are already loaded trough old references, set has to be resaved to stop that.
+	for (auto It = Cues_DEPRECATED.CreateConstIterator(); It; ++It)
+	{
+		if (!CueClasses.Contains(It->Key))
+		{
+			CueClasses.Add(It->Key, TAssetSubclassOf<AGAEffectCue>(It->Value.Get()));
+		}
+	}
+	Cues_DEPRECATED.Empty();
+}
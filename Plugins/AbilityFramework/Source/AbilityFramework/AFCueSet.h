@@ -7,6 +7,29 @@
 #include "GameplayTags.h"
 #include "AFCueSet.generated.h"
 
+/* Rules deciding if cue is worth playing. Zero means no limit. */
+USTRUCT(BlueprintType)
+struct ABILITYFRAMEWORK_API FAFCueRelevancy
+{
+	GENERATED_BODY()
+public:
+	/* Cue further than this from every local view is not played. */
+	UPROPERTY(EditAnywhere, Category = "Relevancy")
+		float MaxDistance;
+	/* Max cues of this tag playing at once, over that new cues are not played. */
+	UPROPERTY(EditAnywhere, Category = "Relevancy")
+		int32 MaxConcurrent;
+	/* When per frame start budget is exceeded, deferred cues with higher priority start first. */
+	UPROPERTY(EditAnywhere, Category = "Relevancy")
+		int32 Priority;
+
+	FAFCueRelevancy()
+		: MaxDistance(0),
+		MaxConcurrent(0),
+		Priority(0)
+	{}
+};
+
 /**
  * 
  */
@@ -16,8 +39,21 @@ class ABILITYFRAMEWORK_API UAFCueSet : public UDataAsset
 	GENERATED_BODY()
 	
 public:
+	/* Classes are not loaded with the set, UAFCueManager streams them when cue is first needed. */
 	UPROPERTY(EditAnywhere)
-		TMap<FGameplayTag, TSubclassOf<class AGAEffectCue>> Cues;
-	
-	
+		TMap<FGameplayTag, TAssetSubclassOf<class AGAEffectCue>> CueClasses;
+	/* Hard references of sets saved before cue classes were streamed, moved to CueClasses on load. */
+	UPROPERTY()
+		TMap<FGameplayTag, TSubclassOf<class AGAEffectCue>> Cues_DEPRECATED;
+	/*
+		How many instances of cue are spawned (dormant) when level starts, so first use
+		doesn't hitch on SpawnActor. Tags not listed use UAFCueManager::DefaultPrewarmCount.
+	*/
+	UPROPERTY(EditAnywhere, Category = "Pool")
+		TMap<FGameplayTag, int32> PrewarmCounts;
+	/* Tags not listed are always played. */
+	UPROPERTY(EditAnywhere, Category = "Relevancy")
+		TMap<FGameplayTag, FAFCueRelevancy> Relevancy;
+
+	virtual void PostLoad() override;
 };
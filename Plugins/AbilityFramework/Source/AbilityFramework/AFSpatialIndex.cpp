@@ -0,0 +1,328 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AbilityFramework.h"
+#include "AFAbilityComponent.h"
+#include "AFAbilityInterface.h"
+#include "EngineUtils.h"
+#include "AFSpatialIndex.h"
+
+DEFINE_STAT(STAT_SpatialIndexUpdate);
+DEFINE_STAT(STAT_SpatialIndexQuery);
+DEFINE_STAT(STAT_SpatialIndexActors);
+
+UAFSpatialIndex* UAFSpatialIndex::IndexInstance = nullptr;
+
+UAFSpatialIndex::UAFSpatialIndex(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	CellSize = 1000;
+}
+
+UAFSpatialIndex* UAFSpatialIndex::Get()
+{
+	if (IndexInstance)
+	{
+		return IndexInstance;
+	}
+	IndexInstance = NewObject<UAFSpatialIndex>(GEngine, UAFSpatialIndex::StaticClass(), "UAFSpatialIndexInstance",
+		RF_MarkAsRootSet);
+	IndexInstance->AddToRoot();
+	IndexInstance->Initialize();
+
+	return IndexInstance;
+}
+void UAFSpatialIndex::Initialize()
+{
+	CellSize = FMath::Max(CellSize, 1.0f);
+	FWorldDelegates::OnWorldCleanup.AddUObject(this, &UAFSpatialIndex::HandleWorldCleanup);
+}
+
+void UAFSpatialIndex::RegisterActor(AActor* InActor)
+{
+	if (!InActor || !InActor->GetWorld())
+	{
+		return;
+	}
+	AddEntry(FindOrAddWorld(InActor->GetWorld()), InActor);
+}
+void UAFSpatialIndex::UnregisterActor(AActor* InActor)
+{
+	if (!InActor)
+	{
+		return;
+	}
+	TUniquePtr<FWorldSpatialIndex>* IndexPtr = WorldIndices.Find(FObjectKey(InActor->GetWorld()));
+	if (!IndexPtr)
+	{
+		return;
+	}
+	FWorldSpatialIndex& Index = **IndexPtr;
+	if (int32* EntryIndex = Index.EntryIndices.Find(FObjectKey(InActor)))
+	{
+		RemoveEntry(Index, *EntryIndex);
+	}
+}
+
+UAFSpatialIndex::FWorldSpatialIndex& UAFSpatialIndex::FindOrAddWorld(UWorld* InWorld)
+{
+	TUniquePtr<FWorldSpatialIndex>& IndexPtr = WorldIndices.FindOrAdd(FObjectKey(InWorld));
+	if (!IndexPtr.IsValid())
+	{
+		IndexPtr = MakeUnique<FWorldSpatialIndex>();
+		IndexPtr->ActorSpawnedHandle = InWorld->AddOnActorSpawnedHandler(
+			FOnActorSpawned::FDelegate::CreateUObject(this, &UAFSpatialIndex::HandleActorSpawned));
+		for (TActorIterator<AActor> It(InWorld); It; ++It)
+		{
+			AddEntry(*IndexPtr, *It);
+		}
+	}
+	return *IndexPtr;
+}
+UAFSpatialIndex::FWorldSpatialIndex* UAFSpatialIndex::GetUpdatedWorld(UWorld* InWorld)
+{
+	if (!InWorld)
+	{
+		return nullptr;
+	}
+	FWorldSpatialIndex& Index = FindOrAddWorld(InWorld);
+	if (Index.LastUpdateFrame != GFrameCounter)
+	{
+		Index.LastUpdateFrame = GFrameCounter;
+		UpdatePositions(Index);
+	}
+	return &Index;
+}
+void UAFSpatialIndex::UpdatePositions(FWorldSpatialIndex& InIndex)
+{
+	SCOPE_CYCLE_COUNTER(STAT_SpatialIndexUpdate);
+	//backwards, so RemoveEntry swaps in entry which is already updated.
+	for (int32 Idx = InIndex.Entries.Num() - 1; Idx >= 0; Idx--)
+	{
+		FSpatialEntry& Entry = InIndex.Entries[Idx];
+		AActor* Actor = Entry.Actor.Get();
+		if (!Actor || Actor->IsPendingKill())
+		{
+			RemoveEntry(InIndex, Idx);
+			continue;
+		}
+		Entry.Location = Actor->GetActorLocation();
+		const FIntPoint NewCell = GetCell(Entry.Location);
+		if (NewCell != Entry.Cell)
+		{
+			RemoveFromCell(InIndex, Idx);
+			InIndex.Entries[Idx].Cell = NewCell;
+			AddToCell(InIndex, Idx);
+		}
+	}
+}
+void UAFSpatialIndex::AddEntry(FWorldSpatialIndex& InIndex, AActor* InActor)
+{
+	IAFAbilityInterface* Interface = Cast<IAFAbilityInterface>(InActor);
+	if (!Interface || InIndex.EntryIndices.Contains(FObjectKey(InActor)))
+	{
+		return;
+	}
+	const int32 EntryIndex = InIndex.Entries.AddDefaulted();
+	FSpatialEntry& Entry = InIndex.Entries[EntryIndex];
+	Entry.Actor = InActor;
+	Entry.Key = FObjectKey(InActor);
+	Entry.Component = Interface->GetAbilityComp();
+	Entry.Location = InActor->GetActorLocation();
+	Entry.Cell = GetCell(Entry.Location);
+	InIndex.EntryIndices.Add(FObjectKey(InActor), EntryIndex);
+	AddToCell(InIndex, EntryIndex);
+	INC_DWORD_STAT(STAT_SpatialIndexActors);
+}
+void UAFSpatialIndex::RemoveEntry(FWorldSpatialIndex& InIndex, int32 InEntryIndex)
+{
+	RemoveFromCell(InIndex, InEntryIndex);
+	InIndex.EntryIndices.Remove(InIndex.Entries[InEntryIndex].Key);
+	const int32 LastIndex = InIndex.Entries.Num() - 1;
+	if (InEntryIndex != LastIndex)
+	{
+		//moved entry keeps it's cell slot, only index stored there changes.
+		FSpatialEntry& Moved = InIndex.Entries[LastIndex];
+		InIndex.Cells.FindChecked(Moved.Cell)[Moved.CellIndex] = InEntryIndex;
+		InIndex.EntryIndices.Add(Moved.Key, InEntryIndex);
+	}
+	InIndex.Entries.RemoveAtSwap(InEntryIndex, 1, false);
+	DEC_DWORD_STAT(STAT_SpatialIndexActors);
+}
+void UAFSpatialIndex::AddToCell(FWorldSpatialIndex& InIndex, int32 InEntryIndex)
+{
+	FSpatialEntry& Entry = InIndex.Entries[InEntryIndex];
+	Entry.CellIndex = InIndex.Cells.FindOrAdd(Entry.Cell).Add(InEntryIndex);
+}
+void UAFSpatialIndex::RemoveFromCell(FWorldSpatialIndex& InIndex, int32 InEntryIndex)
+{
+	FSpatialEntry& Entry = InIndex.Entries[InEntryIndex];
+	TArray<int32>* Cell = InIndex.Cells.Find(Entry.Cell);
+	if (!Cell)
+	{
+		return;
+	}
+	Cell->RemoveAtSwap(Entry.CellIndex, 1, false);
+	if (Cell->IsValidIndex(Entry.CellIndex))
+	{
+		InIndex.Entries[(*Cell)[Entry.CellIndex]].CellIndex = Entry.CellIndex;
+	}
+	if (Cell->Num() == 0)
+	{
+		InIndex.Cells.Remove(Entry.Cell);
+	}
+	Entry.CellIndex = INDEX_NONE;
+}
+
+template<typename FuncType>
+void UAFSpatialIndex::ForEachInBounds(FWorldSpatialIndex& InIndex, const FVector& InMin, const FVector& InMax, FuncType InFunc)
+{
+	const FIntPoint MinCell = GetCell(InMin);
+	const FIntPoint MaxCell = GetCell(InMax);
+	for (int32 X = MinCell.X; X <= MaxCell.X; X++)
+	{
+		for (int32 Y = MinCell.Y; Y <= MaxCell.Y; Y++)
+		{
+			const TArray<int32>* Cell = InIndex.Cells.Find(FIntPoint(X, Y));
+			if (!Cell)
+			{
+				continue;
+			}
+			for (int32 EntryIndex : *Cell)
+			{
+				InFunc(InIndex.Entries[EntryIndex]);
+			}
+		}
+	}
+}
+bool UAFSpatialIndex::PassesFilter(const FSpatialEntry& InEntry, const FGameplayTagContainer& InRequiredTags,
+	UAFAbilityComponent*& OutComponent)
+{
+	OutComponent = InEntry.Component.Get();
+	if (!OutComponent)
+	{
+		//component might not have been created yet when actor was registered.
+		IAFAbilityInterface* Interface = Cast<IAFAbilityInterface>(InEntry.Actor.Get());
+		OutComponent = Interface ? Interface->GetAbilityComp() : nullptr;
+		if (!OutComponent)
+		{
+			return false;
+		}
+		const_cast<FSpatialEntry&>(InEntry).Component = OutComponent;
+	}
+	if (InRequiredTags.Num() > 0 && !OutComponent->AppliedTags.AllTags.HasAll(InRequiredTags))
+	{
+		return false;
+	}
+	return true;
+}
+
+void UAFSpatialIndex::QueryRadius(UWorld* InWorld, const FVector& InCenter, float InRadius,
+	const FGameplayTagContainer& InRequiredTags, TArray<UAFAbilityComponent*>& OutComponents)
+{
+	FWorldSpatialIndex* Index = GetUpdatedWorld(InWorld);
+	if (!Index)
+	{
+		return;
+	}
+	SCOPE_CYCLE_COUNTER(STAT_SpatialIndexQuery);
+	const float RadiusSq = InRadius * InRadius;
+	const FVector Extent(InRadius);
+	ForEachInBounds(*Index, InCenter - Extent, InCenter + Extent, [&](const FSpatialEntry& Entry)
+	{
+		UAFAbilityComponent* Component = nullptr;
+		if (FVector::DistSquared(Entry.Location, InCenter) <= RadiusSq
+			&& PassesFilter(Entry, InRequiredTags, Component))
+		{
+			OutComponents.Add(Component);
+		}
+	});
+}
+void UAFSpatialIndex::QueryCone(UWorld* InWorld, const FVector& InOrigin, const FVector& InDirection, float InLength, float InHalfAngle,
+	const FGameplayTagContainer& InRequiredTags, TArray<UAFAbilityComponent*>& OutComponents)
+{
+	FWorldSpatialIndex* Index = GetUpdatedWorld(InWorld);
+	if (!Index)
+	{
+		return;
+	}
+	SCOPE_CYCLE_COUNTER(STAT_SpatialIndexQuery);
+	const FVector Direction = InDirection.GetSafeNormal();
+	const float LengthSq = InLength * InLength;
+	const float CosHalfAngle = FMath::Cos(FMath::DegreesToRadians(FMath::Clamp(InHalfAngle, 0.0f, 180.0f)));
+	const FVector Extent(InLength);
+	ForEachInBounds(*Index, InOrigin - Extent, InOrigin + Extent, [&](const FSpatialEntry& Entry)
+	{
+		const FVector ToEntry = Entry.Location - InOrigin;
+		const float DistSq = ToEntry.SizeSquared();
+		if (DistSq > LengthSq)
+		{
+			return;
+		}
+		//actor at the origin is inside.
+		if (DistSq > SMALL_NUMBER && FVector::DotProduct(ToEntry * FMath::InvSqrt(DistSq), Direction) < CosHalfAngle)
+		{
+			return;
+		}
+		UAFAbilityComponent* Component = nullptr;
+		if (PassesFilter(Entry, InRequiredTags, Component))
+		{
+			OutComponents.Add(Component);
+		}
+	});
+}
+void UAFSpatialIndex::QueryBox(UWorld* InWorld, const FBox& InBox,
+	const FGameplayTagContainer& InRequiredTags, TArray<UAFAbilityComponent*>& OutComponents)
+{
+	FWorldSpatialIndex* Index = GetUpdatedWorld(InWorld);
+	if (!Index)
+	{
+		return;
+	}
+	SCOPE_CYCLE_COUNTER(STAT_SpatialIndexQuery);
+	ForEachInBounds(*Index, InBox.Min, InBox.Max, [&](const FSpatialEntry& Entry)
+	{
+		UAFAbilityComponent* Component = nullptr;
+		if (InBox.IsInsideOrOn(Entry.Location) && PassesFilter(Entry, InRequiredTags, Component))
+		{
+			OutComponents.Add(Component);
+		}
+	});
+}
+
+void UAFSpatialIndex::FindAbilityComponentsInRadius(UObject* WorldContextObject, FVector Center, float Radius,
+	FGameplayTagContainer RequiredTags, TArray<UAFAbilityComponent*>& OutComponents)
+{
+	UWorld* World = GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::LogAndReturnNull);
+	Get()->QueryRadius(World, Center, Radius, RequiredTags, OutComponents);
+}
+void UAFSpatialIndex::FindAbilityComponentsInCone(UObject* WorldContextObject, FVector Origin, FVector Direction, float Length,
+	float HalfAngle, FGameplayTagContainer RequiredTags, TArray<UAFAbilityComponent*>& OutComponents)
+{
+	UWorld* World = GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::LogAndReturnNull);
+	Get()->QueryCone(World, Origin, Direction, Length, HalfAngle, RequiredTags, OutComponents);
+}
+void UAFSpatialIndex::FindAbilityComponentsInBox(UObject* WorldContextObject, FVector Center, FVector Extent,
+	FGameplayTagContainer RequiredTags, TArray<UAFAbilityComponent*>& OutComponents)
+{
+	UWorld* World = GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::LogAndReturnNull);
+	Get()->QueryBox(World, FBox(Center - Extent, Center + Extent), RequiredTags, OutComponents);
+}
+
+void UAFSpatialIndex::HandleActorSpawned(AActor* InActor)
+{
+	if (TUniquePtr<FWorldSpatialIndex>* IndexPtr = WorldIndices.Find(FObjectKey(InActor->GetWorld())))
+	{
+		AddEntry(**IndexPtr, InActor);
+	}
+}
+void UAFSpatialIndex::HandleWorldCleanup(UWorld* InWorld, bool bSessionEnded, bool bCleanupResources)
+{
+	TUniquePtr<FWorldSpatialIndex>* IndexPtr = WorldIndices.Find(FObjectKey(InWorld));
+	if (!IndexPtr)
+	{
+		return;
+	}
+	DEC_DWORD_STAT_BY(STAT_SpatialIndexActors, (*IndexPtr)->Entries.Num());
+	InWorld->RemoveOnActorSpawnedHandler((*IndexPtr)->ActorSpawnedHandle);
+	WorldIndices.Remove(FObjectKey(InWorld));
+}
@@ -0,0 +1,108 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/NoExportTypes.h"
+#include "GameplayTagContainer.h"
+#include "Abilities/AFAbilityStats.h"
+#include "AFSpatialIndex.generated.h"
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Spatial Index Update"), STAT_SpatialIndexUpdate, STATGROUP_Abilities, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Spatial Index Query"), STAT_SpatialIndexQuery, STATGROUP_Abilities, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Spatial Index Actors"), STAT_SpatialIndexActors, STATGROUP_Abilities, );
+
+/*
+	Per world uniform grid (XY, Z is only tested against query shape) of all actors
+	implementing IAFAbilityInterface, for area targeting and effect fields.
+
+	Actors are picked up automatically when world is first queried and when they are spawned.
+	Positions are refreshed lazily, once per frame, on first query. Only actors which changed
+	cell are moved between cells. Destroyed actors are dropped on refresh.
+*/
+UCLASS(config = Game)
+class ABILITYFRAMEWORK_API UAFSpatialIndex : public UObject
+{
+	GENERATED_BODY()
+protected:
+	static UAFSpatialIndex* IndexInstance;
+
+	UPROPERTY(config)
+		float CellSize;
+
+	struct FSpatialEntry
+	{
+		TWeakObjectPtr<AActor> Actor;
+		/* Actor might be gone when entry is removed. */
+		FObjectKey Key;
+		TWeakObjectPtr<class UAFAbilityComponent> Component;
+		FVector Location;
+		FIntPoint Cell;
+		/* Position in Cells[Cell], kept up to date when cell array is swapped. */
+		int32 CellIndex;
+	};
+
+	struct FWorldSpatialIndex
+	{
+		TArray<FSpatialEntry> Entries;
+		TMap<FObjectKey, int32> EntryIndices;
+		TMap<FIntPoint, TArray<int32>> Cells;
+		uint64 LastUpdateFrame;
+		FDelegateHandle ActorSpawnedHandle;
+
+		FWorldSpatialIndex()
+			: LastUpdateFrame(MAX_uint64)
+		{}
+	};
+
+	TMap<FObjectKey, TUniquePtr<FWorldSpatialIndex>> WorldIndices;
+public:
+	UAFSpatialIndex(const FObjectInitializer& ObjectInitializer);
+
+	static UAFSpatialIndex* Get();
+	void Initialize();
+
+	/* Actors implementing IAFAbilityInterface are registered automatically. */
+	void RegisterActor(AActor* InActor);
+	void UnregisterActor(AActor* InActor);
+
+	void QueryRadius(UWorld* InWorld, const FVector& InCenter, float InRadius,
+		const FGameplayTagContainer& InRequiredTags, TArray<class UAFAbilityComponent*>& OutComponents);
+	/* InHalfAngle in degrees. */
+	void QueryCone(UWorld* InWorld, const FVector& InOrigin, const FVector& InDirection, float InLength, float InHalfAngle,
+		const FGameplayTagContainer& InRequiredTags, TArray<class UAFAbilityComponent*>& OutComponents);
+	void QueryBox(UWorld* InWorld, const FBox& InBox,
+		const FGameplayTagContainer& InRequiredTags, TArray<class UAFAbilityComponent*>& OutComponents);
+
+	UFUNCTION(BlueprintCallable, meta = (WorldContext = "WorldContextObject"), Category = "AbilityFramework|Targeting")
+		static void FindAbilityComponentsInRadius(UObject* WorldContextObject, FVector Center, float Radius,
+			FGameplayTagContainer RequiredTags, TArray<class UAFAbilityComponent*>& OutComponents);
+	UFUNCTION(BlueprintCallable, meta = (WorldContext = "WorldContextObject"), Category = "AbilityFramework|Targeting")
+		static void FindAbilityComponentsInCone(UObject* WorldContextObject, FVector Origin, FVector Direction, float Length,
+			float HalfAngle, FGameplayTagContainer RequiredTags, TArray<class UAFAbilityComponent*>& OutComponents);
+	UFUNCTION(BlueprintCallable, meta = (WorldContext = "WorldContextObject"), Category = "AbilityFramework|Targeting")
+		static void FindAbilityComponentsInBox(UObject* WorldContextObject, FVector Center, FVector Extent,
+			FGameplayTagContainer RequiredTags, TArray<class UAFAbilityComponent*>& OutComponents);
+
+protected:
+	FWorldSpatialIndex& FindOrAddWorld(UWorld* InWorld);
+	/* Refreshes positions if it wasn't done this frame. */
+	FWorldSpatialIndex* GetUpdatedWorld(UWorld* InWorld);
+	void UpdatePositions(FWorldSpatialIndex& InIndex);
+	void AddEntry(FWorldSpatialIndex& InIndex, AActor* InActor);
+	void RemoveEntry(FWorldSpatialIndex& InIndex, int32 InEntryIndex);
+	void AddToCell(FWorldSpatialIndex& InIndex, int32 InEntryIndex);
+	void RemoveFromCell(FWorldSpatialIndex& InIndex, int32 InEntryIndex);
+	inline FIntPoint GetCell(const FVector& InLocation) const
+	{
+		return FIntPoint(FMath::FloorToInt(InLocation.X / CellSize), FMath::FloorToInt(InLocation.Y / CellSize));
+	}
+	/* Calls InFunc(Entry) for every entry in cells overlapping InMin/InMax. */
+	template<typename FuncType>
+	void ForEachInBounds(FWorldSpatialIndex& InIndex, const FVector& InMin, const FVector& InMax, FuncType InFunc);
+	static bool PassesFilter(const FSpatialEntry& InEntry, const FGameplayTagContainer& InRequiredTags,
+		class UAFAbilityComponent*& OutComponent);
+
+	void HandleActorSpawned(AActor* InActor);
+	void HandleWorldCleanup(UWorld* InWorld, bool bSessionEnded, bool bCleanupResources);
+};
@@ -0,0 +1,9 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+
+/* Stat group for abilities, ability tasks, spatial index and latent actions. */
+DECLARE_STATS_GROUP(TEXT("Abilities"), STATGROUP_Abilities, STATCAT_Advanced);
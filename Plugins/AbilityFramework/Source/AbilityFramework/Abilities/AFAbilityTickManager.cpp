@@ -0,0 +1,302 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "../AbilityFramework.h"
+#include "GAAbilityBase.h"
+#include "../AFAbilityComponent.h"
+#include "Async/ParallelFor.h"
+#include "AFAbilityTickManager.h"
+
+DEFINE_STAT(STAT_TickAbilities);
+DEFINE_STAT(STAT_AbilitiesTicked);
+DEFINE_STAT(STAT_RegisteredTickingAbilities);
+DEFINE_STAT(STAT_BuildAbilitySnapshots);
+DEFINE_STAT(STAT_ParallelAbilityUpdate);
+DEFINE_STAT(STAT_ExecuteAbilityCommands);
+DEFINE_STAT(STAT_AbilitiesParallelUpdated);
+DEFINE_STAT(STAT_AbilityCommands);
+
+static TAutoConsoleVariable<int32> CVarParallelAbilityUpdate(
+	TEXT("AbilityFramework.ParallelAbilityUpdate"),
+	1,
+	TEXT("1 - abilities with bParallelUpdate are updated on worker threads.\n")
+	TEXT("0 - parallel update phase runs on game thread."));
+
+/* How many abilities are updated by single worker task (and share single command queue). */
+static const int32 AbilitiesPerBatch = 64;
+
+void FAFAbilityTickFunction::ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent)
+{
+	if (Manager && World.IsValid())
+	{
+		Manager->TickWorld(World.Get(), DeltaTime, TickType);
+	}
+}
+
+FString FAFAbilityTickFunction::DiagnosticMessage()
+{
+	return FString(TEXT("UAFAbilityTickManager[TickAbilities]"));
+}
+
+UAFAbilityTickManager* UAFAbilityTickManager::ManagerInstance = nullptr;
+
+UAFAbilityTickManager::UAFAbilityTickManager(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+}
+
+UAFAbilityTickManager* UAFAbilityTickManager::Get()
+{
+	if (ManagerInstance)
+	{
+		return ManagerInstance;
+	}
+	ManagerInstance = NewObject<UAFAbilityTickManager>(GEngine, UAFAbilityTickManager::StaticClass(), "UAFAbilityTickManagerInstance",
+		RF_MarkAsRootSet);
+	ManagerInstance->AddToRoot();
+	ManagerInstance->Initialize();
+
+	return ManagerInstance;
+}
+void UAFAbilityTickManager::Initialize()
+{
+	FWorldDelegates::OnWorldCleanup.AddUObject(this, &UAFAbilityTickManager::HandleWorldCleanup);
+}
+
+void UAFAbilityTickManager::AddAbility(UGAAbilityBase* InAbility, UWorld* InWorld)
+{
+	if (!InAbility || !InWorld || InAbility->TickIndex != INDEX_NONE)
+	{
+		return;
+	}
+	FWorldAbilityTick& WorldTick = FindOrAddWorld(InWorld);
+	InAbility->TickIndex = WorldTick.Abilities.Add(InAbility);
+	InAbility->TickWorld = FObjectKey(InWorld);
+	INC_DWORD_STAT(STAT_RegisteredTickingAbilities);
+}
+void UAFAbilityTickManager::RemoveAbility(UGAAbilityBase* InAbility)
+{
+	if (!InAbility || InAbility->TickIndex == INDEX_NONE)
+	{
+		return;
+	}
+	TUniquePtr<FWorldAbilityTick>* WorldTickPtr = WorldTicks.Find(InAbility->TickWorld);
+	const int32 Index = InAbility->TickIndex;
+	InAbility->TickIndex = INDEX_NONE;
+	InAbility->TickWorld = FObjectKey();
+	if (!WorldTickPtr || !WorldTickPtr->IsValid())
+	{
+		return;
+	}
+	FWorldAbilityTick& WorldTick = **WorldTickPtr;
+	//called from BeginDestroy too, when weak pointer doesn't resolve anymore.
+	if (!WorldTick.Abilities.IsValidIndex(Index) 
+		|| !WorldTick.Abilities[Index].HasSameIndexAndSerialNumber(TWeakObjectPtr<UGAAbilityBase>(InAbility)))
+	{
+		return;
+	}
+	//don't move anything around while iterating, just leave hole.
+	if (WorldTick.bIsTicking)
+	{
+		WorldTick.Abilities[Index].Reset();
+		WorldTick.bNeedsCompact = true;
+		return;
+	}
+	DEC_DWORD_STAT(STAT_RegisteredTickingAbilities);
+	WorldTick.Abilities.RemoveAtSwap(Index, 1, false);
+	if (WorldTick.Abilities.IsValidIndex(Index))
+	{
+		if (UGAAbilityBase* Moved = WorldTick.Abilities[Index].Get())
+		{
+			Moved->TickIndex = Index;
+		}
+		else
+		{
+			WorldTick.bNeedsCompact = true;
+		}
+	}
+}
+
+void UAFAbilityTickManager::TickWorld(UWorld* InWorld, float DeltaTime, ELevelTick TickType)
+{
+	SCOPE_CYCLE_COUNTER(STAT_TickAbilities);
+	TUniquePtr<FWorldAbilityTick>* WorldTickPtr = WorldTicks.Find(FObjectKey(InWorld));
+	if (!WorldTickPtr || !WorldTickPtr->IsValid())
+	{
+		return;
+	}
+	FWorldAbilityTick& WorldTick = **WorldTickPtr;
+	WorldTick.bIsTicking = true;
+	//abilities added during tick, will tick next frame.
+	const int32 Num = WorldTick.Abilities.Num();
+	int32 NumTicked = 0;
+	ParallelAbilities.Reset();
+	for (int32 Idx = 0; Idx < Num; Idx++)
+	{
+		UGAAbilityBase* Ability = WorldTick.Abilities[Idx].Get();
+		if (!Ability)
+		{
+			//removed during tick or garbage collected.
+			WorldTick.bNeedsCompact = true;
+			continue;
+		}
+		if (Ability->IsPendingKillOrUnreachable())
+		{
+			continue;
+		}
+		if (Ability->bParallelUpdate)
+		{
+			ParallelAbilities.Add(Ability);
+			continue;
+		}
+		Ability->TickAbility(DeltaTime, TickType);
+		NumTicked++;
+	}
+	INC_DWORD_STAT_BY(STAT_AbilitiesTicked, NumTicked);
+	if (ParallelAbilities.Num() > 0)
+	{
+		RunParallelUpdate(DeltaTime);
+	}
+	WorldTick.bIsTicking = false;
+	if (WorldTick.bNeedsCompact)
+	{
+		Compact(WorldTick);
+	}
+}
+int32 UAFAbilityTickManager::GetNumTickingAbilities(UWorld* InWorld) const
+{
+	const TUniquePtr<FWorldAbilityTick>* WorldTickPtr = WorldTicks.Find(FObjectKey(InWorld));
+	if (!WorldTickPtr || !WorldTickPtr->IsValid())
+	{
+		return 0;
+	}
+	int32 Num = 0;
+	for (const TWeakObjectPtr<UGAAbilityBase>& Ability : (*WorldTickPtr)->Abilities)
+	{
+		Num += Ability.IsValid() ? 1 : 0;
+	}
+	return Num;
+}
+
+void UAFAbilityTickManager::RunParallelUpdate(float DeltaTime)
+{
+	const int32 NumAbilities = ParallelAbilities.Num();
+	{
+		SCOPE_CYCLE_COUNTER(STAT_BuildAbilitySnapshots);
+		OwnerSnapshots.Reset();
+		OwnerSnapshotIndices.Reset();
+		Snapshots.SetNum(NumAbilities, false);
+		TArray<int32, TInlineAllocator<64>> OwnerIndices;
+		OwnerIndices.SetNumUninitialized(NumAbilities);
+		for (int32 Idx = 0; Idx < NumAbilities; Idx++)
+		{
+			UGAAbilityBase* Ability = ParallelAbilities[Idx];
+			Ability->MakeFrameSnapshot(Snapshots[Idx]);
+			//abilities of the same owner share owner data.
+			UAFAbilityComponent* OwnerComp = Ability->AbilityComponent;
+			int32* OwnerIdx = OwnerSnapshotIndices.Find(OwnerComp);
+			if (!OwnerIdx)
+			{
+				const int32 NewIdx = OwnerSnapshots.AddDefaulted();
+				if (OwnerComp)
+				{
+					OwnerSnapshots[NewIdx].OwnedTags = OwnerComp->AppliedTags.AllTags;
+				}
+				OwnerIdx = &OwnerSnapshotIndices.Add(OwnerComp, NewIdx);
+			}
+			OwnerIndices[Idx] = *OwnerIdx;
+		}
+		//owner array is not going to grow anymore.
+		for (int32 Idx = 0; Idx < NumAbilities; Idx++)
+		{
+			Snapshots[Idx].Owner = &OwnerSnapshots[OwnerIndices[Idx]];
+		}
+	}
+
+	const int32 NumBatches = FMath::DivideAndRoundUp(NumAbilities, AbilitiesPerBatch);
+	if (CommandQueues.Num() < NumBatches)
+	{
+		CommandQueues.SetNum(NumBatches);
+	}
+	{
+		SCOPE_CYCLE_COUNTER(STAT_ParallelAbilityUpdate);
+		const bool bForceSingleThread = CVarParallelAbilityUpdate.GetValueOnGameThread() == 0;
+		ParallelFor(NumBatches, [this, DeltaTime, NumAbilities](int32 BatchIdx)
+		{
+			FAFAbilityCommandQueue& Queue = CommandQueues[BatchIdx];
+			const int32 Start = BatchIdx * AbilitiesPerBatch;
+			const int32 End = FMath::Min(Start + AbilitiesPerBatch, NumAbilities);
+			for (int32 Idx = Start; Idx < End; Idx++)
+			{
+				ParallelAbilities[Idx]->NativeParallelUpdate(DeltaTime, Snapshots[Idx], Queue);
+			}
+		}, bForceSingleThread);
+	}
+	INC_DWORD_STAT_BY(STAT_AbilitiesParallelUpdated, NumAbilities);
+
+	//sync point. Batch order, so result doesn't depend on which worker finished first.
+	{
+		SCOPE_CYCLE_COUNTER(STAT_ExecuteAbilityCommands);
+		for (int32 BatchIdx = 0; BatchIdx < NumBatches; BatchIdx++)
+		{
+			INC_DWORD_STAT_BY(STAT_AbilityCommands, CommandQueues[BatchIdx].Commands.Num());
+			CommandQueues[BatchIdx].Execute();
+		}
+	}
+}
+
+UAFAbilityTickManager::FWorldAbilityTick& UAFAbilityTickManager::FindOrAddWorld(UWorld* InWorld)
+{
+	TUniquePtr<FWorldAbilityTick>& WorldTick = WorldTicks.FindOrAdd(FObjectKey(InWorld));
+	if (!WorldTick.IsValid())
+	{
+		WorldTick = MakeUnique<FWorldAbilityTick>();
+		FAFAbilityTickFunction& TickFunction = WorldTick->TickFunction;
+		TickFunction.Manager = this;
+		TickFunction.World = InWorld;
+		TickFunction.TickGroup = TG_PrePhysics;
+		TickFunction.bCanEverTick = true;
+		TickFunction.bStartWithTickEnabled = true;
+		TickFunction.bAllowTickOnDedicatedServer = true;
+		TickFunction.RegisterTickFunction(InWorld->PersistentLevel);
+	}
+	return *WorldTick;
+}
+void UAFAbilityTickManager::Compact(FWorldAbilityTick& InWorldTick)
+{
+	int32 WriteIdx = 0;
+	for (int32 ReadIdx = 0; ReadIdx < InWorldTick.Abilities.Num(); ReadIdx++)
+	{
+		UGAAbilityBase* Ability = InWorldTick.Abilities[ReadIdx].Get();
+		if (Ability)
+		{
+			Ability->TickIndex = WriteIdx;
+			InWorldTick.Abilities[WriteIdx++] = Ability;
+		}
+	}
+	DEC_DWORD_STAT_BY(STAT_RegisteredTickingAbilities, InWorldTick.Abilities.Num() - WriteIdx);
+	InWorldTick.Abilities.SetNum(WriteIdx, false);
+	InWorldTick.bNeedsCompact = false;
+}
+void UAFAbilityTickManager::HandleWorldCleanup(UWorld* InWorld, bool bSessionEnded, bool bCleanupResources)
+{
+	TUniquePtr<FWorldAbilityTick>* WorldTickPtr = WorldTicks.Find(FObjectKey(InWorld));
+	if (!WorldTickPtr)
+	{
+		return;
+	}
+	if (WorldTickPtr->IsValid())
+	{
+		FWorldAbilityTick& WorldTick = **WorldTickPtr;
+		for (const TWeakObjectPtr<UGAAbilityBase>& AbilityPtr : WorldTick.Abilities)
+		{
+			if (UGAAbilityBase* Ability = AbilityPtr.Get())
+			{
+				Ability->TickIndex = INDEX_NONE;
+				Ability->TickWorld = FObjectKey();
+			}
+		}
+		DEC_DWORD_STAT_BY(STAT_RegisteredTickingAbilities, WorldTick.Abilities.Num());
+		WorldTick.TickFunction.UnRegisterTickFunction();
+	}
+	WorldTicks.Remove(FObjectKey(InWorld));
+}
@@ -0,0 +1,103 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/NoExportTypes.h"
+#include "Engine/EngineBaseTypes.h"
+#include "AFAbilityUpdateTypes.h"
+#include "AFAbilityStats.h"
+#include "AFAbilityTickManager.generated.h"
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Tick Abilities"), STAT_TickAbilities, STATGROUP_Abilities, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Abilities Ticked"), STAT_AbilitiesTicked, STATGROUP_Abilities, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Registered Ticking Abilities"), STAT_RegisteredTickingAbilities, STATGROUP_Abilities, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Build Ability Snapshots"), STAT_BuildAbilitySnapshots, STATGROUP_Abilities, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Parallel Ability Update"), STAT_ParallelAbilityUpdate, STATGROUP_Abilities, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Execute Ability Commands"), STAT_ExecuteAbilityCommands, STATGROUP_Abilities, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Abilities Updated In Parallel"), STAT_AbilitiesParallelUpdated, STATGROUP_Abilities, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Ability Commands"), STAT_AbilityCommands, STATGROUP_Abilities, );
+
+USTRUCT()
+struct FAFAbilityTickFunction : public FTickFunction
+{
+	GENERATED_USTRUCT_BODY()
+	class UAFAbilityTickManager* Manager;
+	TWeakObjectPtr<UWorld> World;
+
+	virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent) override;
+	virtual FString DiagnosticMessage() override;
+};
+template<>
+struct TStructOpsTypeTraits<FAFAbilityTickFunction> : public TStructOpsTypeTraitsBase2<FAFAbilityTickFunction>
+{
+	enum
+	{
+		WithCopy = false
+	};
+};
+
+/*
+	Single tick function per world, which ticks all abilities that need it, instead
+	of every ability registering it's own tick function.
+
+	Ability is in the list only when it opted in (bAlwaysTick) or is activating, so
+	idle abilities (most of them, most of the time) cost nothing.
+	List is contiguous, abilities removed while ticking are nulled and compacted after tick.
+	List doesn't keep abilities alive, ability which is garbage collected leaves it on BeginDestroy.
+
+	Abilities with bParallelUpdate are not ticked, instead they are updated in parallel phase:
+	snapshots are built on game thread, abilities are updated in contiguous batches on worker threads
+	(each batch records to it's own command queue) and queues are executed in batch order on game thread.
+	Set AbilityFramework.ParallelAbilityUpdate 0 to run the same phase on game thread only.
+*/
+UCLASS()
+class ABILITYFRAMEWORK_API UAFAbilityTickManager : public UObject
+{
+	GENERATED_BODY()
+protected:
+	static UAFAbilityTickManager* ManagerInstance;
+
+	struct FWorldAbilityTick
+	{
+		FAFAbilityTickFunction TickFunction;
+		TArray<TWeakObjectPtr<class UGAAbilityBase>> Abilities;
+		bool bIsTicking;
+		bool bNeedsCompact;
+
+		FWorldAbilityTick()
+			: bIsTicking(false),
+			bNeedsCompact(false)
+		{}
+	};
+
+	TMap<FObjectKey, TUniquePtr<FWorldAbilityTick>> WorldTicks;
+
+	/* Scratch data for parallel update, reused every frame. */
+	TArray<class UGAAbilityBase*> ParallelAbilities;
+	TArray<FAFAbilityFrameSnapshot> Snapshots;
+	TArray<FAFAbilityOwnerSnapshot> OwnerSnapshots;
+	TMap<const UObject*, int32> OwnerSnapshotIndices;
+	TArray<FAFAbilityCommandQueue> CommandQueues;
+public:
+	UAFAbilityTickManager(const FObjectInitializer& ObjectInitializer);
+
+	static UAFAbilityTickManager* Get();
+	/* Doesn't create manager, use during destruction. */
+	static UAFAbilityTickManager* GetIfExists() { return ManagerInstance; }
+
+	void Initialize();
+
+	void AddAbility(class UGAAbilityBase* InAbility, UWorld* InWorld);
+	void RemoveAbility(class UGAAbilityBase* InAbility);
+
+	void TickWorld(UWorld* InWorld, float DeltaTime, ELevelTick TickType);
+
+	int32 GetNumTickingAbilities(UWorld* InWorld) const;
+
+protected:
+	FWorldAbilityTick& FindOrAddWorld(UWorld* InWorld);
+	void RunParallelUpdate(float DeltaTime);
+	void Compact(FWorldAbilityTick& InWorldTick);
+	void HandleWorldCleanup(UWorld* InWorld, bool bSessionEnded, bool bCleanupResources);
+};
@@ -0,0 +1,70 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "../AbilityFramework.h"
+#include "GAAbilityBase.h"
+#include "../Effects/GABlueprintLibrary.h"
+#include "../AFCueManager.h"
+#include "../AFCueReplication.h"
+#include "AFAbilityUpdateTypes.h"
+
+void FAFAbilityCommandQueue::ApplyEffect(UGAAbilityBase* InAbility, FGAEffectProperty& InEffect, UObject* InTarget)
+{
+	FAFAbilityCommand& Command = Commands[Commands.AddDefaulted()];
+	Command.Type = EAFAbilityCommand::ApplyEffect;
+	Command.Ability = InAbility;
+	Command.Effect = &InEffect;
+	Command.Target = InTarget;
+}
+void FAFAbilityCommandQueue::FinishAbility(UGAAbilityBase* InAbility)
+{
+	FAFAbilityCommand& Command = Commands[Commands.AddDefaulted()];
+	Command.Type = EAFAbilityCommand::FinishAbility;
+	Command.Ability = InAbility;
+}
+void FAFAbilityCommandQueue::FireCue(UGAAbilityBase* InAbility, const FGameplayTagContainer& InCueTags, const FGAEffectCueParams& InCueParams)
+{
+	FAFAbilityCommand& Command = Commands[Commands.AddDefaulted()];
+	Command.Type = EAFAbilityCommand::FireCue;
+	Command.Ability = InAbility;
+	Command.CueTags = InCueTags;
+	Command.CueParams = InCueParams;
+}
+
+void FAFAbilityCommandQueue::Execute()
+{
+	check(IsInGameThread());
+	for (FAFAbilityCommand& Command : Commands)
+	{
+		UGAAbilityBase* Ability = Command.Ability;
+		if (!Ability || Ability->IsPendingKill())
+		{
+			continue;
+		}
+		switch (Command.Type)
+		{
+		case EAFAbilityCommand::ApplyEffect:
+		{
+			if (Command.Effect && Command.Target && !Command.Target->IsPendingKill())
+			{
+				FAFFunctionModifier Modifier;
+				UGABlueprintLibrary::ApplyGameEffectToObject(*Command.Effect, Command.Target,
+					Ability->POwner, Ability, Modifier);
+			}
+			break;
+		}
+		case EAFAbilityCommand::FinishAbility:
+		{
+			Ability->FinishAbility();
+			break;
+		}
+		case EAFAbilityCommand::FireCue:
+		{
+			UAFCueReplicationComponent::ExecuteCue(Ability->GetWorld(), Command.CueTags, Command.CueParams, true);
+			break;
+		}
+		default:
+			break;
+		}
+	}
+	Reset();
+}
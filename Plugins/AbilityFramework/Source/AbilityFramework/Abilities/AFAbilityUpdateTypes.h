@@ -0,0 +1,88 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameplayTagContainer.h"
+#include "../GAGlobalTypes.h"
+
+/*
+	Types used by parallel ability update (see UAFAbilityTickManager).
+
+	Parallel update contract:
+	1. Game thread copies everything ability might want to read into FAFAbilityFrameSnapshot.
+	2. Worker threads call UGAAbilityBase::NativeParallelUpdate. Ability can read snapshot
+	and modify it's own plain data, but must not call any UObject functions (including it's own
+	UFUNCTIONs) or touch component, world, effects etc.
+	Anything with side effects is pushed as command to FAFAbilityCommandQueue.
+	3. Game thread executes all queues, in order, at sync point.
+*/
+
+/* Data of single ability owner, shared by all abilities of that owner in this frame. */
+struct FAFAbilityOwnerSnapshot
+{
+	FGameplayTagContainer OwnedTags;
+};
+
+struct FAFAbilityFrameSnapshot
+{
+	const FAFAbilityOwnerSnapshot* Owner;
+	/* Indexes match UGAAbilityBase::SnapshotAttributes. */
+	TArray<float, TInlineAllocator<4>> AttributeValues;
+	float WorldTime;
+	float CooldownEndTime;
+	bool bIsActivating;
+
+	FAFAbilityFrameSnapshot()
+		: Owner(nullptr),
+		WorldTime(0),
+		CooldownEndTime(0),
+		bIsActivating(false)
+	{}
+
+	inline bool IsOnCooldown() const { return CooldownEndTime > WorldTime; }
+};
+
+enum class EAFAbilityCommand : uint8
+{
+	ApplyEffect,
+	FinishAbility,
+	FireCue
+};
+
+struct FAFAbilityCommand
+{
+	EAFAbilityCommand Type;
+	class UGAAbilityBase* Ability;
+	/* ApplyEffect. Must point to property owned by ability. */
+	FGAEffectProperty* Effect;
+	/* Raw pointer, weak pointers can't be made on worker thread. GC doesn't run before queue is executed. */
+	UObject* Target;
+	/* FireCue */
+	FGameplayTagContainer CueTags;
+	FGAEffectCueParams CueParams;
+
+	FAFAbilityCommand()
+		: Type(EAFAbilityCommand::FinishAbility),
+		Ability(nullptr),
+		Effect(nullptr),
+		Target(nullptr)
+	{}
+};
+
+/*
+	Commands recorded by single batch of abilities. Each batch runs on single worker,
+	so there is no locking.
+*/
+struct ABILITYFRAMEWORK_API FAFAbilityCommandQueue
+{
+	TArray<FAFAbilityCommand> Commands;
+
+	void ApplyEffect(class UGAAbilityBase* InAbility, FGAEffectProperty& InEffect, UObject* InTarget);
+	void FinishAbility(class UGAAbilityBase* InAbility);
+	void FireCue(class UGAAbilityBase* InAbility, const FGameplayTagContainer& InCueTags, const FGAEffectCueParams& InCueParams);
+
+	/* Game thread only. */
+	void Execute();
+	inline void Reset() { Commands.Reset(); }
+};
@@ -0,0 +1,143 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "../AbilityFramework.h"
+#include "../AFAbilityComponent.h"
+#include "AFNonInstancedAbility.h"
+
+void FAFNonInstancedAbilityContainer::Initialize(UAFAbilityComponent* InComponent)
+{
+	AbilityComponent = InComponent;
+}
+
+int32 FAFNonInstancedAbilityContainer::AddAbility(TSubclassOf<UGAAbilityBase> InAbilityClass)
+{
+	if (!InAbilityClass)
+	{
+		return INDEX_NONE;
+	}
+	UGAAbilityBase* CDO = InAbilityClass->GetDefaultObject<UGAAbilityBase>();
+	if (CDO->Instancing != EAFAbilityInstancing::NonInstanced)
+	{
+		UE_LOG(AbilityFramework, Warning, TEXT("Ability %s is not marked as NonInstanced, it might depend on per instance data."),
+			*InAbilityClass->GetName());
+	}
+	for (int32 Idx = 0; Idx < Abilities.Num(); Idx++)
+	{
+		if (Abilities[Idx].AbilityClass == InAbilityClass)
+		{
+			return Idx;
+		}
+	}
+	int32 Index = Abilities.AddDefaulted();
+	Abilities[Index].AbilityClass = InAbilityClass;
+	return Index;
+}
+
+void FAFNonInstancedAbilityContainer::RemoveAbility(TSubclassOf<UGAAbilityBase> InAbilityClass)
+{
+	for (int32 Idx = 0; Idx < Abilities.Num(); Idx++)
+	{
+		if (Abilities[Idx].AbilityClass == InAbilityClass)
+		{
+			FinishAbility(Idx);
+			Abilities.RemoveAt(Idx);
+			return;
+		}
+	}
+}
+
+int32 FAFNonInstancedAbilityContainer::FindAbility(const FGameplayTag& InAbilityTag) const
+{
+	for (int32 Idx = 0; Idx < Abilities.Num(); Idx++)
+	{
+		UGAAbilityBase* CDO = Abilities[Idx].GetAbility();
+		if (CDO && CDO->AbilityTag == InAbilityTag)
+		{
+			return Idx;
+		}
+	}
+	return INDEX_NONE;
+}
+
+bool FAFNonInstancedAbilityContainer::CanUseAbility(int32 InIndex) const
+{
+	if (!Abilities.IsValidIndex(InIndex))
+	{
+		return false;
+	}
+	const FAFAbilityInstanceState& State = Abilities[InIndex];
+	UGAAbilityBase* CDO = State.GetAbility();
+	return CDO && CDO->CanUseAbilityNonInstanced(State, AbilityComponent, GetWorldTime());
+}
+
+bool FAFNonInstancedAbilityContainer::ActivateAbility(int32 InIndex)
+{
+	if (!AbilityComponent || !Abilities.IsValidIndex(InIndex))
+	{
+		return false;
+	}
+	FAFAbilityInstanceState& State = Abilities[InIndex];
+	const float WorldTime = GetWorldTime();
+	//cached end times are not updated when effect is removed early, refresh them before refusing.
+	if (State.IsOnCooldown(WorldTime) && !AbilityComponent->GameEffectContainer.IsEffectActive(State.CooldownHandle))
+	{
+		State.CooldownEndTime = 0;
+	}
+	if (State.IsActivating(WorldTime) && !AbilityComponent->GameEffectContainer.IsEffectActive(State.ActivationHandle))
+	{
+		State.ActivationEndTime = 0;
+	}
+	if (!CanUseAbility(InIndex))
+	{
+		return false;
+	}
+	State.GetAbility()->StartActivationNonInstanced(State, AbilityComponent);
+	ShareCooldown(InIndex);
+	return true;
+}
+
+void FAFNonInstancedAbilityContainer::FinishAbility(int32 InIndex)
+{
+	if (!AbilityComponent || !Abilities.IsValidIndex(InIndex))
+	{
+		return;
+	}
+	FAFAbilityInstanceState& State = Abilities[InIndex];
+	if (State.State != EAFAbilityState::Activating)
+	{
+		return;
+	}
+	State.GetAbility()->FinishAbilityNonInstanced(State, AbilityComponent);
+}
+
+SIZE_T FAFNonInstancedAbilityContainer::GetAllocatedSize() const
+{
+	return sizeof(*this) + Abilities.GetAllocatedSize();
+}
+
+float FAFNonInstancedAbilityContainer::GetWorldTime() const
+{
+	UWorld* World = AbilityComponent ? AbilityComponent->GetWorld() : nullptr;
+	return World ? World->GetTimeSeconds() : 0;
+}
+
+void FAFNonInstancedAbilityContainer::ShareCooldown(int32 InIndex)
+{
+	const FAFAbilityInstanceState& Source = Abilities[InIndex];
+	const FGameplayTag& Group = Source.GetAbility()->CooldownGroup;
+	if (!Group.IsValid())
+	{
+		return;
+	}
+	for (int32 Idx = 0; Idx < Abilities.Num(); Idx++)
+	{
+		FAFAbilityInstanceState& Other = Abilities[Idx];
+		//take handle as well, so refresh in ActivateAbility checks the effect which is actually blocking.
+		if (Idx != InIndex && Other.GetAbility()->CooldownGroup == Group
+			&& Source.CooldownEndTime > Other.CooldownEndTime)
+		{
+			Other.CooldownEndTime = Source.CooldownEndTime;
+			Other.CooldownHandle = Source.CooldownHandle;
+		}
+	}
+}
@@ -0,0 +1,89 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameplayTagContainer.h"
+#include "../GAGlobalTypes.h"
+#include "GAAbilityBase.h"
+#include "AFNonInstancedAbility.generated.h"
+
+/*
+	Per owner state of non-instanced ability (EAFAbilityInstancing::NonInstanced).
+	Ability logic runs on class default object, everything which differs between owners is here.
+*/
+USTRUCT()
+struct ABILITYFRAMEWORK_API FAFAbilityInstanceState
+{
+	GENERATED_BODY()
+public:
+	UPROPERTY()
+		TSubclassOf<UGAAbilityBase> AbilityClass;
+
+	FGAEffectHandle CooldownHandle;
+	FGAEffectHandle ActivationHandle;
+	/* Binding on activation effect expiration, removed when activation ends. */
+	FDelegateHandle ActivationExpiredHandle;
+	float CooldownEndTime;
+	/* MAX_flt for infinite activation effect, it lasts until FinishAbility. */
+	float ActivationEndTime;
+	float LastActivationTime;
+	EAFAbilityState State;
+
+	FAFAbilityInstanceState()
+		: CooldownEndTime(0),
+		ActivationEndTime(0),
+		LastActivationTime(0),
+		State(EAFAbilityState::Waiting)
+	{}
+
+	inline UGAAbilityBase* GetAbility() const
+	{
+		return AbilityClass ? AbilityClass->GetDefaultObject<UGAAbilityBase>() : nullptr;
+	}
+	inline bool IsOnCooldown(float WorldTime) const { return CooldownEndTime > WorldTime; }
+	/* Activation without effect finishes right away, so only end time matters. */
+	inline bool IsActivating(float WorldTime) const
+	{
+		return State == EAFAbilityState::Activating && ActivationEndTime > WorldTime;
+	}
+};
+
+/*
+	Compact list of non-instanced abilities granted to single owner.
+	Replaces one UGAAbilityBase object (with tick, delegates, effect properties, context, attributes)
+	per ability per owner with one FAFAbilityInstanceState, which is what crowd AI needs.
+*/
+USTRUCT()
+struct ABILITYFRAMEWORK_API FAFNonInstancedAbilityContainer
+{
+	GENERATED_BODY()
+public:
+	UPROPERTY()
+		TArray<FAFAbilityInstanceState> Abilities;
+	UPROPERTY()
+		class UAFAbilityComponent* AbilityComponent;
+
+	FAFNonInstancedAbilityContainer()
+		: AbilityComponent(nullptr)
+	{}
+
+	void Initialize(class UAFAbilityComponent* InComponent);
+
+	/* Returns index of ability state. Adding the same class twice returns existing index. */
+	int32 AddAbility(TSubclassOf<UGAAbilityBase> InAbilityClass);
+	void RemoveAbility(TSubclassOf<UGAAbilityBase> InAbilityClass);
+	int32 FindAbility(const FGameplayTag& InAbilityTag) const;
+
+	bool CanUseAbility(int32 InIndex) const;
+	bool ActivateAbility(int32 InIndex);
+	void FinishAbility(int32 InIndex);
+
+	/* Bytes owned by this container. */
+	SIZE_T GetAllocatedSize() const;
+
+protected:
+	float GetWorldTime() const;
+	/* Cooldown from abilities with the same CooldownGroup is shared. */
+	void ShareCooldown(int32 InIndex);
+};
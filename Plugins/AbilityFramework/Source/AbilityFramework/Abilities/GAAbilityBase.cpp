@@ -3,6 +3,10 @@
 
 #include "../AbilityFramework.h"
 #include "Tasks/GAAbilityTask.h"
+#include "Tasks/GAAbilityTask_TargetData.h"
+#include "AFAbilityTickManager.h"
+#include "AFAbilityUpdateTypes.h"
+#include "AFNonInstancedAbility.h"
 #include "../Effects/GAGameEffect.h"
 #include "../GAGlobalTypes.h"
 #include "../Effects/GAEffectGlobalTypes.h"
@@ -17,34 +21,18 @@
 
 #include "GAAbilityBase.h"
 
-void FGAAbilityTick::ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent)
-{
-	if (Target && !Target->IsPendingKillOrUnreachable())
-	{
-		FScopeCycleCounterUObject ActorScope(Target);
-		Target->TickAbility(DeltaTime, TickType, *this);
-	}
-}
-
-FString FGAAbilityTick::DiagnosticMessage()
-{
-	return Target->GetFullName() + TEXT("[TickAction]");
-}
-
 UGAAbilityBase::UGAAbilityBase(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
 {
 	bReplicate = true;
 	bIsNameStable = false;
-
-	TickFunction.TickGroup = TG_PrePhysics;
-	// Default to no tick function, but if we set 'never ticks' to false (so there is a tick function) it is enabled by default
-	TickFunction.bCanEverTick = true;
-	TickFunction.bStartWithTickEnabled = true;
-	TickFunction.bAllowTickOnDedicatedServer = true;
-	TickFunction.bRunOnAnyThread = true;
-
-	TickFunction.SetTickFunctionEnable(true);
+	bAlwaysTick = false;
+	bParallelUpdate = false;
+	TickIndex = INDEX_NONE;
+	CooldownEndTime = 0;
+	ActivationEndTime = 0;
+	AbilityState = EAFAbilityState::Waiting;
+	Instancing = EAFAbilityInstancing::Instanced;
 }
 
 void UGAAbilityBase::PostInitProperties()
@@ -52,6 +40,17 @@ void UGAAbilityBase::PostInitProperties()
 	UpdateAssetRegistryInfo();
 	Super::PostInitProperties();
 }
+void UGAAbilityBase::BeginDestroy()
+{
+	if (TickIndex != INDEX_NONE)
+	{
+		if (UAFAbilityTickManager* TickManager = UAFAbilityTickManager::GetIfExists())
+		{
+			TickManager->RemoveAbility(this);
+		}
+	}
+	Super::BeginDestroy();
+}
 
 void UGAAbilityBase::Serialize(FArchive& Ar)
 {
@@ -79,10 +78,40 @@ void UGAAbilityBase::UpdateAssetRegistryInfo()
 {
 	AbilityTagSearch = AbilityTag.GetTagName();
 }
-void UGAAbilityBase::TickAbility(float DeltaSeconds, ELevelTick TickType, FGAAbilityTick& ThisTickFunction)
+void UGAAbilityBase::TickAbility(float DeltaSeconds, ELevelTick TickType)
 {
 
 }
+void UGAAbilityBase::MakeFrameSnapshot(FAFAbilityFrameSnapshot& OutSnapshot) const
+{
+	OutSnapshot.WorldTime = World ? World->GetTimeSeconds() : 0;
+	OutSnapshot.CooldownEndTime = CooldownState.IsValid() ? CooldownState->EndTime : 0;
+	OutSnapshot.bIsActivating = AbilityState == EAFAbilityState::Activating;
+	OutSnapshot.AttributeValues.Reset();
+	UGAAttributesBase* OwnerAttributes = AbilityComponent ? AbilityComponent->DefaultAttributes : nullptr;
+	for (const FGAAttribute& Attribute : SnapshotAttributes)
+	{
+		FAFAttributeBase* Attr = OwnerAttributes ? OwnerAttributes->GetAttribute(Attribute) : nullptr;
+		OutSnapshot.AttributeValues.Add(Attr ? Attr->GetFinalValue() : 0);
+	}
+}
+void UGAAbilityBase::UpdateTickRegistration()
+{
+	const bool bShouldTick = bAlwaysTick || AbilityState == EAFAbilityState::Activating;
+	if (bShouldTick == (TickIndex != INDEX_NONE))
+	{
+		return;
+	}
+	UWorld* TickingWorld = AbilityComponent ? AbilityComponent->GetWorld() : nullptr;
+	if (bShouldTick && TickingWorld)
+	{
+		UAFAbilityTickManager::Get()->AddAbility(this, TickingWorld);
+	}
+	else if (!bShouldTick)
+	{
+		UAFAbilityTickManager::Get()->RemoveAbility(this);
+	}
+}
 
 void UGAAbilityBase::InitAbility()
 {
@@ -91,7 +120,7 @@ void UGAAbilityBase::InitAbility()
 	CooldownEffect.InitializeIfNotInitialized();
 	AttributeCost.InitializeIfNotInitialized();
 	AbilityAttributeCost.InitializeIfNotInitialized();
-	DefaultContext = UGABlueprintLibrary::MakeContext(this, POwner, AvatarActor, this, FHitResult(ForceInit));
+	DefaultContext = FAFContextHandle::Generate(UGABlueprintLibrary::MakeContext(this, POwner, AvatarActor, this, FHitResult(ForceInit)));
 	if (AbilityComponent)
 	{
 		World = AbilityComponent->GetWorld();
@@ -115,9 +144,9 @@ void UGAAbilityBase::InitAbility()
 	{
 		OwnerCamera = POwner->FindComponentByClass<UCameraComponent>();
 	}
-	TickFunction.Target = this;
-	TickFunction.RegisterTickFunction(AbilityComponent->GetWorld()->GetCurrentLevel());
-	TickFunction.SetTickFunctionEnable(true);
+	InitializeCooldownState();
+	BindReplicatedEffectInfos();
+	UpdateTickRegistration();
 }
 
 void UGAAbilityBase::OnNativeInputPressed(FGameplayTag ActionName)
@@ -142,10 +171,16 @@ void UGAAbilityBase::StartActivation(bool bApplyActivationEffect)
 {
 	if (!CanUseAbility())
 	{
+		//notify only on actual attempt, not every time someone asks.
+		if (IsOnCooldown())
+		{
+			OnNotifyOnCooldown.Broadcast();
+		}
 		return;
 	}
 	//AbilityComponent->ExecutingAbility = this;
 	AbilityState = EAFAbilityState::Activating;
+	UpdateTickRegistration();
 	NativeOnBeginAbilityActivation(bApplyActivationEffect);
 }
 
@@ -165,18 +200,61 @@ void UGAAbilityBase::NativeOnBeginAbilityActivation(bool bApplyActivationEffect)
 	//OnAbilityExecuted();
 }
 
+void UGAAbilityBase::NativeOnCooldownEffectExpired(const FGAEffectHandle& InHandle)
+{
+	NativeOnCooldownEffectRemoved(InHandle);
+	OnCooldownEnd(InHandle);
+}
+void UGAAbilityBase::NativeOnCooldownEffectRemoved(const FGAEffectHandle& InHandle)
+{
+	//group might have been extended by other ability in the meantime.
+	if (CooldownState.IsValid() && CooldownState->EndTime <= CooldownEndTime)
+	{
+		CooldownState->EndTime = 0;
+	}
+	CooldownEndTime = 0;
+}
+void UGAAbilityBase::NativeOnActivationEffectRemoved(const FGAEffectHandle& InHandle)
+{
+	ActivationEndTime = 0;
+}
+void UGAAbilityBase::NativeOnCooldownInfoReplicated(const FAFEffectRepInfo& InInfo, bool bRemoved)
+{
+	if (!bRemoved)
+	{
+		SetCooldownEndTime(InInfo.GetEndTime());
+		return;
+	}
+	//don't reset newer cooldown, if old one is removed after it.
+	if (CooldownEndTime <= InInfo.GetEndTime())
+	{
+		NativeOnCooldownEffectRemoved(InInfo.Handle);
+	}
+}
+void UGAAbilityBase::NativeOnActivationInfoReplicated(const FAFEffectRepInfo& InInfo, bool bRemoved)
+{
+	if (!bRemoved)
+	{
+		ActivationEndTime = InInfo.GetEndTime();
+	}
+	else if (ActivationEndTime <= InInfo.GetEndTime())
+	{
+		ActivationEndTime = 0;
+	}
+}
 void UGAAbilityBase::OnCooldownEffectExpired()
 {
 	UE_LOG(AbilityFramework, Log, TEXT("Cooldown expired In Ability: %s"), *GetName());
 
 	if (CooldownEffectHandle.IsValid())
 	{
-		CooldownEffectHandle.GetContextRef().InstigatorComp->RemoveEffect(CooldownEffect, DefaultContext);
+		CooldownEffectHandle.GetContextRef().InstigatorComp->RemoveEffect(CooldownEffect, DefaultContext.GetRef());
 	}
 }
 /* Functions for activation effect delegates */
 void UGAAbilityBase::NativeOnAbilityActivationFinish(const FGAEffectHandle& InHandle)
 {
+	ActivationEndTime = 0;
 	UE_LOG(AbilityFramework, Log, TEXT("Ability Activation Effect Expired In Ability: %s"), *GetName());
 	OnActivationFinished();
 	OnActivationFinishedDelegate.Broadcast();
@@ -205,6 +283,7 @@ void UGAAbilityBase::FinishAbility()
 	OnAbilityFinished();
 	NativeFinishAbility();
 	AbilityState = EAFAbilityState::Waiting;
+	UpdateTickRegistration();
 	AbilityComponent->AppliedTags.RemoveTagContainer(ActivationAddedTags);
 }
 void UGAAbilityBase::NativeFinishAbility()
@@ -215,7 +294,7 @@ void UGAAbilityBase::NativeFinishAbility()
 	OnConfirmDelegate.RemoveAll(this);
 	//if (ActivationEffect.Handle.IsValid())
 	{
-		AbilityComponent->RemoveEffect(ActivationEffect, DefaultContext);
+		AbilityComponent->RemoveEffect(ActivationEffect, DefaultContext.GetRef());
 	}
 	//remove effect.
 }
@@ -226,11 +305,14 @@ void UGAAbilityBase::CancelActivation()
 }
 void UGAAbilityBase::NativeCancelActivation()
 {
-	UAFAbilityComponent* AttrComp = ActivationEffect.Handle.GetContext().InstigatorComp.Get();
 	if (AbilityComponent)
 	{
-		AbilityComponent->RemoveEffect(ActivationEffect, DefaultContext);
+		AbilityComponent->RemoveEffect(ActivationEffect, DefaultContext.GetRef());
+		AbilityComponent->AppliedTags.RemoveTagContainer(ActivationAddedTags);
 	}
+	//same as finish, cancelled ability must not keep ticking.
+	AbilityState = EAFAbilityState::Waiting;
+	UpdateTickRegistration();
 }
 
 bool UGAAbilityBase::IsWaitingForConfirm()
@@ -257,9 +339,13 @@ bool UGAAbilityBase::ApplyCooldownEffect()
 	FAFFunctionModifier Modifier;
 	CooldownEffectHandle = UGABlueprintLibrary::ApplyGameEffectToObject(CooldownEffect,
 		this, POwner, this, Modifier);
+	if (CooldownEffectHandle.IsValid())
+	{
+		SetCooldownEndTime(AbilityComponent->GameEffectContainer.GetAppliedEndTime(CooldownEffectHandle, CooldownEffect.Duration));
+		CooldownEffectHandle.GetEffectRef().OnEffectExpired.AddUObject(this, &UGAAbilityBase::NativeOnCooldownEffectExpired);
+		CooldownEffectHandle.GetEffectRef().OnEffectRemoved.AddUObject(this, &UGAAbilityBase::NativeOnCooldownEffectRemoved);
+	}
 	OnCooldownStart();
-
-	CooldownEffectHandle.GetEffectRef().OnEffectExpired.AddUObject(this, &UGAAbilityBase::OnCooldownEnd);
 	return false;
 }
 bool UGAAbilityBase::ApplyActivationEffect(bool bApplyActivationEffect)
@@ -269,8 +355,8 @@ bool UGAAbilityBase::ApplyActivationEffect(bool bApplyActivationEffect)
 	FHitResult Hit(ForceInit);
 	
 	UGAGameEffectSpec* Spec = ActivationEffect.GetClass().GetDefaultObject();
-	float DurationCheck = Spec->Duration.GetFloatValue(DefaultContext);
-	float PeriodCheck = Spec->Period.GetFloatValue(DefaultContext);
+	float DurationCheck = Spec->Duration.GetFloatValue(DefaultContext.GetRef());
+	float PeriodCheck = Spec->Period.GetFloatValue(DefaultContext.GetRef());
 	if (DurationCheck > 0 || PeriodCheck > 0)
 	{
 		bApplyActivationEffect = true;
@@ -285,9 +371,11 @@ bool UGAAbilityBase::ApplyActivationEffect(bool bApplyActivationEffect)
 		FAFFunctionModifier Modifier;
 		ActivationEffectHandle = UGABlueprintLibrary::ApplyGameEffectToObject(ActivationEffect,
 			this, POwner, this, Modifier);
+		ActivationEndTime = AbilityComponent->GameEffectContainer.GetAppliedEndTime(ActivationEffectHandle, ActivationEffect.Duration);
 		
 		//if(!ActivationEffectHandle.GetEffectRef().OnEffectExpired.)
 			ActivationEffectHandle.GetEffectRef().OnEffectExpired.AddUObject(this, &UGAAbilityBase::NativeOnAbilityActivationFinish);
+			ActivationEffectHandle.GetEffectRef().OnEffectRemoved.AddUObject(this, &UGAAbilityBase::NativeOnActivationEffectRemoved);
 
 		
 		if (PeriodCheck > 0)
@@ -303,7 +391,7 @@ bool UGAAbilityBase::ApplyActivationEffect(bool bApplyActivationEffect)
 	return false;
 }
 
-bool UGAAbilityBase::CanUseAbility()
+bool UGAAbilityBase::CanUseAbility() const
 {
 	bool CanUse = true;
 	bool bIsOnCooldown = IsOnCooldown();
@@ -331,6 +419,134 @@ bool UGAAbilityBase::CanReleaseAbility()
 	return bCanUse;
 }
 
+bool UGAAbilityBase::CanUseAbilityNonInstanced(const FAFAbilityInstanceState& InState,
+	UAFAbilityComponent* InComponent, float WorldTime) const
+{
+	if (InState.IsOnCooldown(WorldTime) || InState.IsActivating(WorldTime))
+	{
+		return false;
+	}
+	if (InComponent)
+	{
+		const FGameplayTagContainer& OwnerTags = InComponent->AppliedTags.AllTags;
+		if (ActivationRequiredTags.Num() > 0 && !OwnerTags.HasAll(ActivationRequiredTags))
+		{
+			return false;
+		}
+		if (ActivationBlockedTags.Num() > 0 && OwnerTags.HasAny(ActivationBlockedTags))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+void UGAAbilityBase::StartActivationNonInstanced(FAFAbilityInstanceState& InState, UAFAbilityComponent* InComponent)
+{
+	APawn* Owner = Cast<APawn>(InComponent->GetOwner());
+	UWorld* OwnerWorld = InComponent->GetWorld();
+	InState.State = EAFAbilityState::Activating;
+	InState.LastActivationTime = OwnerWorld ? OwnerWorld->GetTimeSeconds() : 0;
+	//effects are applied to owner. Apply writes duration, period and handle into property,
+	//so each activation uses it's own copy and CDO stays untouched.
+	FAFFunctionModifier Modifier;
+	if (CooldownEffect.IsValid())
+	{
+		FGAEffectProperty Cooldown;
+		MakeNonInstancedEffect(CooldownEffect, Cooldown);
+		InState.CooldownHandle = UGABlueprintLibrary::ApplyGameEffectToObject(Cooldown,
+			Owner, Owner, this, Modifier);
+		InState.CooldownEndTime = InComponent->GameEffectContainer.GetAppliedEndTime(InState.CooldownHandle, Cooldown.Duration);
+	}
+	InState.ActivationEndTime = 0;
+	if (ActivationEffect.IsValid())
+	{
+		FGAEffectProperty Activation;
+		MakeNonInstancedEffect(ActivationEffect, Activation);
+		InState.ActivationHandle = UGABlueprintLibrary::ApplyGameEffectToObject(Activation,
+			Owner, Owner, this, Modifier);
+		//instant effects are not kept in container, there is nothing to wait for.
+		InState.ActivationEndTime = InComponent->GameEffectContainer.GetAppliedEndTime(InState.ActivationHandle, Activation.Duration);
+	}
+	if (InState.ActivationEndTime > 0)
+	{
+		InComponent->AppliedTags.AddTagContainer(ActivationAddedTags);
+		InState.ActivationExpiredHandle = InState.ActivationHandle.GetEffectRef().OnEffectExpired.AddUObject(this,
+			&UGAAbilityBase::NativeOnNonInstancedActivationExpired, TWeakObjectPtr<UAFAbilityComponent>(InComponent));
+	}
+	else
+	{
+		//instant, nothing to wait for.
+		InState.State = EAFAbilityState::Waiting;
+	}
+	NativeOnActivateNonInstanced(InState, InComponent);
+}
+void UGAAbilityBase::FinishAbilityNonInstanced(FAFAbilityInstanceState& InState, UAFAbilityComponent* InComponent)
+{
+	UWorld* OwnerWorld = InComponent->GetWorld();
+	const float WorldTime = OwnerWorld ? OwnerWorld->GetTimeSeconds() : 0;
+	//if activation effect already expired, tags were removed by NativeOnNonInstancedActivationExpired.
+	if (InState.ActivationHandle.IsValid() && InState.ActivationExpiredHandle.IsValid())
+	{
+		InState.ActivationHandle.GetEffectRef().OnEffectExpired.Remove(InState.ActivationExpiredHandle);
+	}
+	InState.ActivationExpiredHandle.Reset();
+	if (InState.IsActivating(WorldTime))
+	{
+		InComponent->AppliedTags.RemoveTagContainer(ActivationAddedTags);
+		if (InState.ActivationHandle.IsValid())
+		{
+			//property only provides spec, effect is found by handle kept in owner state.
+			FGAEffectProperty Activation;
+			MakeNonInstancedEffect(ActivationEffect, Activation);
+			InComponent->GameEffectContainer.RemoveEffectByHandle(InState.ActivationHandle, Activation);
+		}
+	}
+	InState.ActivationHandle = FGAEffectHandle();
+	InState.ActivationEndTime = 0;
+	InState.State = EAFAbilityState::Waiting;
+}
+void UGAAbilityBase::MakeNonInstancedEffect(const FGAEffectProperty& InSource, FGAEffectProperty& OutProperty) const
+{
+	OutProperty.SpecClass = InSource.SpecClass;
+	OutProperty.Initialize();
+}
+void UGAAbilityBase::NativeOnActivateNonInstanced(FAFAbilityInstanceState& InState, UAFAbilityComponent* InComponent)
+{
+	OnActivateNonInstanced(Cast<APawn>(InComponent->GetOwner()), InComponent);
+}
+void UGAAbilityBase::NativeOnNonInstancedActivationExpired(const FGAEffectHandle& InHandle, TWeakObjectPtr<UAFAbilityComponent> InComponent)
+{
+	if (UAFAbilityComponent* Comp = InComponent.Get())
+	{
+		Comp->AppliedTags.RemoveTagContainer(ActivationAddedTags);
+	}
+}
+
+/* Limit per ability, so burst of tasks doesn't stay around forever. */
+static const int32 MaxFreeAbilityTasks = 16;
+
+UGAAbilityTask* UGAAbilityBase::PopFreeAbilityTask(UClass* InClass)
+{
+	for (int32 Idx = FreeAbilityTasks.Num() - 1; Idx >= 0; Idx--)
+	{
+		UGAAbilityTask* Task = FreeAbilityTasks[Idx];
+		if (Task && Task->GetClass() == InClass)
+		{
+			FreeAbilityTasks.RemoveAtSwap(Idx, 1, false);
+			return Task;
+		}
+	}
+	return nullptr;
+}
+void UGAAbilityBase::PushFreeAbilityTask(UGAAbilityTask* InTask)
+{
+	FreeAbilityTasks.Add(InTask);
+}
+bool UGAAbilityBase::CanPoolAbilityTask() const
+{
+	return FreeAbilityTasks.Num() < MaxFreeAbilityTasks;
+}
+
 void UGAAbilityBase::OnGameplayTaskInitialized(UGameplayTask& Task)
 {
 	if (UGAAbilityTask* task = Cast<UGAAbilityTask>(&Task))
@@ -433,7 +649,7 @@ bool UGAAbilityBase::BP_CheckAbilityAttributeCost()
 }
 bool UGAAbilityBase::CheckAbilityAttributeCost()
 {
-	float ModValue = AbilityAttributeCost.GetSpec()->AtributeModifier.Magnitude.GetFloatValue(DefaultContext);
+	float ModValue = AbilityAttributeCost.GetSpec()->AtributeModifier.Magnitude.GetFloatValue(DefaultContext.GetRef());
 	FGAAttribute Attribute = AbilityAttributeCost.GetSpec()->AtributeModifier.Attribute;
 	float AttributeVal = Attributes->GetFloatValue(Attribute);
 	if (ModValue > AttributeVal)
@@ -441,21 +657,75 @@ bool UGAAbilityBase::CheckAbilityAttributeCost()
 
 	return true;
 }
-bool UGAAbilityBase::IsOnCooldown()
+bool UGAAbilityBase::IsOnCooldown() const
 {
-	bool bOnCooldown = false;
-	bOnCooldown = AbilityComponent->IsEffectActive(CooldownEffectHandle);
-	if (bOnCooldown)
+	if (!CooldownState.IsValid() || !World)
 	{
-		OnNotifyOnCooldown.Broadcast();
+		return false;
 	}
-	return bOnCooldown; //temp
+	return CooldownState->EndTime > World->GetTimeSeconds();
 }
-bool UGAAbilityBase::IsActivating()
+bool UGAAbilityBase::IsActivating() const
 {
-	bool bAbilityActivating = false;
-	bAbilityActivating = AbilityComponent->IsEffectActive(ActivationEffect.Handle) || AbilityState == EAFAbilityState::Activating;
-	return bAbilityActivating; //temp
+	if (AbilityState == EAFAbilityState::Activating)
+	{
+		return true;
+	}
+	return World && ActivationEndTime > World->GetTimeSeconds();
+}
+
+void UGAAbilityBase::InitializeCooldownState()
+{
+	if (!CooldownGroup.IsValid() || !AbilityComponent)
+	{
+		if (!CooldownState.IsValid())
+		{
+			CooldownState = MakeShareable(new FAFCooldownGroupState());
+		}
+		return;
+	}
+	//groups live in owner effect container, so they go away with component and never cross worlds.
+	TWeakPtr<FAFCooldownGroupState>& Group = AbilityComponent->GameEffectContainer.CooldownGroups.FindOrAdd(CooldownGroup);
+	TSharedPtr<FAFCooldownGroupState> Shared = Group.Pin();
+	if (!Shared.IsValid())
+	{
+		Shared = MakeShareable(new FAFCooldownGroupState());
+		Group = Shared;
+	}
+	if (CooldownState.IsValid() && CooldownState != Shared)
+	{
+		Shared->EndTime = FMath::Max(Shared->EndTime, CooldownState->EndTime);
+	}
+	CooldownState = Shared;
+}
+void UGAAbilityBase::SetCooldownEndTime(float InEndTime)
+{
+	CooldownEndTime = InEndTime;
+	if (!CooldownState.IsValid())
+	{
+		InitializeCooldownState();
+	}
+	CooldownState->EndTime = FMath::Max(CooldownState->EndTime, CooldownEndTime);
+}
+void UGAAbilityBase::BindReplicatedEffectInfos()
+{
+	if (!AbilityComponent)
+	{
+		return;
+	}
+	TMap<UClass*, FAFEffectRepInfoDelegate>& Listeners = AbilityComponent->GameEffectContainer.RepInfoListeners;
+	if (UClass* CooldownClass = CooldownEffect.GetClass())
+	{
+		FAFEffectRepInfoDelegate& Delegate = Listeners.FindOrAdd(CooldownClass);
+		Delegate.RemoveAll(this);
+		Delegate.AddUObject(this, &UGAAbilityBase::NativeOnCooldownInfoReplicated);
+	}
+	if (UClass* ActivationClass = ActivationEffect.GetClass())
+	{
+		FAFEffectRepInfoDelegate& Delegate = Listeners.FindOrAdd(ActivationClass);
+		Delegate.RemoveAll(this);
+		Delegate.AddUObject(this, &UGAAbilityBase::NativeOnActivationInfoReplicated);
+	}
 }
 void UGAAbilityBase::BP_ApplyCooldown()
 {
@@ -475,7 +745,7 @@ float UGAAbilityBase::CalculateAnimationSpeed(UAnimMontage* MontageIn)
 {
 	float ActivationTime = MontageIn->GetPlayLength();
 	UGAGameEffectSpec* Spec = ActivationEffect.GetClass().GetDefaultObject();
-	float DurationCheck = Spec->Duration.GetFloatValue(DefaultContext);
+	float DurationCheck = Spec->Duration.GetFloatValue(DefaultContext.GetRef());
 	if (DurationCheck > 0)
 	{
 		ActivationTime = DurationCheck;
@@ -533,6 +803,7 @@ void UGAAbilityBase::ExecuteAbilityInputReleasedFromTag(FGameplayTag AbilityTagI
 /* Tracing Helpers Start */
 bool UGAAbilityBase::LineTraceSingleByChannel(const FVector Start, const FVector End, ETraceTypeQuery TraceChannel, bool bTraceComplex, FHitResult& OutHit)
 {
+	SCOPE_CYCLE_COUNTER(STAT_AbilityTraces);
 	ECollisionChannel CollisionChannel = UEngineTypes::ConvertToCollisionChannel(TraceChannel);
 	static const FName LineTraceSingleName(TEXT("AbilityLineTraceSingle"));
 	FCollisionQueryParams Params(LineTraceSingleName, bTraceComplex);
@@ -543,17 +814,10 @@ bool UGAAbilityBase::LineTraceSingleByChannel(const FVector Start, const FVector
 bool UGAAbilityBase::LineTraceSingleByChannelFromCamera(float Range, ETraceTypeQuery TraceChannel, bool bTraceComplex, FHitResult& OutHit,
 	EDrawDebugTrace::Type DrawDebugType, bool bIgnoreSelf, FLinearColor TraceColor, FLinearColor TraceHitColor, float DrawTime)
 {
-	FVector Start = FVector::ZeroVector;
-	if (OwnerCamera)
-	{
-		Start = OwnerCamera->GetComponentLocation();
-	}
-	else
-	{
-		FRotator UnusedRot;
-		POwner->GetActorEyesViewPoint(Start, UnusedRot);
-	}
-	FVector End = (POwner->GetBaseAimRotation().Vector() * Range) + Start;
+	SCOPE_CYCLE_COUNTER(STAT_AbilityTraces);
+	FVector Start;
+	FVector End;
+	GetCameraTracePoints(Range, Start, End);
 	ECollisionChannel CollisionChannel = UEngineTypes::ConvertToCollisionChannel(TraceChannel);
 	static const FName LineTraceSingleName(TEXT("AbilityLineTraceSingle"));
 	FCollisionQueryParams Params(LineTraceSingleName, bTraceComplex);
@@ -581,6 +845,50 @@ bool UGAAbilityBase::LineTraceSingleByChannelFromCamera(float Range, ETraceTypeQ
 #endif
 	return bHit;
 }
+void UGAAbilityBase::AsyncLineTraceSingleByChannelFromCamera(float Range, ETraceTypeQuery TraceChannel, bool bTraceComplex,
+	bool bIgnoreSelf, FAFAbilityTraceDelegate OnTraceDone)
+{
+	FVector Start;
+	FVector End;
+	GetCameraTracePoints(Range, Start, End);
+	static const FName AsyncLineTraceSingleName(TEXT("AbilityAsyncLineTraceSingle"));
+	FCollisionQueryParams Params(AsyncLineTraceSingleName, bTraceComplex);
+	if (bIgnoreSelf)
+	{
+		Params.AddIgnoredActor(POwner);
+	}
+	//delegate is copied into trace datum, result comes back in the next frame.
+	FTraceDelegate TraceDelegate;
+	TraceDelegate.BindUObject(this, &UGAAbilityBase::OnAsyncCameraTraceDone, OnTraceDone);
+	World->AsyncLineTraceByChannel(EAsyncTraceType::Single, Start, End,
+		UEngineTypes::ConvertToCollisionChannel(TraceChannel), Params, FCollisionResponseParams::DefaultResponseParam, &TraceDelegate);
+	INC_DWORD_STAT(STAT_AsyncAbilityTraces);
+}
+void UGAAbilityBase::OnAsyncCameraTraceDone(const FTraceHandle& InHandle, FTraceDatum& InData, FAFAbilityTraceDelegate OnTraceDone)
+{
+	FHitResult Hit(ForceInit);
+	bool bHit = false;
+	if (InData.OutHits.Num() > 0)
+	{
+		Hit = InData.OutHits[0];
+		bHit = Hit.bBlockingHit;
+	}
+	OnTraceDone.ExecuteIfBound(bHit, Hit);
+}
+void UGAAbilityBase::GetCameraTracePoints(float Range, FVector& OutStart, FVector& OutEnd) const
+{
+	OutStart = FVector::ZeroVector;
+	if (OwnerCamera)
+	{
+		OutStart = OwnerCamera->GetComponentLocation();
+	}
+	else
+	{
+		FRotator UnusedRot;
+		POwner->GetActorEyesViewPoint(OutStart, UnusedRot);
+	}
+	OutEnd = (POwner->GetBaseAimRotation().Vector() * Range) + OutStart;
+}
 bool UGAAbilityBase::LineTraceSingleByChannelFromSocket(FName SocketName, float Range, ETraceTypeQuery TraceChannel, bool bTraceComplex, FHitResult& OutHit,
 	EDrawDebugTrace::Type DrawDebugType, bool bIgnoreSelf, FLinearColor TraceColor, FLinearColor TraceHitColor, float DrawTime)
 {
@@ -52,32 +52,7 @@
 DECLARE_MULTICAST_DELEGATE(FGASSimpleAbilityDynamicDelegate);
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE(FGASGenericAbilityDelegate);
-USTRUCT()
-struct FGAAbilityTick : public FTickFunction
-{
-	GENERATED_USTRUCT_BODY()
-	/**  AActor  that is the target of this tick **/
-	class UGAAbilityBase* Target;
-
-	/**
-	* Abstract function actually execute the tick.
-	* @param DeltaTime - frame time to advance, in seconds
-	* @param TickType - kind of tick for this frame
-	* @param CurrentThread - thread we are executing on, useful to pass along as new tasks are created
-	* @param MyCompletionGraphEvent - completion event for this task. Useful for holding the completetion of this task until certain child tasks are complete.
-	**/
-	virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent) override;
-	/** Abstract function to describe this tick. Used to print messages about illegal cycles in the dependency graph **/
-	virtual FString DiagnosticMessage() override;
-};
-template<>
-struct TStructOpsTypeTraits<FGAAbilityTick> : public TStructOpsTypeTraitsBase2<FGAAbilityTick>
-{
-	enum
-	{
-		WithCopy = false
-	};
-};
+DECLARE_DYNAMIC_DELEGATE_TwoParams(FAFAbilityTraceDelegate, bool, bHit, const FHitResult&, Hit);
 USTRUCT()
 struct FGAActiationInfo
 {
@@ -107,18 +82,62 @@ struct FGAActiationInfo
 		int8 ForceReplication;
 };
 
+/*
+	Cooldown end time shared by all abilities of the same owner which have the same CooldownGroup.
+	Abilities without group have their own.
+*/
+struct FAFCooldownGroupState
+{
+	float EndTime;
+
+	FAFCooldownGroupState()
+		: EndTime(0)
+	{}
+};
+
 enum EAFAbilityState
 {
 	Waiting,
 	Activating
 };
 
+UENUM()
+enum class EAFAbilityInstancing : uint8
+{
+	/* Ability object is created for each owner. */
+	Instanced,
+	/* Logic runs on class default object, per owner state is in FAFNonInstancedAbilityContainer. */
+	NonInstanced
+};
+
 UCLASS(BlueprintType, Blueprintable)
 class ABILITYFRAMEWORK_API UGAAbilityBase : public UObject, public IGameplayTaskOwnerInterface, public IAFAbilityInterface
 {
 	GENERATED_BODY()
 public:
-	FGAAbilityTick TickFunction;
+	/*
+		If true ability is ticked every frame. Otherwise it's ticked only while activating.
+	*/
+	UPROPERTY(EditAnywhere, Category = "Tick")
+		bool bAlwaysTick;
+	/*
+		If true, instead of TickAbility ability is updated by NativeParallelUpdate, on worker threads.
+	*/
+	UPROPERTY(EditAnywhere, Category = "Tick")
+		bool bParallelUpdate;
+	/* Owner attributes copied to frame snapshot for parallel update. */
+	UPROPERTY(EditAnywhere, Category = "Tick")
+		TArray<FGAAttribute> SnapshotAttributes;
+	/*
+		NonInstanced abilities are not created per owner, which is much cheaper for crowd AI.
+		They can't have tasks, per owner attributes or ability variables, only
+		the *NonInstanced functions are called.
+	*/
+	UPROPERTY(EditAnywhere, Category = "Instancing")
+		EAFAbilityInstancing Instancing;
+	/* Index in UAFAbilityTickManager list, INDEX_NONE when not ticking. Managed by tick manager. */
+	int32 TickIndex;
+	FObjectKey TickWorld;
 
 	/* By default all abilities are considered to be replicated. */
 	UPROPERTY(EditAnywhere, Category = "Replication")
@@ -132,6 +151,9 @@ public:
 	/* List of tasks, this ability have. */
 	UPROPERTY()
 		TMap<FName, class UGAAbilityTask*> AbilityTasks;
+	/* Ended unnamed tasks, ready to be reused by UGAAbilityTask::NewAbilityTask. */
+	UPROPERTY()
+		TArray<class UGAAbilityTask*> FreeAbilityTasks;
 
 	/*
 		Delegate is used to confirm ability execution.
@@ -179,7 +201,8 @@ public:
 	UPROPERTY(BlueprintReadOnly, Category = "AbilityFramework|Abilities")
 		UCameraComponent* OwnerCamera;
 
-	FGAEffectContext DefaultContext;
+	/* Context used by this ability own effects (cooldown, activation, cost). */
+	FAFContextHandle DefaultContext;
 
 	/*
 		Tags applied to instigator of this ability, for duration of cooldown.
@@ -188,6 +211,15 @@ public:
 	UPROPERTY(EditAnywhere, meta=(AllowedClass="AFAbilityCooldownSpec"), Category = "Config")
 		FGAEffectProperty CooldownEffect;
 	FGAEffectHandle CooldownEffectHandle;
+	/*
+		Abilities of the same owner with the same group share cooldown. When one of them
+		applies cooldown, all of them are on cooldown until it ends.
+	*/
+	UPROPERTY(EditAnywhere, Category = "Config")
+		FGameplayTag CooldownGroup;
+	/* Cached when cooldown effect is applied, reset when it's removed. */
+	TSharedPtr<FAFCooldownGroupState> CooldownState;
+	float CooldownEndTime;
 	/*
 		Tags applied to the time of activation ability.
 		Only applies to abilities, which are not instant (for now).
@@ -202,6 +234,8 @@ public:
 	UPROPERTY(EditAnywhere, meta = (AllowedClass = "AFAbilityActivationSpec,AFAbilityPeriodSpec,AFAbilityInfiniteDurationSpec,AFAbilityPeriodicInfiniteSpec"), Category = "Config")
 		FGAEffectProperty ActivationEffect;
 	FGAEffectHandle ActivationEffectHandle;
+	/* Cached when activation effect is applied, reset when it expires or is removed. */
+	float ActivationEndTime;
 
 	/*
 		These attributes will be reduced by specified amount when ability is activated.
@@ -245,7 +279,18 @@ public: //because I'm to lazy to write all those friend states..
 		float LastActivationTime;
 	UPROPERTY()
 		float LastCooldownTime;
-	virtual void TickAbility(float DeltaSeconds, ELevelTick TickType, FGAAbilityTick& ThisTickFunction);
+	virtual void TickAbility(float DeltaSeconds, ELevelTick TickType);
+	/*
+		Called on worker thread when bParallelUpdate is true. Read only from InSnapshot,
+		don't call into any UObject. Push side effects to OutCommands, they will be executed
+		on game thread after all abilities are updated. See AFAbilityUpdateTypes.h.
+	*/
+	virtual void NativeParallelUpdate(float DeltaSeconds, const struct FAFAbilityFrameSnapshot& InSnapshot,
+		struct FAFAbilityCommandQueue& OutCommands) {}
+	/* Game thread. Fills snapshot for parallel update. */
+	virtual void MakeFrameSnapshot(struct FAFAbilityFrameSnapshot& OutSnapshot) const;
+	/* Adds or removes ability from world tick manager, based on bAlwaysTick and current state. */
+	void UpdateTickRegistration();
 	UFUNCTION()
 		void OnActivationEffectPeriod(const FGAEffectHandle& InHandle);
 
@@ -270,6 +315,7 @@ public:
 	UGAAbilityBase(const FObjectInitializer& ObjectInitializer);
 
 	virtual void PostInitProperties() override;
+	virtual void BeginDestroy() override;
 
 	virtual void Serialize(FArchive& Ar) override;
 
@@ -356,6 +402,12 @@ public:
 
 	UFUNCTION()
 		void OnCooldownEffectExpired();
+	void NativeOnCooldownEffectExpired(const FGAEffectHandle& InHandle);
+	void NativeOnCooldownEffectRemoved(const FGAEffectHandle& InHandle);
+	void NativeOnActivationEffectRemoved(const FGAEffectHandle& InHandle);
+	/* Client side, cooldown and activation effects replicated from server. */
+	void NativeOnCooldownInfoReplicated(const FAFEffectRepInfo& InInfo, bool bRemoved);
+	void NativeOnActivationInfoReplicated(const FAFEffectRepInfo& InInfo, bool bRemoved);
 	UFUNCTION()
 		void NativeOnAbilityActivationFinish(const FGAEffectHandle& InHandle);
 	UFUNCTION()
@@ -377,9 +429,27 @@ public:
 	bool IsWaitingForConfirm();
 	void ConfirmAbility();
 
-	bool CanUseAbility();
+	/* Only compares cached end times against world time. Safe to poll every frame. */
+	bool CanUseAbility() const;
 	bool CanReleaseAbility();
 
+	/*
+		Non-instanced mode. Called on class default object, so don't modify ability variables,
+		everything owner specific goes into InState.
+	*/
+	bool CanUseAbilityNonInstanced(const struct FAFAbilityInstanceState& InState,
+		class UAFAbilityComponent* InComponent, float WorldTime) const;
+	/* Applies cooldown and activation effects for InComponent owner. */
+	void StartActivationNonInstanced(struct FAFAbilityInstanceState& InState, class UAFAbilityComponent* InComponent);
+	void FinishAbilityNonInstanced(struct FAFAbilityInstanceState& InState, class UAFAbilityComponent* InComponent);
+	/* Fresh property with the same spec, for single activation of non-instanced ability. */
+	void MakeNonInstancedEffect(const FGAEffectProperty& InSource, FGAEffectProperty& OutProperty) const;
+	virtual void NativeOnActivateNonInstanced(struct FAFAbilityInstanceState& InState, class UAFAbilityComponent* InComponent);
+	/* Called on class default object. Don't use ability variables, they are shared by all owners. */
+	UFUNCTION(BlueprintImplementableEvent, Category = "AbilityFramework|Abilities")
+		void OnActivateNonInstanced(APawn* InOwner, class UAFAbilityComponent* InComponent);
+	void NativeOnNonInstancedActivationExpired(const FGAEffectHandle& InHandle, TWeakObjectPtr<class UAFAbilityComponent> InComponent);
+
 	/** GameplayTaskOwnerInterface - Begin */
 	virtual UGameplayTasksComponent* GetGameplayTasksComponent(const UGameplayTask& Task) const override;
 	/** this gets called both when task starts and when task gets resumed. Check Task.GetStatus() if you want to differenciate */
@@ -426,8 +496,13 @@ public: //protected ?
 	bool ApplyAttributeCost();
 	bool ApplyAbilityAttributeCost();
 	bool CheckAbilityAttributeCost();
-	bool IsOnCooldown();
-	bool IsActivating();
+	bool IsOnCooldown() const;
+	bool IsActivating() const;
+	/* Finds or creates cooldown state shared by owner abilities with the same CooldownGroup. */
+	void InitializeCooldownState();
+	void SetCooldownEndTime(float InEndTime);
+	/* Listen for cooldown and activation effects replicated to owner effect container. */
+	void BindReplicatedEffectInfos();
 
 	UFUNCTION(BlueprintCallable, meta = (DisplayName = "Apply Cooldown"), Category = "AbilityFramework|Abilities")
 		void BP_ApplyCooldown();
@@ -474,6 +549,10 @@ public: //protected ?
 	{
 		return AbilityTasks.FindRef(InName);
 	}
+	/* Returns ended task of exactly InClass, or nullptr. */
+	class UGAAbilityTask* PopFreeAbilityTask(UClass* InClass);
+	void PushFreeAbilityTask(class UGAAbilityTask* InTask);
+	bool CanPoolAbilityTask() const;
 
 	/* Tracing Helpers Start */
 	UFUNCTION(BlueprintCallable, Category = "AbilityFramework|Abilities|Tracing")
@@ -482,6 +561,15 @@ public: //protected ?
 	UFUNCTION(BlueprintCallable, Category = "AbilityFramework|Abilities|Tracing")
 		bool LineTraceSingleByChannelFromCamera(float Range, ETraceTypeQuery TraceChannel, bool bTraceComplex, FHitResult& OutHit,
 			EDrawDebugTrace::Type DrawDebugType, bool bIgnoreSelf, FLinearColor TraceColor, FLinearColor TraceHitColor, float DrawTime);
+	/*
+		Async version of LineTraceSingleByChannelFromCamera. Trace is batched with other async traces
+		of this frame and OnTraceDone is called with result in the next frame.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "AbilityFramework|Abilities|Tracing")
+		void AsyncLineTraceSingleByChannelFromCamera(float Range, ETraceTypeQuery TraceChannel, bool bTraceComplex,
+			bool bIgnoreSelf, FAFAbilityTraceDelegate OnTraceDone);
+	void OnAsyncCameraTraceDone(const FTraceHandle& InHandle, FTraceDatum& InData, FAFAbilityTraceDelegate OnTraceDone);
+	void GetCameraTracePoints(float Range, FVector& OutStart, FVector& OutEnd) const;
 	/* Traces from ability avatar socket. */
 	UFUNCTION(BlueprintCallable, Category = "AbilityFramework|Abilities|Tracing")
 		bool LineTraceSingleByChannelFromSocket(FName SocketName, float Range, ETraceTypeQuery TraceChannel, bool bTraceComplex, FHitResult& OutHit,
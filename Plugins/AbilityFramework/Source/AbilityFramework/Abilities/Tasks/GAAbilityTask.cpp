@@ -4,6 +4,9 @@
 #include "../GAAbilityBase.h"
 #include "GAAbilityTask.h"
 
+DEFINE_STAT(STAT_AbilityTasksAllocated);
+DEFINE_STAT(STAT_AbilityTasksReused);
+
 UGAAbilityTask::UGAAbilityTask(const FObjectInitializer& ObjectInitializer)
 : Super(ObjectInitializer)
 {
@@ -15,6 +18,8 @@ UGAAbilityTask::UGAAbilityTask(const FObjectInitializer& ObjectInitializer)
 	TaskState = EGameplayTaskState::Uninitialized;
 	ResourceOverlapPolicy = ETaskResourceOverlapPolicy::StartOnTop;
 	Priority = FGameplayTasks::DefaultPriority;
+	bPooled = false;
+	PoolSerial = 0;
 
 	SetFlags(RF_StrongRefOnFrame);
 }
@@ -34,4 +39,53 @@ void UGAAbilityTask::Initialize()
 void UGAAbilityTask::EndAbilityTask()
 {
 
-}
\ No newline at end of file
+}
+
+bool UGAAbilityTask::EndTaskIfSerial(uint32 InSerial)
+{
+	if (InSerial != PoolSerial)
+	{
+		return false;
+	}
+	EndTask();
+	return true;
+}
+
+void UGAAbilityTask::OnDestroy(bool bInOwnerFinished)
+{
+	UGAAbilityBase* OwningAbility = Ability.Get();
+	if (!bPooled || !OwningAbility || OwningAbility->IsPendingKill() || !OwningAbility->CanPoolAbilityTask())
+	{
+		Super::OnDestroy(bInOwnerFinished);
+		return;
+	}
+	//same as UGameplayTask::OnDestroy, without marking task pending kill.
+	TaskState = EGameplayTaskState::Finished;
+	if (TasksComponent.IsValid())
+	{
+		TasksComponent->OnGameplayTaskDeactivated(*this);
+	}
+	ResetTask();
+	//anyone still holding old serial can no longer end this task.
+	PoolSerial++;
+	OwningAbility->PushFreeAbilityTask(this);
+}
+
+void UGAAbilityTask::ResetTask()
+{
+	InstanceName = NAME_None;
+	//blueprint async nodes bind again every time task is created, delegates are reset with everything else.
+	UObject* CDO = GetClass()->GetDefaultObject();
+	for (TFieldIterator<UProperty> It(GetClass()); It; ++It)
+	{
+		UProperty* Property = *It;
+		UClass* OwnerClass = Property->GetOwnerClass();
+		//task and gameplay task state is managed by pool, instanced subobjects would be shared with CDO.
+		if (!OwnerClass || OwnerClass == UGAAbilityTask::StaticClass() || !OwnerClass->IsChildOf(UGAAbilityTask::StaticClass())
+			|| Property->HasAnyPropertyFlags(CPF_InstancedReference | CPF_ContainsInstancedReference))
+		{
+			continue;
+		}
+		Property->CopyCompleteValue_InContainer(this, CDO);
+	}
+}
@@ -2,12 +2,17 @@
 #include "GameplayTask.h"
 #include "../GAAbilityBase.h"
 #include "../../AFAbilityComponent.h"
+#include "../AFAbilityStats.h"
 
 //#include "Messaging.h"
 #include "MessageEndpoint.h"
 #include "MessageEndpointBuilder.h"
 
 #include "GAAbilityTask.generated.h"
+
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Ability Tasks Allocated"), STAT_AbilityTasksAllocated, STATGROUP_Abilities, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Ability Tasks Reused"), STAT_AbilityTasksReused, STATGROUP_Abilities, );
+
 /*
 	AbilityActions are generic (preferably C++) defined actions, which then can be added to ability and
 	the should be activated from ability. 
@@ -29,29 +34,60 @@ public:
 	TWeakObjectPtr<UGAAbilityBase> Ability;
 	/* Ability owning this task */
 	TWeakObjectPtr<UAFAbilityComponent> AbilityComponent;
+	/*
+		Unnamed tasks are returned to owning ability free list when they end, instead of
+		being destroyed, and handed out again by NewAbilityTask.
+	*/
+	bool bPooled;
+protected:
+	/* Incremented every time task goes back to pool. */
+	uint32 PoolSerial;
 public:
 	//virtual UWorld* GetWorld() const override;
 
 	//virtual void Tick(float DeltaSecondsIn);
 
 	virtual void Initialize();
+	/* Keep it with reference to pooled task, it changes when task is recycled. */
+	inline uint32 GetPoolSerial() const { return PoolSerial; }
+	/* Ends task only if it wasn't recycled since InSerial was taken. Use it instead of EndTask from stale holders. */
+	bool EndTaskIfSerial(uint32 InSerial);
 	template <class T>
 	static T* NewAbilityTask(UObject* WorldContextObject, FName InTaskName = FName(), FName InstanceName = FName())
 	{
 		check(WorldContextObject);
 
-		T* MyObj = NewObject<T>(WorldContextObject);
 		UGAAbilityBase* ThisAbility = CastChecked<UGAAbilityBase>(WorldContextObject);
-		if (UGAAbilityTask* CachedTask = ThisAbility->GetAbilityTask(InTaskName))
+		const bool bNamed = InTaskName != NAME_None;
+		if (bNamed)
+		{
+			if (UGAAbilityTask* CachedTask = ThisAbility->GetAbilityTask(InTaskName))
+			{
+				CachedTask->InitTask(*ThisAbility, ThisAbility->GetGameplayTaskDefaultPriority());
+				return Cast<T>(CachedTask);
+			}
+		}
+		T* MyObj = Cast<T>(ThisAbility->PopFreeAbilityTask(T::StaticClass()));
+		if (MyObj)
 		{
-			CachedTask->InitTask(*ThisAbility, ThisAbility->GetGameplayTaskDefaultPriority());
-			return Cast<T>(CachedTask);
+			//pooled task ended as Finished.
+			MyObj->TaskState = EGameplayTaskState::AwaitingActivation;
+			INC_DWORD_STAT(STAT_AbilityTasksReused);
+		}
+		else
+		{
+			MyObj = NewObject<T>(WorldContextObject);
+			INC_DWORD_STAT(STAT_AbilityTasksAllocated);
 		}
 		MyObj->Ability = ThisAbility;
 		MyObj->AbilityComponent = ThisAbility->AbilityComponent;
+		MyObj->bPooled = !bNamed;
 		MyObj->InitTask(*ThisAbility, ThisAbility->GetGameplayTaskDefaultPriority());
 		MyObj->InstanceName = InstanceName;
-		ThisAbility->AddAbilityTask(InTaskName, MyObj);
+		if (bNamed)
+		{
+			ThisAbility->AddAbilityTask(InTaskName, MyObj);
+		}
 		return MyObj;
 	}
 
@@ -69,4 +105,12 @@ public:
 	}
 protected:
 	void EndAbilityTask();
+	/* Pooled tasks are not destroyed, they are reset and returned to ability. */
+	virtual void OnDestroy(bool bInOwnerFinished) override;
+	/*
+		Called before task goes back to pool. Resets subclass (and blueprint) properties to defaults,
+		which also clears blueprint bindings. Override to reset native state and unbind from
+		delegates task bound to.
+	*/
+	virtual void ResetTask();
 };
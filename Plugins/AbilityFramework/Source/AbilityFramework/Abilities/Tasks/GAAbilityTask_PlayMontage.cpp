@@ -47,4 +47,28 @@ void UGAAbilityTask_PlayMontage::BroadcastEndNotifyState(const FAFAbilityNotifyD
 void UGAAbilityTask_PlayMontage::BroadcastTickNotifyState(const FAFAbilityNotifyData& DataIn, const FGameplayTag& InTag, const FName& InName)
 {
 	NotifyEnd.Broadcast(DataIn, InTag, InName);
-}
\ No newline at end of file
+}
+
+void UGAAbilityTask_PlayMontage::ResetTask()
+{
+	Super::ResetTask();
+	//don't receive notifies of montage played by next user of component.
+	if (UAFAbilityComponent* Component = AbilityComponent.Get())
+	{
+		if (Component->OnAbilityNotifyBegin.IsBoundToObject(this))
+		{
+			Component->OnAbilityNotifyBegin.Unbind();
+		}
+		if (Component->OnAbilityNotifyTick.IsBoundToObject(this))
+		{
+			Component->OnAbilityNotifyTick.Unbind();
+		}
+		if (Component->OnAbilityNotifyEnd.IsBoundToObject(this))
+		{
+			Component->OnAbilityNotifyEnd.Unbind();
+		}
+	}
+	SectionName = NAME_None;
+	PlayRate = 1;
+	bUseActivationTime = false;
+}
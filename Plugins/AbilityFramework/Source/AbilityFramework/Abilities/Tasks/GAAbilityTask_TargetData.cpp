@@ -4,6 +4,8 @@
 #include "../GAAbilityBase.h"
 #include "GAAbilityTask_TargetData.h"
 
+DEFINE_STAT(STAT_AbilityTraces);
+DEFINE_STAT(STAT_AsyncAbilityTraces);
 
 UGAAbilityTask_TargetData* UGAAbilityTask_TargetData::CreateTargetDataTask(UObject* WorldContextObject,
 	FName InTaskName,
@@ -11,7 +13,8 @@ UGAAbilityTask_TargetData* UGAAbilityTask_TargetData::CreateTargetDataTask(UObje
 	bool bDrawCorrectedDebug,
 	bool bUseCorrectedTrace,
 	EGASConfirmType ConfirmTypeIn,
-	float Range)
+	float Range,
+	bool bAsyncTrace)
 {
 	auto MyObj = NewAbilityTask<UGAAbilityTask_TargetData>(WorldContextObject);
 
@@ -23,6 +26,7 @@ UGAAbilityTask_TargetData* UGAAbilityTask_TargetData::CreateTargetDataTask(UObje
 		MyObj->bDrawDebug = bDrawDebug;
 		MyObj->bDrawCorrectedDebug = bDrawCorrectedDebug;
 		MyObj->bUseCorrectedTrace = bUseCorrectedTrace;
+		MyObj->bAsyncTrace = bAsyncTrace;
 	}
 	return MyObj;
 }
@@ -33,9 +37,7 @@ void UGAAbilityTask_TargetData::Activate()
 	{
 		case EGASConfirmType::Instant:
 		{
-			FHitResult Hit = LineTrace();
-			OnReceiveTargetData.Broadcast(Hit);
-			EndTask();
+			RequestTargetData();
 			break;
 		}
 		case EGASConfirmType::WaitForConfirm:
@@ -67,88 +69,156 @@ void UGAAbilityTask_TargetData::OnConfirm()
 }
 void UGAAbilityTask_TargetData::OnCastEndedConfirm()
 {
-	FHitResult Hit = LineTrace();
-	OnReceiveTargetData.Broadcast(Hit);
 	bIsTickable = false;
-	EndTask();
+	RequestTargetData();
 }
 void UGAAbilityTask_TargetData::Tick(float DeltaTime)
 {
 	//FHitResult HitOut = LineTrace();
 }
 
-FHitResult UGAAbilityTask_TargetData::LineTrace()
+void UGAAbilityTask_TargetData::RequestTargetData()
 {
+	if (!bAsyncTrace)
+	{
+		ReceiveTargetData(LineTrace());
+		return;
+	}
+	//already waiting for result.
+	if (TraceHandle.IsValid())
+	{
+		return;
+	}
+	FVector TraceStart;
+	FVector TraceEnd;
+	GetTracePoints(TraceStart, TraceEnd);
+	FCollisionQueryParams ColParams;
+	ColParams.AddIgnoredActor(Ability->POwner);
+	if (!TraceDelegate.IsBound())
+	{
+		TraceDelegate.BindUObject(this, &UGAAbilityTask_TargetData::OnAsyncTraceDone);
+	}
+	TraceHandle = GetWorld()->AsyncLineTraceByChannel(EAsyncTraceType::Single, TraceStart, TraceEnd,
+		ECollisionChannel::ECC_WorldStatic, ColParams, FCollisionResponseParams::DefaultResponseParam, &TraceDelegate);
+	INC_DWORD_STAT(STAT_AsyncAbilityTraces);
+}
+
+void UGAAbilityTask_TargetData::OnAsyncTraceDone(const FTraceHandle& InHandle, FTraceDatum& InData)
+{
+	if (InHandle != TraceHandle)
+	{
+		return;
+	}
+	TraceHandle = FTraceHandle();
+	//ability might have been removed, or task ended, while trace was in flight.
+	if (!Ability.IsValid() || TaskState != EGameplayTaskState::Active)
+	{
+		return;
+	}
 	FHitResult HitOut;
+	if (InData.OutHits.Num() > 0)
+	{
+		HitOut = InData.OutHits[0];
+	}
+	else
+	{
+		HitOut.TraceStart = InData.Start;
+		HitOut.TraceEnd = InData.End;
+	}
+	DrawTraceDebug(HitOut, InData.Start, InData.End);
+	ReceiveTargetData(HitOut);
+}
+
+void UGAAbilityTask_TargetData::ReceiveTargetData(const FHitResult& InHit)
+{
+	OnReceiveTargetData.Broadcast(InHit);
+	EndTask();
+}
+
+void UGAAbilityTask_TargetData::ResetTask()
+{
+	Super::ResetTask();
+	//result of trace issued before task ended must not reach next user.
+	TraceHandle = FTraceHandle();
+	bIsTickable = false;
+	bDrawDebug = false;
+	bDrawCorrectedDebug = false;
+	bUseCorrectedTrace = false;
+	bAsyncTrace = false;
+}
+
+void UGAAbilityTask_TargetData::GetTracePoints(FVector& OutStart, FVector& OutEnd) const
+{
 	APlayerController* PC = Ability->PCOwner;
 	APawn* P = Ability->POwner;
-	UCameraComponent* Camera = Ability->OwnerCamera;
-	FVector TraceStart;
 	FRotator UnusedRot;
 	if (PC)
 	{
-		PC->PlayerCameraManager->GetCameraViewPoint(TraceStart, UnusedRot);
-//		TraceStart = Camera->GetComponentLocation();
+		PC->PlayerCameraManager->GetCameraViewPoint(OutStart, UnusedRot);
 	}
 	else
 	{
 		UnusedRot = P->GetBaseAimRotation();
-		TraceStart = P->GetPawnViewLocation();
+		OutStart = P->GetPawnViewLocation();
 	}
+	OutEnd = UnusedRot.Vector() * Range + OutStart;
+}
 
-	FVector TraceEnd = UnusedRot.Vector() * Range + TraceStart;
-	UWorld* World = GetWorld();
+FHitResult UGAAbilityTask_TargetData::LineTrace()
+{
+	SCOPE_CYCLE_COUNTER(STAT_AbilityTraces);
+	FHitResult HitOut;
+	FVector TraceStart;
+	FVector TraceEnd;
+	GetTracePoints(TraceStart, TraceEnd);
 	FCollisionQueryParams ColParams;
-	ColParams.AddIgnoredActor(P);
+	ColParams.AddIgnoredActor(Ability->POwner);
 	FCollisionResponseParams ColResp;
-	World->LineTraceSingleByChannel(HitOut, TraceStart, TraceEnd, ECollisionChannel::ECC_WorldStatic, ColParams, ColResp);
-	if (HitOut.bBlockingHit)
+	GetWorld()->LineTraceSingleByChannel(HitOut, TraceStart, TraceEnd, ECollisionChannel::ECC_WorldStatic, ColParams, ColResp);
+	DrawTraceDebug(HitOut, TraceStart, TraceEnd);
+	return HitOut;
+}
+
+void UGAAbilityTask_TargetData::DrawTraceDebug(const FHitResult& InHit, const FVector& InStart, const FVector& InEnd)
+{
+	//corrected trace result is only drawn, don't pay for it otherwise.
+	if (bDrawCorrectedDebug)
 	{
+		APawn* P = Ability->POwner;
+		UWorld* World = GetWorld();
+		FCollisionQueryParams ColParams;
+		ColParams.AddIgnoredActor(P);
+		FCollisionResponseParams ColResp;
 		FHitResult NewHit;
 		FVector Start = P->GetPawnViewLocation();
-		FVector NewDir = (HitOut.Location - Start).GetSafeNormal();
-		float Distance = FVector::Dist(Start, HitOut.Location);
-		FVector End = Start + (NewDir * Range);
-		World->LineTraceSingleByChannel(NewHit, Start, End, ECollisionChannel::ECC_WorldStatic, ColParams, ColResp);
-	
-		if (bDrawCorrectedDebug)
+		FVector End;
+		if (InHit.bBlockingHit)
 		{
-			DrawDebugLine(GetWorld(), Start, End, FColor::Green, true, 2);// GetWorld()->DeltaTimeSeconds);
-			if (NewHit.bBlockingHit)
-			{
-				DrawDebugLine(GetWorld(), Start, NewHit.Location, FColor::Magenta, true, 2);//GetWorld()->DeltaTimeSeconds);
-				DrawDebugPoint(GetWorld(), NewHit.Location, 8, FColor::Magenta, true, 2);//GetWorld()->DeltaTimeSeconds);
-			}
+			FVector NewDir = (InHit.Location - Start).GetSafeNormal();
+			End = Start + (NewDir * Range);
+		}
+		else
+		{
+			FVector NewDir = (InEnd - Start).GetSafeNormal();
+			float Distance = Range - FVector::Dist(InStart, Start);
+			End = Start + (NewDir * Distance);
 		}
-	}
-	else
-	{
-		FHitResult NewHit;
-		FVector Start = P->GetPawnViewLocation();
-		FVector NewDir = (TraceEnd - Start).GetSafeNormal();
-		float Distance = Range - FVector::Dist(TraceStart, Start);
-		FVector End = Start + (NewDir * Distance);
-
 		World->LineTraceSingleByChannel(NewHit, Start, End, ECollisionChannel::ECC_WorldStatic, ColParams, ColResp);
 
-		if (bDrawCorrectedDebug)
+		DrawDebugLine(World, Start, End, FColor::Green, true, 2);// GetWorld()->DeltaTimeSeconds);
+		if (NewHit.bBlockingHit)
 		{
-			DrawDebugLine(GetWorld(), Start, End, FColor::Green, true, 2);//GetWorld()->DeltaTimeSeconds);
-			if (NewHit.bBlockingHit)
-			{
-				DrawDebugLine(GetWorld(), Start, NewHit.Location, FColor::Magenta, true, 2);//GetWorld()->DeltaTimeSeconds);
-				DrawDebugPoint(GetWorld(), NewHit.Location, 8, FColor::Magenta, true, 2);//GetWorld()->DeltaTimeSeconds);
-			}
+			DrawDebugLine(World, Start, NewHit.Location, FColor::Magenta, true, 2);//GetWorld()->DeltaTimeSeconds);
+			DrawDebugPoint(World, NewHit.Location, 8, FColor::Magenta, true, 2);//GetWorld()->DeltaTimeSeconds);
 		}
 	}
 	if (bDrawDebug)
 	{
-		if (HitOut.bBlockingHit)
+		if (InHit.bBlockingHit)
 		{
-			DrawDebugLine(GetWorld(), TraceStart, HitOut.ImpactPoint, FColor::Red, true, 2);//GetWorld()->DeltaTimeSeconds);
-			DrawDebugPoint(GetWorld(), HitOut.Location, 8, FColor::Red, true, 2);//GetWorld()->DeltaTimeSeconds);
+			DrawDebugLine(GetWorld(), InStart, InHit.ImpactPoint, FColor::Red, true, 2);//GetWorld()->DeltaTimeSeconds);
+			DrawDebugPoint(GetWorld(), InHit.Location, 8, FColor::Red, true, 2);//GetWorld()->DeltaTimeSeconds);
 		}
-		DrawDebugLine(GetWorld(), TraceStart, TraceEnd, FColor::Green, true, 2);//GetWorld()->DeltaTimeSeconds);
+		DrawDebugLine(GetWorld(), InStart, InEnd, FColor::Green, true, 2);//GetWorld()->DeltaTimeSeconds);
 	}
-	return HitOut;
 }
@@ -3,8 +3,12 @@
 #pragma once
 
 #include "GAAbilityTask.h"
+#include "../AFAbilityStats.h"
 #include "GAAbilityTask_TargetData.generated.h"
 
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Ability Traces"), STAT_AbilityTraces, STATGROUP_Abilities, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Async Ability Traces"), STAT_AsyncAbilityTraces, STATGROUP_Abilities, );
+
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FGASOnReceiveTargetData, const FHitResult&, HitResult);
 
 UENUM()
@@ -35,6 +39,13 @@ public:
 	bool bDrawDebug;
 	bool bDrawCorrectedDebug;
 	bool bUseCorrectedTrace;
+	/*
+		Trace is queued with world async traces (which are run together, for all abilities,
+		at the end of frame) and target data is broadcast next frame.
+	*/
+	bool bAsyncTrace;
+	FTraceHandle TraceHandle;
+	FTraceDelegate TraceDelegate;
 public:
 	UFUNCTION(BlueprintCallable, meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject", BlueprintInternalUseOnly = "true"), Category = "AbilityFramework|Abilities|Tasks")
 		static UGAAbilityTask_TargetData* CreateTargetDataTask(UObject* WorldContextObject, 
@@ -43,7 +54,8 @@ public:
 			bool bDrawCorrectedDebug,
 			bool bUseCorrectedTrace,
 			EGASConfirmType ConfirmTypeIn,
-			float Range);
+			float Range,
+			bool bAsyncTrace = false);
 
 	virtual void Activate() override;
 
@@ -61,4 +73,12 @@ public:
 
 protected:
 	FHitResult LineTrace();
+	/* Start from camera (or pawn view for AI) and end at Range in aim direction. */
+	void GetTracePoints(FVector& OutStart, FVector& OutEnd) const;
+	void DrawTraceDebug(const FHitResult& InHit, const FVector& InStart, const FVector& InEnd);
+	/* Traces now or queues async trace, target data is received either way. */
+	void RequestTargetData();
+	void OnAsyncTraceDone(const FTraceHandle& InHandle, FTraceDatum& InData);
+	void ReceiveTargetData(const FHitResult& InHit);
+	virtual void ResetTask() override;
 };
@@ -30,4 +30,13 @@ void UGAAbilityTask_WaitForConfirm::OnConfirm()
 	Ability->OnConfirmDelegate.Clear();
 	OnConfirmed.Broadcast();
 	EndAbilityTask();
-}
\ No newline at end of file
+}
+
+void UGAAbilityTask_WaitForConfirm::ResetTask()
+{
+	Super::ResetTask();
+	if (UGAAbilityBase* OwningAbility = Ability.Get())
+	{
+		OwningAbility->OnConfirmDelegate.RemoveAll(this);
+	}
+}
@@ -27,4 +27,6 @@ public:
 
 	UFUNCTION()
 		void OnConfirm();
+protected:
+	virtual void ResetTask() override;
 };
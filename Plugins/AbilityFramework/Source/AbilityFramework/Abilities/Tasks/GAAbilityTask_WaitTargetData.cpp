@@ -90,4 +90,14 @@ void UGAAbilityTask_WaitTargetData::OnConfirm()
 	Ability->OnConfirmDelegate.Clear();
 	OnConfirmed.Broadcast();
 	EndTask();
-}
\ No newline at end of file
+}
+
+void UGAAbilityTask_WaitTargetData::ResetTask()
+{
+	Super::ResetTask();
+	if (UGAAbilityBase* OwningAbility = Ability.Get())
+	{
+		OwningAbility->OnConfirmDelegate.RemoveAll(this);
+	}
+	TraceChannel = GetDefault<UGAAbilityTask_WaitTargetData>()->TraceChannel;
+}
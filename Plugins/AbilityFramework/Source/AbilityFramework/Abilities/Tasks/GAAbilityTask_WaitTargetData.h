@@ -41,6 +41,8 @@ public:
 
 	UFUNCTION()
 		void OnConfirm();
+protected:
+	virtual void ResetTask() override;
 
 public:
 	UGAAbilityTask_WaitTargetData(const FObjectInitializer& ObjectInitializer);
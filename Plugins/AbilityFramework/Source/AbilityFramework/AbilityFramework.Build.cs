@@ -65,6 +65,8 @@ namespace UnrealBuildTool.Rules
 					// ... add any modules that your module loads dynamically here ...
 				}
 				);
+            //cues are cosmetic, dedicated server compiles out cue handling and never loads cue set.
+            Definitions.Add(Target.Type == TargetRules.TargetType.Server ? "WITH_AF_CUES=0" : "WITH_AF_CUES=1");
             if (Target.Type == TargetRules.TargetType.Editor)
             {
                 PublicDependencyModuleNames.AddRange(new string[] { "UnrealEd", "PropertyEditor" });
@@ -2,10 +2,15 @@
 #pragma once
 #include "AbilityFramework.h"
 #include "IAbilityFramework.h"
+#include "GAGlobalTypes.h"
+#include "AFCueManager.h"
+#include "Effects/AFEffectEventTable.h"
+#include "Effects/GAGameEffect.h"
 DEFINE_LOG_CATEGORY(AbilityFramework);
 DEFINE_LOG_CATEGORY(GameAttributesGeneral);
 DEFINE_LOG_CATEGORY(GameAttributes);
 DEFINE_LOG_CATEGORY(GameAttributesEffects);
+DEFINE_LOG_CATEGORY(AFCues);
 class FAbilityFramework : public IAbilityFramework
 {
 	/** IModuleInterface implementation */
@@ -20,6 +25,14 @@ IMPLEMENT_MODULE( FAbilityFramework, AbilityFramework)
 void FAbilityFramework::StartupModule()
 {
 	// This code will execute after your module is loaded into memory (but after global variables are initialized, of course.)
+	FWorldDelegates::OnPostWorldInitialization.AddStatic(&UAFCueManager::HandlePostWorldInitialization);
+	FWorldDelegates::OnWorldCleanup.AddStatic(&UAFCueManager::HandleWorldCleanup);
+	FWorldDelegates::OnWorldCleanup.AddStatic(&FAFEffectEventTable::HandleWorldCleanup);
+#if WITH_EDITOR
+	//baked curve tables go stale when source curve table is reimported.
+	FCoreUObjectDelegates::OnObjectPropertyChanged.AddStatic(&UGAGameEffectSpec::HandleObjectPropertyChanged);
+#endif //WITH_EDITOR
+	FCoreDelegates::OnPostEngineInit.AddStatic(&UAFCueManager::HandlePostEngineInit);
 }
 
 
@@ -27,6 +40,7 @@ void FAbilityFramework::ShutdownModule()
 {
 	// This function may be called during shutdown to clean up your module.  For modules that support dynamic reloading,
 	// we call this function before unloading the module.
+	FAFContextHandle::EmptyPool();
 }
 
 
@@ -18,4 +18,10 @@ DECLARE_LOG_CATEGORY_EXTERN(GameAttributesGeneral, Log, All);
 
 DECLARE_LOG_CATEGORY_EXTERN(GameAttributes, Log, All);
 
-DECLARE_LOG_CATEGORY_EXTERN(GameAttributesEffects, Log, All);
\ No newline at end of file
+DECLARE_LOG_CATEGORY_EXTERN(GameAttributesEffects, Log, All);
+
+/* Per cue event logging. Verbose is compiled out unless AF_CUES_LOG_VERBOSITY is set to Verbose or higher. */
+#ifndef AF_CUES_LOG_VERBOSITY
+#define AF_CUES_LOG_VERBOSITY Log
+#endif
+DECLARE_LOG_CATEGORY_EXTERN(AFCues, Log, AF_CUES_LOG_VERBOSITY);
\ No newline at end of file
@@ -0,0 +1,348 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "../AbilityFramework.h"
+#include "GameplayTagsManager.h"
+#include "../AFAbilityComponent.h"
+#include "AFEffectEventTable.h"
+
+DEFINE_STAT(STAT_BroadcastEffectEvent);
+DEFINE_STAT(STAT_EffectEventListeners);
+
+TMap<FObjectKey, TUniquePtr<FAFEffectEventTable>> FAFEffectEventTable::Tables;
+TMap<FName, int32> FAFEffectEventTable::AttributeIndices;
+
+FAFEffectEventTable::FAFEffectEventTable(UObject* InOwner)
+	: OwnerKey(InOwner),
+	Component(Cast<UAFAbilityComponent>(InOwner)),
+	NumListeners(0),
+	BroadcastDepth(0),
+	bNeedsCompact(false)
+{}
+FAFEffectEventTable::~FAFEffectEventTable()
+{
+	DEC_DWORD_STAT_BY(STAT_EffectEventListeners, NumListeners);
+	UAFAbilityComponent* ASC = Component.Get();
+	if (!ASC)
+	{
+		return;
+	}
+	for (const TPair<FGameplayTag, FDelegateHandle>& Pair : ComponentEventHandles)
+	{
+		ASC->EffectEvents.FindOrAdd(Pair.Key).Remove(Pair.Value);
+	}
+	for (const TPair<FGAAttribute, FDelegateHandle>& Pair : ComponentAttributeHandles)
+	{
+		ASC->AttributeChanged.FindOrAdd(Pair.Key).Remove(Pair.Value);
+	}
+}
+
+FAFEffectEventTable& FAFEffectEventTable::FindOrAdd(UObject* InOwner)
+{
+	const FObjectKey Key(InOwner);
+	if (TUniquePtr<FAFEffectEventTable>* Table = Tables.Find(Key))
+	{
+		return **Table;
+	}
+	return *Tables.Add(Key, MakeUnique<FAFEffectEventTable>(InOwner));
+}
+FAFEffectEventTable* FAFEffectEventTable::Find(UObject* InOwner)
+{
+	TUniquePtr<FAFEffectEventTable>* Table = Tables.Find(FObjectKey(InOwner));
+	return Table ? Table->Get() : nullptr;
+}
+void FAFEffectEventTable::Remove(UObject* InOwner)
+{
+	Release(FObjectKey(InOwner));
+}
+void FAFEffectEventTable::HandleWorldCleanup(UWorld* InWorld, bool bSessionEnded, bool bCleanupResources)
+{
+	TArray<FObjectKey> Released;
+	for (const TPair<FObjectKey, TUniquePtr<FAFEffectEventTable>>& Pair : Tables)
+	{
+		//owner can be already gone if it never removed it's listeners.
+		UObject* Owner = Pair.Key.ResolveObjectPtr();
+		if (!Owner || Owner->GetWorld() == InWorld)
+		{
+			Released.Add(Pair.Key);
+		}
+	}
+	for (const FObjectKey& Key : Released)
+	{
+		Release(Key);
+	}
+}
+void FAFEffectEventTable::Release(const FObjectKey& InOwnerKey)
+{
+	TUniquePtr<FAFEffectEventTable>* TablePtr = Tables.Find(InOwnerKey);
+	if (!TablePtr)
+	{
+		return;
+	}
+	FAFEffectEventTable& Table = **TablePtr;
+	if (Table.BroadcastDepth == 0)
+	{
+		Tables.Remove(InOwnerKey);
+		return;
+	}
+	//can't delete table under it's own broadcast, drop listeners and let EndBroadcast release it.
+	for (FEventListeners& Listeners : Table.EventListeners)
+	{
+		for (TListener<FAFEffectEventListener>& Listener : Listeners)
+		{
+			Listener.bRemoved = true;
+		}
+	}
+	for (FAttributeListeners& Listeners : Table.AttributeListeners)
+	{
+		for (TListener<FAFAttributeChangedListener>& Listener : Listeners)
+		{
+			Listener.bRemoved = true;
+		}
+	}
+	DEC_DWORD_STAT_BY(STAT_EffectEventListeners, Table.NumListeners);
+	Table.NumListeners = 0;
+	Table.bNeedsCompact = true;
+}
+
+void FAFEffectEventTable::GetTagIndices(const FGameplayTag& InTag, TArray<int32, TInlineAllocator<8>>& OutIndices,
+	TArray<FGameplayTag, TInlineAllocator<8>>* OutTags)
+{
+	UGameplayTagsManager& TagsManager = UGameplayTagsManager::Get();
+	FGameplayTagNetIndex NetIndex = TagsManager.GetNetIndexFromTag(InTag);
+	if (NetIndex != INVALID_TAGNETINDEX)
+	{
+		OutIndices.Add(NetIndex);
+		if (OutTags)
+		{
+			OutTags->Add(InTag);
+		}
+	}
+	FGameplayTagContainer Children = TagsManager.RequestGameplayTagChildren(InTag);
+	for (const FGameplayTag& Child : Children)
+	{
+		NetIndex = TagsManager.GetNetIndexFromTag(Child);
+		if (NetIndex != INVALID_TAGNETINDEX)
+		{
+			OutIndices.Add(NetIndex);
+			if (OutTags)
+			{
+				OutTags->Add(Child);
+			}
+		}
+	}
+}
+int32 FAFEffectEventTable::GetAttributeIndex(const FGAAttribute& InAttribute, bool bAdd)
+{
+	if (const int32* Index = AttributeIndices.Find(InAttribute.AttributeName))
+	{
+		return *Index;
+	}
+	if (!bAdd)
+	{
+		return INDEX_NONE;
+	}
+	return AttributeIndices.Add(InAttribute.AttributeName, AttributeIndices.Num());
+}
+
+FDelegateHandle FAFEffectEventTable::AddEventListener(const FGameplayTag& InTag, const FAFEffectEventListener& InListener)
+{
+	TArray<int32, TInlineAllocator<8>> Indices;
+	TArray<FGameplayTag, TInlineAllocator<8>> Tags;
+	GetTagIndices(InTag, Indices, &Tags);
+	if (Indices.Num() == 0)
+	{
+		return FDelegateHandle();
+	}
+	//component fires events only for exact tag, so bind every child tag we listen on.
+	if (UAFAbilityComponent* ASC = Component.Get())
+	{
+		for (const FGameplayTag& Tag : Tags)
+		{
+			if (!ComponentEventHandles.Contains(Tag))
+			{
+				ComponentEventHandles.Add(Tag, ASC->EffectEvents.FindOrAdd(Tag).AddRaw(this, &FAFEffectEventTable::OnComponentEvent, Tag));
+			}
+		}
+	}
+	TListener<FAFEffectEventListener> Listener;
+	Listener.Handle = FDelegateHandle(FDelegateHandle::GenerateNewHandle);
+	Listener.Delegate = InListener;
+	for (int32 Index : Indices)
+	{
+		if (!EventListeners.IsValidIndex(Index))
+		{
+			EventListeners.SetNum(Index + 1);
+		}
+		EventListeners[Index].Add(Listener);
+	}
+	NumListeners++;
+	INC_DWORD_STAT(STAT_EffectEventListeners);
+	return Listener.Handle;
+}
+void FAFEffectEventTable::RemoveEventListener(const FGameplayTag& InTag, FDelegateHandle InHandle)
+{
+	if (!InHandle.IsValid())
+	{
+		return;
+	}
+	TArray<int32, TInlineAllocator<8>> Indices;
+	GetTagIndices(InTag, Indices);
+	bool bRemoved = false;
+	for (int32 Index : Indices)
+	{
+		if (EventListeners.IsValidIndex(Index))
+		{
+			bRemoved |= RemoveFromList(EventListeners[Index], InHandle);
+		}
+	}
+	if (bRemoved)
+	{
+		OnListenerRemoved();
+	}
+}
+void FAFEffectEventTable::BroadcastEvent(const FGameplayTag& InTag, const FAFEventData& InData)
+{
+	SCOPE_CYCLE_COUNTER(STAT_BroadcastEffectEvent);
+	const FGameplayTagNetIndex NetIndex = UGameplayTagsManager::Get().GetNetIndexFromTag(InTag);
+	if (!EventListeners.IsValidIndex(NetIndex))
+	{
+		return;
+	}
+	BroadcastDepth++;
+	//listeners added during broadcast are appended and not called until next event.
+	const int32 Num = EventListeners[NetIndex].Num();
+	for (int32 Idx = 0; Idx < Num; Idx++)
+	{
+		//copy, listener can bind new tag and grow the table under it's own delegate.
+		if (!EventListeners[NetIndex][Idx].bRemoved)
+		{
+			FAFEffectEventListener Delegate = EventListeners[NetIndex][Idx].Delegate;
+			Delegate.ExecuteIfBound(InData);
+		}
+	}
+	EndBroadcast();
+}
+
+FDelegateHandle FAFEffectEventTable::AddAttributeListener(const FGAAttribute& InAttribute, const FAFAttributeChangedListener& InListener)
+{
+	if (!InAttribute.IsValid())
+	{
+		return FDelegateHandle();
+	}
+	const int32 Index = GetAttributeIndex(InAttribute, true);
+	if (!AttributeListeners.IsValidIndex(Index))
+	{
+		AttributeListeners.SetNum(Index + 1);
+	}
+	UAFAbilityComponent* ASC = Component.Get();
+	if (ASC && !ComponentAttributeHandles.Contains(InAttribute))
+	{
+		ComponentAttributeHandles.Add(InAttribute, ASC->AttributeChanged.FindOrAdd(InAttribute).AddRaw(this, &FAFEffectEventTable::OnComponentAttributeChanged, InAttribute));
+	}
+	TListener<FAFAttributeChangedListener>& Listener = AttributeListeners[Index][AttributeListeners[Index].AddDefaulted()];
+	Listener.Handle = FDelegateHandle(FDelegateHandle::GenerateNewHandle);
+	Listener.Delegate = InListener;
+	NumListeners++;
+	INC_DWORD_STAT(STAT_EffectEventListeners);
+	return Listener.Handle;
+}
+void FAFEffectEventTable::RemoveAttributeListener(const FGAAttribute& InAttribute, FDelegateHandle InHandle)
+{
+	const int32 Index = GetAttributeIndex(InAttribute, false);
+	if (!InHandle.IsValid() || !AttributeListeners.IsValidIndex(Index))
+	{
+		return;
+	}
+	if (RemoveFromList(AttributeListeners[Index], InHandle))
+	{
+		OnListenerRemoved();
+	}
+}
+void FAFEffectEventTable::BroadcastAttributeChange(const FGAAttribute& InAttribute, const FAFAttributeChangedData& InData)
+{
+	SCOPE_CYCLE_COUNTER(STAT_BroadcastEffectEvent);
+	const int32 Index = GetAttributeIndex(InAttribute, false);
+	if (!AttributeListeners.IsValidIndex(Index))
+	{
+		return;
+	}
+	BroadcastDepth++;
+	const int32 Num = AttributeListeners[Index].Num();
+	for (int32 Idx = 0; Idx < Num; Idx++)
+	{
+		if (!AttributeListeners[Index][Idx].bRemoved)
+		{
+			FAFAttributeChangedListener Delegate = AttributeListeners[Index][Idx].Delegate;
+			Delegate.ExecuteIfBound(InData);
+		}
+	}
+	EndBroadcast();
+}
+
+template<typename DelegateType>
+bool FAFEffectEventTable::RemoveFromList(TArray<TListener<DelegateType>>& InList, FDelegateHandle InHandle)
+{
+	for (int32 Idx = 0; Idx < InList.Num(); Idx++)
+	{
+		if (InList[Idx].Handle != InHandle || InList[Idx].bRemoved)
+		{
+			continue;
+		}
+		if (BroadcastDepth > 0)
+		{
+			InList[Idx].bRemoved = true;
+			bNeedsCompact = true;
+		}
+		else
+		{
+			InList.RemoveAt(Idx);
+		}
+		return true;
+	}
+	return false;
+}
+void FAFEffectEventTable::OnListenerRemoved()
+{
+	NumListeners--;
+	DEC_DWORD_STAT(STAT_EffectEventListeners);
+	if (NumListeners <= 0 && BroadcastDepth == 0)
+	{
+		//deletes this.
+		Tables.Remove(OwnerKey);
+	}
+}
+void FAFEffectEventTable::EndBroadcast()
+{
+	BroadcastDepth--;
+	if (BroadcastDepth > 0)
+	{
+		return;
+	}
+	if (bNeedsCompact)
+	{
+		bNeedsCompact = false;
+		for (FEventListeners& Listeners : EventListeners)
+		{
+			Listeners.RemoveAll([](const TListener<FAFEffectEventListener>& Listener) { return Listener.bRemoved; });
+		}
+		for (FAttributeListeners& Listeners : AttributeListeners)
+		{
+			Listeners.RemoveAll([](const TListener<FAFAttributeChangedListener>& Listener) { return Listener.bRemoved; });
+		}
+	}
+	if (NumListeners <= 0)
+	{
+		//deletes this.
+		Tables.Remove(OwnerKey);
+	}
+}
+
+void FAFEffectEventTable::OnComponentEvent(FAFEventData InData, FGameplayTag InTag)
+{
+	//can release this table, don't touch it after.
+	BroadcastEvent(InTag, InData);
+}
+void FAFEffectEventTable::OnComponentAttributeChanged(FAFAttributeChangedData InData, FGAAttribute InAttribute)
+{
+	BroadcastAttributeChange(InAttribute, InData);
+}
@@ -0,0 +1,99 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameplayTagContainer.h"
+#include "../GAGlobalTypes.h"
+#include "GAGameEffect.h"
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Broadcast Effect Event"), STAT_BroadcastEffectEvent, STATGROUP_GameEffect, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Effect Event Listeners"), STAT_EffectEventListeners, STATGROUP_GameEffect, );
+
+DECLARE_DELEGATE_OneParam(FAFEffectEventListener, FAFEventData);
+DECLARE_DELEGATE_OneParam(FAFAttributeChangedListener, FAFAttributeChangedData);
+
+/*
+	Effect event and attribute change listeners of single object (ability component),
+	indexed by tag net index and by attribute index, so broadcast is one array lookup
+	and walk over listeners of that index.
+
+	Listener bound to tag is also added to lists of all child tags of it, when it's bound,
+	so listener on Damage fires for Damage.Fire.
+
+	When owner is ability component, table binds once per tag/attribute to component's
+	own EffectEvents/AttributeChanged, so everything component fires reaches listeners.
+
+	Tables live in static registry keyed by owner. Table is created by first listener
+	and released when last listener is removed, when owner is removed or when it's world
+	is cleaned up.
+*/
+class ABILITYFRAMEWORK_API FAFEffectEventTable
+{
+protected:
+	static TMap<FObjectKey, TUniquePtr<FAFEffectEventTable>> Tables;
+	/* Attributes don't have net index, they get one on first bind. */
+	static TMap<FName, int32> AttributeIndices;
+
+	template<typename DelegateType>
+	struct TListener
+	{
+		FDelegateHandle Handle;
+		DelegateType Delegate;
+		/* Delegate can't be unbound while it's executing. */
+		bool bRemoved;
+		TListener()
+			: bRemoved(false)
+		{}
+	};
+	typedef TArray<TListener<FAFEffectEventListener>> FEventListeners;
+	typedef TArray<TListener<FAFAttributeChangedListener>> FAttributeListeners;
+
+	FObjectKey OwnerKey;
+	TWeakObjectPtr<class UAFAbilityComponent> Component;
+	/* Bindings to component delegates, kept until table is released. */
+	TMap<FGameplayTag, FDelegateHandle> ComponentEventHandles;
+	TMap<FGAAttribute, FDelegateHandle> ComponentAttributeHandles;
+	TArray<FEventListeners> EventListeners;
+	TArray<FAttributeListeners> AttributeListeners;
+	/* Bound tags, counted once no matter how many child lists listener is in. */
+	int32 NumListeners;
+	/* Listeners removed while broadcasting are only marked, and compacted after broadcast. */
+	int32 BroadcastDepth;
+	bool bNeedsCompact;
+
+public:
+	FAFEffectEventTable(UObject* InOwner);
+	~FAFEffectEventTable();
+
+	static FAFEffectEventTable& FindOrAdd(UObject* InOwner);
+	/* nullptr if nothing listens on InOwner. */
+	static FAFEffectEventTable* Find(UObject* InOwner);
+	/* Drops all listeners of InOwner. Safe to call from listener. */
+	static void Remove(UObject* InOwner);
+	static void HandleWorldCleanup(UWorld* InWorld, bool bSessionEnded, bool bCleanupResources);
+
+	FDelegateHandle AddEventListener(const FGameplayTag& InTag, const FAFEffectEventListener& InListener);
+	void RemoveEventListener(const FGameplayTag& InTag, FDelegateHandle InHandle);
+	void BroadcastEvent(const FGameplayTag& InTag, const FAFEventData& InData);
+
+	FDelegateHandle AddAttributeListener(const FGAAttribute& InAttribute, const FAFAttributeChangedListener& InListener);
+	void RemoveAttributeListener(const FGAAttribute& InAttribute, FDelegateHandle InHandle);
+	void BroadcastAttributeChange(const FGAAttribute& InAttribute, const FAFAttributeChangedData& InData);
+
+	inline int32 GetNumListeners() const { return NumListeners; }
+protected:
+	/* InTag and all of it's children which have net index. */
+	static void GetTagIndices(const FGameplayTag& InTag, TArray<int32, TInlineAllocator<8>>& OutIndices,
+		TArray<FGameplayTag, TInlineAllocator<8>>* OutTags = nullptr);
+	static int32 GetAttributeIndex(const FGAAttribute& InAttribute, bool bAdd);
+
+	template<typename DelegateType>
+	bool RemoveFromList(TArray<TListener<DelegateType>>& InList, FDelegateHandle InHandle);
+	void OnListenerRemoved();
+	void EndBroadcast();
+	static void Release(const FObjectKey& InOwnerKey);
+
+	void OnComponentEvent(FAFEventData InData, FGameplayTag InTag);
+	void OnComponentAttributeChanged(FAFAttributeChangedData InData, FGAAttribute InAttribute);
+};
@@ -0,0 +1,128 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "../AbilityFramework.h"
+#include "GAGameEffect.h"
+#include "GAEffectExtension.h"
+#include "AFEffectExtensionPool.h"
+
+DEFINE_STAT(STAT_ExtensionsCreated);
+DEFINE_STAT(STAT_ExtensionsReused);
+DEFINE_STAT(STAT_ExtensionsDiscarded);
+DEFINE_STAT(STAT_PooledExtensions);
+
+UAFEffectExtensionPool* UAFEffectExtensionPool::PoolInstance = nullptr;
+
+UAFEffectExtensionPool::UAFEffectExtensionPool(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	MaxPooledPerClass = 32;
+	MaxPooledPerWorld = 256;
+}
+
+UAFEffectExtensionPool* UAFEffectExtensionPool::Get()
+{
+	if (PoolInstance)
+	{
+		return PoolInstance;
+	}
+	PoolInstance = NewObject<UAFEffectExtensionPool>(GEngine, UAFEffectExtensionPool::StaticClass(), "UAFEffectExtensionPoolInstance",
+		RF_MarkAsRootSet);
+	PoolInstance->AddToRoot();
+	PoolInstance->Initialize();
+
+	return PoolInstance;
+}
+void UAFEffectExtensionPool::AddReferencedObjects(UObject* InThis, FReferenceCollector& Collector)
+{
+	UAFEffectExtensionPool* This = CastChecked<UAFEffectExtensionPool>(InThis);
+	for (auto WorldIt = This->WorldPools.CreateIterator(); WorldIt; ++WorldIt)
+	{
+		for (auto ClassIt = WorldIt->Value.FreeExtensions.CreateIterator(); ClassIt; ++ClassIt)
+		{
+			Collector.AddReferencedObjects(ClassIt->Value, This);
+		}
+	}
+	Super::AddReferencedObjects(InThis, Collector);
+}
+void UAFEffectExtensionPool::Initialize()
+{
+	FWorldDelegates::OnWorldCleanup.AddUObject(this, &UAFEffectExtensionPool::HandleWorldCleanup);
+}
+
+UGAEffectExtension* UAFEffectExtensionPool::Acquire(UWorld* InWorld, TSubclassOf<UGAEffectExtension> InClass)
+{
+	if (!InClass || !InWorld)
+	{
+		return nullptr;
+	}
+	//pool is only created here, never after world has been cleaned up.
+	FWorldExtensionPool* Pool = InWorld->bIsTearingDown ? WorldPools.Find(FObjectKey(InWorld))
+		: &WorldPools.FindOrAdd(FObjectKey(InWorld));
+	if (Pool)
+	{
+		TArray<UGAEffectExtension*>* Free = Pool->FreeExtensions.Find(InClass.Get());
+		while (Free && Free->Num() > 0)
+		{
+			UGAEffectExtension* Extension = Free->Pop(false);
+			Pool->NumPooled--;
+			DEC_DWORD_STAT(STAT_PooledExtensions);
+			if (Extension && !Extension->IsPendingKill())
+			{
+				INC_DWORD_STAT(STAT_ExtensionsReused);
+				return Extension;
+			}
+		}
+	}
+	INC_DWORD_STAT(STAT_ExtensionsCreated);
+	//outer is world, instances will be reused for different targets.
+	return NewObject<UGAEffectExtension>(InWorld, InClass);
+}
+void UAFEffectExtensionPool::Release(UGAEffectExtension* InExtension)
+{
+	if (!InExtension || InExtension->IsPendingKill())
+	{
+		return;
+	}
+	InExtension->ResetExtension();
+	UWorld* World = InExtension->GetTypedOuter<UWorld>();
+	FWorldExtensionPool* Pool = World ? WorldPools.Find(FObjectKey(World)) : nullptr;
+	if (Pool && Pool->NumPooled < MaxPooledPerWorld)
+	{
+		TArray<UGAEffectExtension*>& Free = Pool->FreeExtensions.FindOrAdd(InExtension->GetClass());
+		if (Free.Num() < MaxPooledPerClass)
+		{
+			Free.Add(InExtension);
+			Pool->NumPooled++;
+			INC_DWORD_STAT(STAT_PooledExtensions);
+			return;
+		}
+	}
+	INC_DWORD_STAT(STAT_ExtensionsDiscarded);
+	InExtension->MarkPendingKill();
+}
+
+void UAFEffectExtensionPool::HandleWorldCleanup(UWorld* InWorld, bool bSessionEnded, bool bCleanupResources)
+{
+	FWorldExtensionPool* Pool = WorldPools.Find(FObjectKey(InWorld));
+	if (Pool)
+	{
+		EmptyWorldPool(*Pool);
+		WorldPools.Remove(FObjectKey(InWorld));
+	}
+}
+void UAFEffectExtensionPool::EmptyWorldPool(FWorldExtensionPool& InPool)
+{
+	for (auto It = InPool.FreeExtensions.CreateIterator(); It; ++It)
+	{
+		for (UGAEffectExtension* Extension : It->Value)
+		{
+			if (Extension)
+			{
+				Extension->MarkPendingKill();
+			}
+		}
+	}
+	DEC_DWORD_STAT_BY(STAT_PooledExtensions, InPool.NumPooled);
+	InPool.FreeExtensions.Empty();
+	InPool.NumPooled = 0;
+}
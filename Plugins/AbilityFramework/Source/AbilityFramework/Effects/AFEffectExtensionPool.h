@@ -0,0 +1,61 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/NoExportTypes.h"
+#include "AFEffectExtensionPool.generated.h"
+
+/*
+	Keeps released UGAEffectExtension instances per world and per class, so effects
+	which are applied very often, don't create new UObject on every application
+	(and don't leave garbage for GC after they expire).
+
+	Extensions are reset (context, tasks, owning component) before going back to pool.
+*/
+UCLASS(config = Game)
+class ABILITYFRAMEWORK_API UAFEffectExtensionPool : public UObject
+{
+	GENERATED_BODY()
+protected:
+	static UAFEffectExtensionPool* PoolInstance;
+
+	/* How many free extensions of single class we keep in single world. */
+	UPROPERTY(config, EditAnywhere, Category = "Pool")
+		int32 MaxPooledPerClass;
+	/* How many free extensions in total we keep in single world. */
+	UPROPERTY(config, EditAnywhere, Category = "Pool")
+		int32 MaxPooledPerWorld;
+
+	struct FWorldExtensionPool
+	{
+		TMap<UClass*, TArray<class UGAEffectExtension*>> FreeExtensions;
+		int32 NumPooled;
+
+		FWorldExtensionPool()
+			: NumPooled(0)
+		{}
+	};
+
+	TMap<FObjectKey, FWorldExtensionPool> WorldPools;
+public:
+	UAFEffectExtensionPool(const FObjectInitializer& ObjectInitializer);
+
+	static UAFEffectExtensionPool* Get();
+	static void AddReferencedObjects(UObject* InThis, FReferenceCollector& Collector);
+
+	/* Returns pooled extension of given class or creates new one if pool is empty. */
+	class UGAEffectExtension* Acquire(UWorld* InWorld, TSubclassOf<class UGAEffectExtension> InClass);
+	/* 
+		Resets extension and puts it back to pool of it's world. 
+		If world has been already cleaned up, extension is destroyed instead.
+	*/
+	void Release(class UGAEffectExtension* InExtension);
+
+	inline int32 GetNumWorldPools() const { return WorldPools.Num(); }
+
+	void Initialize();
+protected:
+	void HandleWorldCleanup(UWorld* InWorld, bool bSessionEnded, bool bCleanupResources);
+	void EmptyWorldPool(FWorldExtensionPool& InPool);
+};
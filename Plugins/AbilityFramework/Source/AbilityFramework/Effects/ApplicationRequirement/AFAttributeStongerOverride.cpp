@@ -15,7 +15,7 @@ bool UAFAttributeStongerOverride::CanApply(FGAEffect* EffectIn, FGAEffectPropert
 {
 	bool bCanApply = true;
 	FGAAttribute Attribute = InProperty.Spec->AtributeModifier.Attribute;
-	FAFAttributeBase* AttributePtr = EffectIn->Context.TargetInterface->GetAttribute(Attribute);
+	FAFAttributeBase* AttributePtr = EffectIn->Context->TargetInterface->GetAttribute(Attribute);
 	if (AttributePtr)
 	{
 		FGAEffectMod mod = FAFStatics::GetAttributeModifier(InProperty.GetAttributeModifier()
@@ -15,9 +15,9 @@ bool UAFAtributeDurationAdd::ApplyEffect(const FGAEffectHandle& InHandle, struct
 {
 	FTimerManager& DurationTimer = InHandle.GetContext().TargetComp->GetWorld()->GetTimerManager();
 
-	FTimerDelegate delDuration = FTimerDelegate::CreateUObject(InHandle.GetContext().TargetComp.Get(), &UAFAbilityComponent::ExpireEffect, InHandle, InProperty, InContext);
+	FTimerDelegate delDuration = FTimerDelegate::CreateSP(InHandle.GetEffectPtr().ToSharedRef(), &FGAEffect::OnDurationTimer);
 	DurationTimer.SetTimer(InHandle.GetEffectPtr()->DurationTimerHandle, delDuration,
-		InProperty.Duration, false);
+		InHandle.GetEffectPtr()->TimerRecord.Duration, false);
 
 	InContainer->AddEffect(InHandle);
 	//EffectIn->Context.TargetComp->ExecuteEffect(InHandle, InProperty);
@@ -13,15 +13,15 @@ bool UAFPeriodApplicationAdd::ApplyEffect(const FGAEffectHandle& InHandle, struc
 {
 	FTimerManager& DurationTimer = InHandle.GetContext().TargetComp->GetWorld()->GetTimerManager();
 
-	FTimerDelegate delDuration = FTimerDelegate::CreateUObject(InHandle.GetContext().TargetComp.Get(), &UAFAbilityComponent::ExpireEffect, InHandle, InProperty, InContext);
+	FTimerDelegate delDuration = FTimerDelegate::CreateSP(InHandle.GetEffectPtr().ToSharedRef(), &FGAEffect::OnDurationTimer);
 	DurationTimer.SetTimer(InHandle.GetEffectPtr()->DurationTimerHandle, delDuration,
-		InProperty.Duration, false);
+		InHandle.GetEffectPtr()->TimerRecord.Duration, false);
 
 	FTimerManager& PeriodTimer = InHandle.GetContext().TargetComp->GetWorld()->GetTimerManager();
 
-	FTimerDelegate PeriodDuration = FTimerDelegate::CreateUObject(InHandle.GetContext().TargetComp.Get(), &UAFAbilityComponent::ExecuteEffect, InHandle, InProperty, Modifier, InContext);
+	FTimerDelegate PeriodDuration = FTimerDelegate::CreateSP(InHandle.GetEffectPtr().ToSharedRef(), &FGAEffect::OnPeriodTimer);
 	PeriodTimer.SetTimer(InHandle.GetEffectPtr()->PeriodTimerHandle, PeriodDuration,
-		InProperty.Period, true);
+		InHandle.GetEffectPtr()->TimerRecord.Period, true);
 
 	InContainer->AddEffect(InHandle);
 	//EffectIn.Context.TargetComp->ExecuteEffect(InHandle, InProperty);
@@ -12,7 +12,7 @@ bool UAFPeriodApplicationExtend::ApplyEffect(const FGAEffectHandle& InHandle, st
 	FGAEffectProperty& InProperty, struct FGAEffectContainer* InContainer,
 	const FGAEffectContext& InContext, const FAFFunctionModifier& Modifier)
 {
-	TSet<FGAEffectHandle> handles = InContainer->GetHandlesByClass(InProperty, EffectIn->Context);
+	TSet<FGAEffectHandle> handles = InContainer->GetHandlesByClass(InProperty, EffectIn->Context.GetRef());
 	for (const FGAEffectHandle& handle : handles)
 	{
 		FGAEffect& ExtEffect = handle.GetEffectRef();
@@ -22,7 +22,7 @@ bool UAFPeriodApplicationExtend::ApplyEffect(const FGAEffectHandle& InHandle, st
 		float NewDuration = RemainingTime + Effect.GetDurationTime();
 		DurationTimer.ClearTimer(handle.GetEffectPtr()->DurationTimerHandle);
 
-		FTimerDelegate delDuration = FTimerDelegate::CreateUObject(handle.GetContext().TargetComp.Get(), &UAFAbilityComponent::ExpireEffect, InHandle, InProperty, InContext);
+		FTimerDelegate delDuration = FTimerDelegate::CreateSP(handle.GetEffectPtr().ToSharedRef(), &FGAEffect::OnDurationTimer);
 		DurationTimer.SetTimer(handle.GetEffectPtr()->DurationTimerHandle, delDuration,
 			NewDuration, false);
 	}
@@ -30,15 +30,15 @@ bool UAFPeriodApplicationExtend::ApplyEffect(const FGAEffectHandle& InHandle, st
 	{
 		FTimerManager& DurationTimer = InHandle.GetContext().TargetComp->GetWorld()->GetTimerManager();
 
-		FTimerDelegate delDuration = FTimerDelegate::CreateUObject(InHandle.GetContext().TargetComp.Get(), &UAFAbilityComponent::ExpireEffect, InHandle, InProperty, InContext);
+		FTimerDelegate delDuration = FTimerDelegate::CreateSP(InHandle.GetEffectPtr().ToSharedRef(), &FGAEffect::OnDurationTimer);
 		DurationTimer.SetTimer(InHandle.GetEffectPtr()->DurationTimerHandle, delDuration,
-			InProperty.Duration, false);
+			InHandle.GetEffectPtr()->TimerRecord.Duration, false);
 
 		FTimerManager& PeriodTimer = InHandle.GetContext().TargetComp->GetWorld()->GetTimerManager();
 
-		FTimerDelegate PeriodDuration = FTimerDelegate::CreateUObject(InHandle.GetContext().TargetComp.Get(), &UAFAbilityComponent::ExecuteEffect, InHandle, InProperty, Modifier, InContext);
+		FTimerDelegate PeriodDuration = FTimerDelegate::CreateSP(InHandle.GetEffectPtr().ToSharedRef(), &FGAEffect::OnPeriodTimer);
 		PeriodTimer.SetTimer(InHandle.GetEffectPtr()->PeriodTimerHandle, PeriodDuration,
-			InProperty.Period, true);
+			InHandle.GetEffectPtr()->TimerRecord.Period, true);
 
 		InContainer->AddEffect(InHandle);
 	}
@@ -13,9 +13,9 @@ bool UAFPeriodApplicationInfiniteAdd::ApplyEffect(const FGAEffectHandle& InHandl
 {
 	FTimerManager& PeriodTimer = InHandle.GetContext().TargetComp->GetWorld()->GetTimerManager();
 
-	FTimerDelegate PeriodDuration = FTimerDelegate::CreateUObject(InHandle.GetContext().TargetComp.Get(), &UAFAbilityComponent::ExecuteEffect, InHandle, InProperty, Modifier, InContext);
+	FTimerDelegate PeriodDuration = FTimerDelegate::CreateSP(InHandle.GetEffectPtr().ToSharedRef(), &FGAEffect::OnPeriodTimer);
 	PeriodTimer.SetTimer(InHandle.GetEffectPtr()->PeriodTimerHandle, PeriodDuration,
-		InProperty.Period, true);
+		InHandle.GetEffectPtr()->TimerRecord.Period, true);
 	InContainer->AddEffect(InHandle, true);
 	//EffectIn->Context.TargetComp->ExecuteEffect(InHandle, InProperty);
 	return true;
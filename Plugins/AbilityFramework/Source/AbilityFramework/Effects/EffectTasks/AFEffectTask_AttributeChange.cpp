@@ -1,6 +1,7 @@
 // Fill out your copyright notice in the Description page of Project Settings.
 
 #include "AbilityFramework.h"
+#include "../AFEffectEventTable.h"
 #include "AFEffectTask_AttributeChange.h"
 
 
@@ -28,7 +29,8 @@ void UAFEffectTask_AttributeChange::Activate()
 	UAFAbilityComponent* ASC = GetTargetASC();
 	if (ASC)
 	{
-		MyHandle = ASC->AttributeChanged.FindOrAdd(Attribute).AddUObject(this, &UAFEffectTask_AttributeChange::AttributeChangedCallback);
+		MyHandle = FAFEffectEventTable::FindOrAdd(ASC).AddAttributeListener(Attribute,
+			FAFAttributeChangedListener::CreateUObject(this, &UAFEffectTask_AttributeChange::AttributeChangedCallback));
 	}
 
 	Super::Activate();
@@ -74,7 +76,11 @@ void UAFEffectTask_AttributeChange::OnDestroy(bool AbilityEnding)
 	UAFAbilityComponent* ASC = GetTargetASC();
 	if (ASC && MyHandle.IsValid())
 	{
-		ASC->AttributeChanged.FindOrAdd(Attribute).Remove(MyHandle);
+		if (FAFEffectEventTable* Table = FAFEffectEventTable::Find(ASC))
+		{
+			Table->RemoveAttributeListener(Attribute, MyHandle);
+		}
+		MyHandle.Reset();
 	}
 
 	Super::OnDestroy(AbilityEnding);
@@ -2,6 +2,7 @@
 
 #include "AbilityFramework.h"
 #include "../../AFAbilityInterface.h"
+#include "../AFEffectEventTable.h"
 #include "AFEffectTask_EffectEvent.h"
 
 
@@ -28,7 +29,8 @@ void UAFEffectTask_EffectEvent::Activate()
 	UAFAbilityComponent* ASC = GetTargetASC();
 	if (ASC)
 	{
-		MyHandle = ASC->EffectEvents.FindOrAdd(Tag).AddUObject(this, &UAFEffectTask_EffectEvent::GameplayEventCallback);
+		MyHandle = FAFEffectEventTable::FindOrAdd(ASC).AddEventListener(Tag,
+			FAFEffectEventListener::CreateUObject(this, &UAFEffectTask_EffectEvent::GameplayEventCallback));
 	}
 
 	Super::Activate();
@@ -75,7 +77,11 @@ void UAFEffectTask_EffectEvent::OnDestroy(bool AbilityEnding)
 	UAFAbilityComponent* ASC = GetTargetASC();
 	if (ASC && MyHandle.IsValid())
 	{
-		ASC->EffectEvents.FindOrAdd(Tag).Remove(MyHandle);
+		if (FAFEffectEventTable* Table = FAFEffectEventTable::Find(ASC))
+		{
+			Table->RemoveEventListener(Tag, MyHandle);
+		}
+		MyHandle.Reset();
 	}
 
 	Super::OnDestroy(AbilityEnding);
@@ -62,6 +62,8 @@ FGAEffectHandle UGABlueprintLibrary::ApplyEffect(FGAEffectProperty& InEffect,
 		return FGAEffectHandle();
 	}
 	UE_LOG(GameAttributesEffects, Log, TEXT("MakeOutgoingSpecObj: Created new Context: %s"), *Context.ToString());
+	//capture before anything is evaluated. Context is shared and immutable after Generate.
+	InEffect.GetSpec()->CaptureAttributes(Context);
 	InEffect.Duration = InEffect.GetSpec()->Duration.GetFloatValue(Context);
 	InEffect.Period = InEffect.GetSpec()->Period.GetFloatValue(Context);
 	FGAEffect* effect = nullptr;
@@ -69,21 +71,21 @@ FGAEffectHandle UGABlueprintLibrary::ApplyEffect(FGAEffectProperty& InEffect,
 	{
 		if (!InEffect.Handle.IsValid())
 		{
-			effect = new FGAEffect(InEffect.GetSpec(), Context);
+			effect = new FGAEffect(InEffect.GetSpec(), FAFContextHandle::Generate(Context));
 			AddTagsToEffect(effect);
-			effect->Context = Context;
 			effect->GameEffect = InEffect.GetSpec();
 		}
 		else
 		{
+			//cached instant effect, it must not keep context (and snapshot) of previous target.
 			effect = InEffect.Handle.GetEffectPtr().Get();
+			effect->SetContext(Context);
 		}
 	}
 	else
 	{
-		effect = new FGAEffect(InEffect.GetSpec(), Context);
+		effect = new FGAEffect(InEffect.GetSpec(), FAFContextHandle::Generate(Context));
 		AddTagsToEffect(effect);
-		effect->Context = Context;
 		effect->GameEffect = InEffect.GetSpec();
 	}
 
@@ -139,6 +141,7 @@ FGAEffectHandle UGABlueprintLibrary::MakeEffect(UGAGameEffectSpec* SpecIn,
 	}
 
 	UE_LOG(GameAttributesEffects, Log, TEXT("MakeOutgoingSpecObj: Created new Context: %s"), *Context.ToString());
+	SpecIn->CaptureAttributes(Context);
 
 	if (HandleIn.IsValid())
 	{
@@ -195,7 +198,7 @@ void UGABlueprintLibrary::AddTagsToEffect(FGAEffect* EffectIn)
 	}
 }
 
-FGAEffectContext& UGABlueprintLibrary::GetContext(const FGAEffectHandle& InHandle)
+const FGAEffectContext& UGABlueprintLibrary::GetContext(const FGAEffectHandle& InHandle)
 {
 	return InHandle.GetContextRef();
 }
@@ -221,5 +224,6 @@ void UGABlueprintLibrary::BroadcastEffectEvent(UObject* Target, FGameplayTag Eve
 		return;
 
 	FAFEventData EventData;
+	//effect tasks get it trough table bound to component events.
 	TargetComp->NativeTriggerTagEvent(EventTag, EventData);
 }
\ No newline at end of file
@@ -63,7 +63,7 @@ public:
 	static void AddTagsToEffect(FGAEffect* EffectIn);
 
 	UFUNCTION(BlueprintPure, Category = "AbilityFramework|Effects")
-	static FGAEffectContext& GetContext(const FGAEffectHandle& InHandle);
+	static const FGAEffectContext& GetContext(const FGAEffectHandle& InHandle);
 
 	UFUNCTION(BlueprintPure, Category = "AbilityFramework|Effects")
 	static UAFAbilityComponent* GetTargetComponent(const FGAEffectHandle& InHandle);
@@ -9,3 +9,23 @@ UGACustomCalculation::UGACustomCalculation(const FObjectInitializer& ObjectIniti
 {
 
 }
+
+float UGACustomCalculation::NativeCalculateMagnitudeFromContext(const FGAEffectHandle& HandleIn, const FGAEffectContext& InContext)
+{
+	//legacy calculations read context from handle, there is nothing to read it from yet.
+	if (!HandleIn.IsValid())
+		return 0;
+
+	return NativeCalculateMagnitude(HandleIn);
+}
+void UGACustomCalculation::NativeCalculateMagnitudes(const TArray<FGAEffectHandle>& InHandles,
+	const TArray<const FGAEffectContext*>& InContexts, TArray<float>& OutMagnitudes)
+{
+	check(InHandles.Num() == InContexts.Num());
+	const int32 Num = InContexts.Num();
+	OutMagnitudes.SetNumUninitialized(Num, false);
+	for (int32 Idx = 0; Idx < Num; Idx++)
+	{
+		OutMagnitudes[Idx] = NativeCalculateMagnitudeFromContext(InHandles[Idx], *InContexts[Idx]);
+	}
+}
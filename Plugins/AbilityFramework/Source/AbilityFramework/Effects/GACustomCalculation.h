@@ -27,4 +27,21 @@ public:
 	
 
 	virtual float NativeCalculateMagnitude(const FGAEffectHandle& HandleIn) { return 0; }
+	/*
+		Called when magnitude is evaluated from context. Handle might not be valid yet
+		(ie. Duration and Period are calculated before effect is created), so
+		override it if calculation can work from context alone.
+		By default forwards to NativeCalculateMagnitude, or returns 0 if handle is not valid.
+	*/
+	virtual float NativeCalculateMagnitudeFromContext(const FGAEffectHandle& HandleIn, const FGAEffectContext& InContext);
+	/*
+		Batch version. InHandles and InContexts are parallel arrays (handles can be invalid),
+		OutMagnitudes is resized to match and filled with results.
+
+		Override when you can calculate many magnitudes at once, ie. resolve attributes
+		in one pass and then run formula over plain arrays.
+		Default implementation just loops over NativeCalculateMagnitudeFromContext.
+	*/
+	virtual void NativeCalculateMagnitudes(const TArray<FGAEffectHandle>& InHandles,
+		const TArray<const FGAEffectContext*>& InContexts, TArray<float>& OutMagnitudes);
 };
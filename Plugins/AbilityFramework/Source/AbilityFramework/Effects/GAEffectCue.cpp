@@ -10,7 +10,12 @@ AGAEffectCue::AGAEffectCue(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
 {
 	PrimaryActorTick.bCanEverTick = true;
-	PrimaryActorTick.bStartWithTickEnabled = true;
+	//woken up by UAFCueManager when cue is used.
+	PrimaryActorTick.bStartWithTickEnabled = false;
+	bDormant = false;
+	bManagedSequence = false;
+	bBlueprintTick = false;
+	bShareSequenceEvaluation = false;
 	StartTime = 0;
 	EndTime = 5;
 	if (HasAnyFlags(RF_ClassDefaultObject) || GetArchetype() == GetDefault<AGAEffectCue>())
@@ -23,6 +28,7 @@ AGAEffectCue::AGAEffectCue(const FObjectInitializer& ObjectInitializer)
 void AGAEffectCue::PostInitProperties()
 {
 	Super::PostInitProperties();
+	bBlueprintTick = GetClass()->IsFunctionImplementedInBlueprint(GET_FUNCTION_NAME_CHECKED(AGAEffectCue, ReceiveTick));
 }
 void AGAEffectCue::SetAnimation(class UGAEffectCueSequence* InSequence)
 {
@@ -41,7 +47,7 @@ void AGAEffectCue::BeginPlay()
 void AGAEffectCue::Tick( float DeltaTime )
 {
 	Super::Tick( DeltaTime );
-	if (SequencePlayer)
+	if (SequencePlayer && !bManagedSequence)
 	{
 		SequencePlayer->Update(DeltaTime);
 	}
@@ -71,4 +77,16 @@ void AGAEffectCue::NativeOnRemoved()
 	SequencePlayer->Stop();
 
 	OnRemoved();
-}
\ No newline at end of file
+}
+void AGAEffectCue::SetDormant(bool bInDormant)
+{
+	bDormant = bInDormant;
+	SetActorTickEnabled(!bInDormant && NeedsActorTick());
+	SetActorHiddenInGame(bInDormant);
+	SetActorEnableCollision(!bInDormant);
+}
+void AGAEffectCue::SetManagedSequence(bool bInManaged)
+{
+	bManagedSequence = bInManaged;
+	SetActorTickEnabled(!bDormant && NeedsActorTick());
+}
@@ -40,6 +40,28 @@ public:
 
 	void NativeOnExecuted();
 	void NativeOnRemoved();
+	/*
+		Pooled cue waiting for reuse is dormant: hidden, without collision and not ticking,
+		so idle pool costs nothing per frame.
+	*/
+	void SetDormant(bool bInDormant);
+	inline bool IsDormant() const { return bDormant; }
+	/* Sequence player is updated by UAFCueManager instead of this actor's tick. */
+	void SetManagedSequence(bool bInManaged);
+protected:
+	bool bDormant;
+	bool bManagedSequence;
+	/* Blueprint implements Tick, actor has to tick even if sequence is managed. */
+	bool bBlueprintTick;
+	inline bool NeedsActorTick() const { return bBlueprintTick || !bManagedSequence; }
+public:
+	/*
+		Cues of the same class started within UAFCueManager::SequenceShareFrames evaluate sequence once,
+		other cues copy transform and visibility of animated components. Opt in only if sequence
+		animates nothing else (materials, events).
+	*/
+	UPROPERTY(EditAnywhere, Category = "Playback")
+		bool bShareSequenceEvaluation;
 	UPROPERTY()
 		float Duration;
 	UPROPERTY()
@@ -2,15 +2,51 @@
 
 #include "../AbilityFramework.h"
 #include "../AFAbilityComponent.h"
+#include "GameplayTask.h"
 #include "GAEffectExtension.h"
 
 UGAEffectExtension::UGAEffectExtension(const FObjectInitializer& ObjectInitializer)
 : Super(ObjectInitializer)
 {
 }
-void UGAEffectExtension::SetParameters(const FGAEffectContext& ContextIn)
+void UGAEffectExtension::SetParameters(const FAFContextHandle& ContextIn)
 {
-	Context = ContextIn;
+	ContextHandle = ContextIn;
+	if (ContextHandle.IsValid())
+	{
+		Context = ContextHandle.GetRef();
+		INC_DWORD_STAT_BY(STAT_ContextBytesCopied, sizeof(FGAEffectContext));
+	}
+}
+void UGAEffectExtension::ResetExtension()
+{
+	//tasks will remove themselves from ActiveTasks on deactivation.
+	TArray<UGameplayTask*> TasksToEnd = ActiveTasks.Array();
+	for (UGameplayTask* Task : TasksToEnd)
+	{
+		if (Task)
+		{
+			Task->ExternalCancel();
+		}
+	}
+	ActiveTasks.Empty();
+	ContextHandle.Reset();
+	Context.Reset();
+	OwningComponent = nullptr;
+	Avatar = nullptr;
+
+	UObject* CDO = GetClass()->GetDefaultObject();
+	for (TFieldIterator<UProperty> It(GetClass()); It; ++It)
+	{
+		UProperty* Property = *It;
+		//our own properties are reset above, instanced subobjects would be shared with CDO.
+		if (Property->GetOwnerClass() == UGAEffectExtension::StaticClass()
+			|| Property->HasAnyPropertyFlags(CPF_InstancedReference | CPF_ContainsInstancedReference))
+		{
+			continue;
+		}
+		Property->CopyCompleteValue_InContainer(this, CDO);
+	}
 }
 void UGAEffectExtension::BeginEffect()
 {
@@ -70,8 +106,8 @@ AActor* UGAEffectExtension::GetGameplayTaskAvatar(const UGameplayTask* Task) con
 
 UWorld* UGAEffectExtension::GetWorld() const
 {
-	if (Context.Target.IsValid())
-		return Context.Target->GetWorld();
+	if (ContextHandle.IsValid() && ContextHandle->Target.IsValid())
+		return ContextHandle->Target->GetWorld();
 
 	return nullptr;
 }
\ No newline at end of file
@@ -23,8 +23,11 @@ class ABILITYFRAMEWORK_API UGAEffectExtension : public UObject, public IGameplay
 {
 	GENERATED_BODY()
 public:
+	/* Copy for blueprints, made once when extension is activated. */
 	UPROPERTY(BlueprintReadOnly, Category = "Context")
 		FGAEffectContext Context;
+	/* Shared with owning effect. */
+	FAFContextHandle ContextHandle;
 	UPROPERTY()
 		class UAFAbilityComponent* OwningComponent;
 	UPROPERTY()
@@ -34,7 +37,14 @@ public:
 
 public:
 	UGAEffectExtension(const FObjectInitializer& ObjectInitializer);
-	void SetParameters(const FGAEffectContext& ContextIn);
+	void SetParameters(const FAFContextHandle& ContextIn);
+	/* 
+		Called before extension goes back to pool. Cancels running tasks, clears context
+		and resets properties declared by subclasses (native and blueprint) to class defaults.
+	*/
+	virtual void ResetExtension();
+
+	inline const FGAEffectContext& GetContext() const { return Context; }
 	void BeginEffect();
 
 	/*
@@ -3,38 +3,208 @@
 #include "../AbilityFramework.h"
 
 #include "../Abilities/GAAbilityBase.h"
+#include "../AFAbilityComponent.h"
+#include "../AFSpatialIndex.h"
+#include "GABlueprintLibrary.h"
+#include "Net/UnrealNetwork.h"
 
 #include "GAEffectField.h"
 
+DEFINE_STAT(STAT_EffectFieldPulse);
+DEFINE_STAT(STAT_EffectFieldApplications);
+DEFINE_STAT(STAT_EffectFieldRemovals);
+
 AGAEffectField::AGAEffectField(const FObjectInitializer& ObjectInitializer)
 : Super(ObjectInitializer)
 {
 	bReplicates = true; 
 	SetReplicates(true);
+	//field doesn't move, clients only need spawn parameters.
+	bReplicateMovement = false;
+	NetUpdateFrequency = 1;
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = false;
+	Radius = 200;
+	PulsePeriod = 0.5f;
+	bApplyEveryPulse = false;
+	bRemoveOnExit = true;
+	AbilityInstigator = nullptr;
+	LastPulseTime = 0;
 }
 
-void AGAEffectField::InitializeField()
+void AGAEffectField::GetLifetimeReplicatedProps(TArray< FLifetimeProperty > & OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+	DOREPLIFETIME_CONDITION(AGAEffectField, bIsFieldPersistent, COND_InitialOnly);
+	DOREPLIFETIME_CONDITION(AGAEffectField, Lifetime, COND_InitialOnly);
+	DOREPLIFETIME_CONDITION(AGAEffectField, Radius, COND_InitialOnly);
+}
+
+void AGAEffectField::BeginPlay()
+{
+	Super::BeginPlay();
+	if (HasAuthority())
+	{
+		InitializeField();
+	}
+}
+
+void AGAEffectField::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
-	//if (bIsFieldPersistent && AbilityInstigator)
-	//{
+	if (HasAuthority() && bRemoveOnExit)
+	{
+		RemoveFromTargets(Inside);
+	}
+	Inside.Reset();
+	Super::EndPlay(EndPlayReason);
+}
 
-	//}
-	//else if (!bIsFieldPersistent && AbilityInstigator)
-	//{
-	//	AbilityInstigator->OnAbilityCastEnd.AddUObject(this, &AGAEffectField::DestroyField);
-	//}
+void AGAEffectField::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+	//tick interval is not exact, and first tick after enabling might come early.
+	if (GetWorld()->GetTimeSeconds() - LastPulseTime >= PulsePeriod - KINDA_SMALL_NUMBER)
+	{
+		Pulse();
+	}
+}
 
-	//1. Automaticallt gather all collision componenets from blueprinted version.
-	// don't want to hardcode any kind of collision inside base class
-	// let designer decide what exactly he wants to do with it.
-	// but on other hand encapsulate this functionality so 
-	// designer won't have to deal with binding/assiging events inside blueprint.
-	//2. Bind Events from them.
+void AGAEffectField::InitializeField()
+{
+	if (bIsFieldPersistent)
+	{
+		if (Lifetime > 0)
+		{
+			SetLifeSpan(Lifetime);
+		}
+	}
+	else if (AbilityInstigator)
+	{
+		AbilityInstigator->OnActivationFinishedDelegate.AddDynamic(this, &AGAEffectField::DestroyField);
+	}
+	if (!Instigator && AbilityInstigator)
+	{
+		Instigator = AbilityInstigator->POwner;
+	}
+	//tick is only used to pulse, interval does the timing.
+	SetActorTickInterval(PulsePeriod);
+	SetActorTickEnabled(true);
+	Pulse();
 }
 
 void AGAEffectField::DestroyField()
 {
+	if (AbilityInstigator)
+	{
+		AbilityInstigator->OnActivationFinishedDelegate.RemoveDynamic(this, &AGAEffectField::DestroyField);
+	}
+	//effects are removed in EndPlay.
+	Destroy();
+}
+
+void AGAEffectField::Pulse()
+{
+	SCOPE_CYCLE_COUNTER(STAT_EffectFieldPulse);
+	LastPulseTime = GetWorld()->GetTimeSeconds();
+	Found.Reset();
+	UAFSpatialIndex::Get()->QueryRadius(GetWorld(), GetActorLocation(), Radius, RequiredTags, Found);
+
+	NewTargets.Reset();
+	NewTargets.Append(Found);
+	Entered.Reset();
+	Exited.Reset();
+	for (int32 Idx = Inside.Num() - 1; Idx >= 0; Idx--)
+	{
+		UAFAbilityComponent* Component = Inside[Idx].Component.Get();
+		if (!Component)
+		{
+			Inside.RemoveAtSwap(Idx, 1, false);
+			continue;
+		}
+		//whatever is left in NewTargets, just entered.
+		if (NewTargets.Remove(Component) == 0)
+		{
+			Exited.Add(Inside[Idx]);
+			Inside.RemoveAtSwap(Idx, 1, false);
+		}
+	}
+	//keep query order.
+	for (UAFAbilityComponent* Component : Found)
+	{
+		if (NewTargets.Contains(Component))
+		{
+			FAFFieldTarget& Target = Entered[Entered.AddDefaulted()];
+			Target.Component = Component;
+		}
+	}
+
+	if (bRemoveOnExit)
+	{
+		RemoveFromTargets(Exited);
+	}
+	if (bApplyEveryPulse)
+	{
+		ApplyToTargets(Inside);
+	}
+	ApplyToTargets(Entered);
+	Inside.Append(Entered);
+}
+
+void AGAEffectField::ApplyToTargets(TArray<FAFFieldTarget>& InTargets)
+{
+	if (!Effect.IsValid() || InTargets.Num() == 0)
+	{
+		return;
+	}
+	FAFFunctionModifier Modifier;
+	for (FAFFieldTarget& Target : InTargets)
+	{
+		UAFAbilityComponent* Component = Target.Component.Get();
+		if (!Component)
+		{
+			continue;
+		}
+		//drop effects which already expired, so list doesn't grow with every pulse.
+		for (int32 Idx = Target.Handles.Num() - 1; Idx >= 0; Idx--)
+		{
+			if (!Component->GameEffectContainer.IsEffectActive(Target.Handles[Idx]))
+			{
+				Target.Handles.RemoveAtSwap(Idx, 1, false);
+			}
+		}
+		FGAEffectHandle Handle = UGABlueprintLibrary::ApplyGameEffectToActor(Effect, Component->GetOwner(), Instigator, this, Modifier);
+		if (!Handle.IsValid())
+		{
+			continue;
+		}
+		INC_DWORD_STAT(STAT_EffectFieldApplications);
+		//instant effects are never active, nothing to remove later.
+		if (Component->GameEffectContainer.IsEffectActive(Handle))
+		{
+			Target.Handles.AddUnique(Handle);
+		}
+	}
+}
 
+void AGAEffectField::RemoveFromTargets(const TArray<FAFFieldTarget>& InTargets)
+{
+	for (const FAFFieldTarget& Target : InTargets)
+	{
+		UAFAbilityComponent* Component = Target.Component.Get();
+		if (!Component)
+		{
+			continue;
+		}
+		for (const FGAEffectHandle& Handle : Target.Handles)
+		{
+			if (!Component->GameEffectContainer.IsEffectActive(Handle))
+			{
+				continue;
+			}
+			Component->RemoveEffect(Effect, Handle.GetContextRef());
+			INC_DWORD_STAT(STAT_EffectFieldRemovals);
+		}
+	}
 }
 
 void AGAEffectField::OnAbilityExecuted_Implementation()
@@ -45,4 +215,4 @@ void AGAEffectField::OnAbilityExecuted_Implementation()
 void AGAEffectField::OnOtherFieldOverlap_Implementation()
 {
 
-}
\ No newline at end of file
+}
@@ -1,6 +1,12 @@
 #pragma once
+#include "GameplayTagContainer.h"
+#include "GAGameEffect.h"
 #include "GAEffectField.generated.h"
 
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Effect Field Pulse"), STAT_EffectFieldPulse, STATGROUP_GameEffect, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Effect Field Applications"), STAT_EffectFieldApplications, STATGROUP_GameEffect, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Effect Field Removals"), STAT_EffectFieldRemovals, STATGROUP_GameEffect, );
+
 /*
 	Base class for effect field.
 	These fields might exist in two states:
@@ -24,6 +30,13 @@
 
 	Need custom K2 Node to properly spawn this actor!. Default SpawnActorFromClass is
 	not sufficient.
+
+	Application:
+	Field pulses every PulsePeriod on server. Pulse queries UAFSpatialIndex for ability components
+	in Radius, diffs them against previous pulse and then applies Effect to everyone who
+	entered (or everyone inside, if bApplyEveryPulse) and removes it from everyone who left,
+	in one pass. There are no per actor overlap events.
+	Only spawn parameters are replicated (once), clients only need them for visuals.
 */
 
 UCLASS(BlueprintType, Blueprintable, DefaultToInstanced)
@@ -35,22 +48,73 @@ public:
 	 *	If false, field will exist only as long as ability is channeled.
 	 *	Otherwise specific life time.
 	 */
-	UPROPERTY(BlueprintReadOnly, meta=(ExposeOnSpawn), Category = "Config")
+	UPROPERTY(BlueprintReadOnly, Replicated, meta=(ExposeOnSpawn), Category = "Config")
 		bool bIsFieldPersistent;
 	
 	/**
 	 *	How long this field will live in world ?
 	 *	Only applicable if bIsFieldPersistent = true;
+	 *	0 - until destroyed.
 	 */
-	UPROPERTY(BlueprintReadOnly, meta = (ExposeOnSpawn), Category = "Config")
+	UPROPERTY(BlueprintReadOnly, Replicated, meta = (ExposeOnSpawn), Category = "Config")
 		float Lifetime;
 
-	//UPROPERTY(BlueprintReadOnly, Category = "Owner")
-	//class AGASAbility* AbilityInstigator;
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Replicated, meta = (ExposeOnSpawn), Category = "Config")
+		float Radius;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Config")
+		float PulsePeriod;
+
+	/* Applied to ability components inside field. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Config")
+		FGAEffectProperty Effect;
+
+	/* Only targets with all of these tags are affected. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Config")
+		FGameplayTagContainer RequiredTags;
+
+	/* If true Effect is applied to everyone inside, every pulse (ie. instant damage). Otherwise only on enter. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Config")
+		bool bApplyEveryPulse;
+
+	/* If true Effect is removed from targets which left field, or when field is destroyed. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Config")
+		bool bRemoveOnExit;
+
+	/* Non persistent field is destroyed when activation of this ability finishes. */
+	UPROPERTY(BlueprintReadOnly, meta = (ExposeOnSpawn), Category = "Owner")
+		class UGAAbilityBase* AbilityInstigator;
+
+protected:
+	struct FAFFieldTarget
+	{
+		TWeakObjectPtr<class UAFAbilityComponent> Component;
+		/* Active effects applied by this field, one per pulse with bApplyEveryPulse. */
+		TArray<FGAEffectHandle, TInlineAllocator<1>> Handles;
+	};
+	float LastPulseTime;
+	/* Targets inside after last pulse. */
+	TArray<FAFFieldTarget> Inside;
+	/* Scratch, reused every pulse. */
+	TArray<class UAFAbilityComponent*> Found;
+	TSet<class UAFAbilityComponent*> NewTargets;
+	TArray<FAFFieldTarget> Entered;
+	TArray<FAFFieldTarget> Exited;
+
+public:
+	virtual void GetLifetimeReplicatedProps(TArray< FLifetimeProperty > & OutLifetimeProps) const override;
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	virtual void Tick(float DeltaSeconds) override;
 
 	void InitializeField();
 
-	void DestroyField();
+	UFUNCTION(BlueprintCallable, Category = "Ability Field")
+		void DestroyField();
+
+	void Pulse();
+	void ApplyToTargets(TArray<FAFFieldTarget>& InTargets);
+	void RemoveFromTargets(const TArray<FAFFieldTarget>& InTargets);
 
 	UFUNCTION(BlueprintNativeEvent, Category = "Ability Field")
 		void OnAbilityExecuted();
@@ -13,43 +13,17 @@ float FGADirectModifier::GetValue() { return Value; }
 float FGADirectModifier::GetValue() const { return Value; }
 float FGAAttributeBasedModifier::GetValue(const FGAEffectContext& Context)
 {
-	FAFAttributeBase* attr = nullptr;
-	float Result = 0;
-	switch (Source)
-	{
-	case EGAAttributeSource::Instigator:
-	{
-		IAFAbilityInterface* AttrInt = Cast<IAFAbilityInterface>(Context.Instigator.Get());
-		UGAAttributesBase* Attributes = AttrInt->GetAttributes();
-		attr = Attributes->GetAttribute(Attribute);
-		//attr = Context.InstigatorComp->GetAttribute(Attribute);
-		break;
-	}
-	case EGAAttributeSource::Target:
-	{
-		IAFAbilityInterface* AttrInt = Cast<IAFAbilityInterface>(Context.Target.Get());
-		UGAAttributesBase* Attributes = AttrInt->GetAttributes();// nullptr;
-		attr = Attributes->GetAttribute(Attribute);//Context.TargetComp->GetAttribute(Attribute);
-		break;
-	}
-	case EGAAttributeSource::Causer:
-	{
-		IAFAbilityInterface* AttrInt = Cast<IAFAbilityInterface>(Context.Causer.Get());
-		UGAAttributesBase* Attributes = AttrInt->GetAttributes();// nullptr;
-		attr = Attributes->GetAttribute(Attribute);//Context.TargetComp->GetAttribute(Attribute);
-		break;
-	}
-	default:
-		return 0;
-	}
-	Result = (Coefficient * (PreMultiply + attr->GetFinalValue()) + PostMultiply) * PostCoefficient;
-	if (!bUseSecondaryAttribute)
-		return Result;
-
-	return 0;
+	return static_cast<const FGAAttributeBasedModifier*>(this)->GetValue(Context);
 }
 float FGAAttributeBasedModifier::GetValue(const FGAEffectContext& Context) const
 {
+	if (bUseSecondaryAttribute)
+		return 0;
+	//captured when effect was applied.
+	if (const float* Captured = Context.Snapshot.Find(Source, Attribute.AttributeName))
+	{
+		return (Coefficient * (PreMultiply + *Captured) + PostMultiply) * PostCoefficient;
+	}
 	FAFAttributeBase* attr = nullptr;
 	float Result = 0;
 	
@@ -89,6 +63,14 @@ float FGAAttributeBasedModifier::GetValue(const FGAEffectContext& Context) const
 
 float FGACurveBasedModifier::GetValue(const FGAEffectContext& ContextIn)
 {
+	return static_cast<const FGACurveBasedModifier*>(this)->GetValue(ContextIn);
+}
+float FGACurveBasedModifier::GetValue(const FGAEffectContext& ContextIn) const
+{
+	if (const float* Captured = ContextIn.Snapshot.Find(Source, Attribute.AttributeName))
+	{
+		return EvalCurve(*Captured);
+	}
 	FAFAttributeBase* attr = nullptr;
 	float Result = 0;
 	switch (Source)
@@ -102,29 +84,138 @@ float FGACurveBasedModifier::GetValue(const FGAEffectContext& ContextIn)
 	default:
 		return 0;
 	}
-	FString ContextString(TEXT("Evaluating modifier value."));
-	Result = CurveTable.Eval(attr->GetFinalValue(), ContextString);
+	Result = EvalCurve(attr->GetFinalValue());
 	return Result;
 }
-float FGACurveBasedModifier::GetValue(const FGAEffectContext& ContextIn) const
+float FGACurveBasedModifier::EvalCurve(float InValue) const
 {
-	FAFAttributeBase* attr = nullptr;
-	float Result = 0;
-	switch (Source)
+	if (BakedCurve.IsBaked())
 	{
-	case EGAAttributeSource::Instigator:
-		attr = ContextIn.InstigatorComp->GetAttribute(Attribute);
-		break;
-	case EGAAttributeSource::Target:
-		attr = ContextIn.TargetComp->GetAttribute(Attribute);
-		break;
-	default:
-		return 0;
+		return BakedCurve.Eval(InValue);
 	}
+	//never bake here, magnitudes can be evaluated from worker threads.
 	FString ContextString(TEXT("Evaluating modifier value."));
-	Result = CurveTable.Eval(attr->GetFinalValue(), ContextString);
-	return Result;
+	return CurveTable.Eval(InValue, ContextString);
+}
+void FGACurveBasedModifier::BakeCurve()
+{
+	BakedCurve = FAFBakedCurve();
+	if (CurveTable.IsNull())
+	{
+		return;
+	}
+	FRichCurve* Curve = CurveTable.GetRichCurve(TEXT("Baking curve modifier."), false);
+	if (Curve)
+	{
+		BakedCurve.Bake(*Curve, BakeSamples);
+	}
+}
+#if WITH_EDITOR
+bool FGACurveBasedModifier::ValidateBakedCurve(FString& OutError) const
+{
+	if (CurveTable.IsNull())
+	{
+		return true;
+	}
+	FRichCurve* Curve = CurveTable.GetRichCurve(TEXT("Validating baked curve modifier."), false);
+	if (!Curve)
+	{
+		OutError = FString::Printf(TEXT("Curve row %s not found"), *CurveTable.RowName.ToString());
+		return false;
+	}
+	const float Error = BakedCurve.GetMaxError(*Curve);
+	if (Error > MaxBakeError)
+	{
+		OutError = FString::Printf(TEXT("Baked curve %s error %f is bigger than allowed %f. Increase BakeSamples."),
+			*CurveTable.RowName.ToString(), Error, MaxBakeError);
+		return false;
+	}
+	return true;
+}
+#endif //WITH_EDITOR
+
+void FAFBakedCurve::Bake(const FRichCurve& InCurve, int32 InNumSamples)
+{
+	Samples.Reset();
+	if (InCurve.GetNumKeys() == 0)
+	{
+		return;
+	}
+	InCurve.GetTimeRange(MinTime, MaxTime);
+	PreInfinityExtrap = InCurve.PreInfinityExtrap;
+	PostInfinityExtrap = InCurve.PostInfinityExtrap;
+	//single key curve is constant, whatever extrapolation says.
+	if (FMath::IsNearlyEqual(MinTime, MaxTime))
+	{
+		InvStep = 0;
+		Samples.Add(InCurve.Eval(MinTime));
+		return;
+	}
+	//curve is linear outside of it's keys, so one unit is enough to get slope.
+	PreSlope = InCurve.Eval(MinTime) - InCurve.Eval(MinTime - 1.0f);
+	PostSlope = InCurve.Eval(MaxTime + 1.0f) - InCurve.Eval(MaxTime);
+	const int32 NumSamples = FMath::Max(InNumSamples, 2);
+	const float Step = (MaxTime - MinTime) / (float)(NumSamples - 1);
+	InvStep = 1.0f / Step;
+	Samples.AddUninitialized(NumSamples);
+	for (int32 Idx = 0; Idx < NumSamples; Idx++)
+	{
+		Samples[Idx] = InCurve.Eval(MinTime + Step * Idx);
+	}
 }
+float FAFBakedCurve::GetMaxError(const FRichCurve& InCurve) const
+{
+	if (!IsBaked())
+	{
+		return InCurve.GetNumKeys() > 0 ? MAX_flt : 0;
+	}
+	//check in between samples, that's where lerp differs from curve.
+	//also one range before and after keys, to catch extrapolation differences.
+	const int32 SubSamples = 4;
+	const int32 NumChecks = FMath::Max(Samples.Num() - 1, 1) * SubSamples;
+	const float Range = FMath::Max(MaxTime - MinTime, 1.0f);
+	const float Step = Range / (float)NumChecks;
+	const float StartTime = MinTime - Range;
+	float MaxError = 0;
+	for (int32 Idx = 0; Idx <= NumChecks * 3; Idx++)
+	{
+		const float Time = StartTime + Step * Idx;
+		MaxError = FMath::Max(MaxError, FMath::Abs(Eval(Time) - InCurve.Eval(Time)));
+	}
+	return MaxError;
+}
+float FAFBakedCurve::EvalExtrapolated(float InTime) const
+{
+	const bool bPre = InTime < MinTime;
+	const ERichCurveExtrapolation Extrap = bPre ? PreInfinityExtrap.GetValue() : PostInfinityExtrap.GetValue();
+	switch (Extrap)
+	{
+	case RCCE_Linear:
+		return bPre ? Samples[0] - (MinTime - InTime) * PreSlope
+			: Samples.Last() + (InTime - MaxTime) * PostSlope;
+	case RCCE_Cycle:
+	case RCCE_CycleWithOffset:
+	case RCCE_Oscillate:
+	{
+		const float Range = MaxTime - MinTime;
+		const float Cycle = FMath::FloorToFloat((InTime - MinTime) / Range);
+		float Time = InTime - Cycle * Range;
+		if (Extrap == RCCE_Oscillate)
+		{
+			if (FMath::Abs(FMath::Fmod(Cycle, 2.0f)) > 0.5f)
+			{
+				Time = MaxTime - (Time - MinTime);
+			}
+			return EvalInRange(Time);
+		}
+		const float Offset = Extrap == RCCE_CycleWithOffset ? Cycle * (Samples.Last() - Samples[0]) : 0;
+		return EvalInRange(Time) + Offset;
+	}
+	default:
+		return bPre ? Samples[0] : Samples.Last();
+	}
+}
+
 float FGACustomCalculationModifier::GetValue(const struct FGAEffectHandle& HandleIn)
 {
 	if (CustomCalculation)
@@ -140,4 +231,22 @@ float FGACustomCalculationModifier::GetValue(const struct FGAEffectHandle& Handl
 		return CustomCalculation->NativeCalculateMagnitude(HandleIn);
 	}
 	return 0;
+}
+float FGACustomCalculationModifier::GetValue(const struct FGAEffectHandle& HandleIn, const FGAEffectContext& InContext) const
+{
+	if (CustomCalculation)
+	{
+		return CustomCalculation->NativeCalculateMagnitudeFromContext(HandleIn, InContext);
+	}
+	return 0;
+}
+void FGACustomCalculationModifier::GetValues(const TArray<struct FGAEffectHandle>& InHandles,
+	const TArray<const FGAEffectContext*>& InContexts, TArray<float>& OutValues) const
+{
+	if (CustomCalculation)
+	{
+		CustomCalculation->NativeCalculateMagnitudes(InHandles, InContexts, OutValues);
+		return;
+	}
+	OutValues.SetNumZeroed(InContexts.Num());
 }
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include "../Attributes/GAAttributeGlobals.h"
 #include "GameplayTagContainer.h"
 #include "../GAGlobalTypes.h"
+#include "Curves/RichCurve.h"
 #include "GAEffectGlobalTypes.generated.h"
 
 
@@ -109,6 +110,73 @@ public:
 	float GetValue(const FGAEffectContext& Context);
 	float GetValue(const FGAEffectContext& Context) const;
 };
+/*
+	Curve sampled into uniform table. Evaluating it is just lerp between two samples,
+	without looking up row in curve table and without allocations.
+	Outside of sampled range it follows pre/post extrapolation of source curve.
+*/
+USTRUCT()
+struct ABILITYFRAMEWORK_API FAFBakedCurve
+{
+	GENERATED_USTRUCT_BODY()
+public:
+	UPROPERTY()
+		TArray<float> Samples;
+	UPROPERTY()
+		float MinTime;
+	UPROPERTY()
+		float MaxTime;
+	/* Number of samples per one unit of time. */
+	UPROPERTY()
+		float InvStep;
+	UPROPERTY()
+		TEnumAsByte<ERichCurveExtrapolation> PreInfinityExtrap;
+	UPROPERTY()
+		TEnumAsByte<ERichCurveExtrapolation> PostInfinityExtrap;
+	/* Change of value per unit of time, for linear extrapolation. */
+	UPROPERTY()
+		float PreSlope;
+	UPROPERTY()
+		float PostSlope;
+
+	FAFBakedCurve()
+		: MinTime(0),
+		MaxTime(0),
+		InvStep(0),
+		PreInfinityExtrap(RCCE_Constant),
+		PostInfinityExtrap(RCCE_Constant),
+		PreSlope(0),
+		PostSlope(0)
+	{}
+
+	inline bool IsBaked() const { return Samples.Num() > 0; }
+	inline float Eval(float InTime) const
+	{
+		const int32 LastIdx = Samples.Num() - 1;
+		if (LastIdx <= 0)
+		{
+			return LastIdx == 0 ? Samples[0] : 0;
+		}
+		if (InTime < MinTime || InTime > MaxTime)
+		{
+			return EvalExtrapolated(InTime);
+		}
+		return EvalInRange(InTime);
+	}
+	void Bake(const FRichCurve& InCurve, int32 InNumSamples);
+	/* Biggest absolute difference between table and source curve, including extrapolated ranges. */
+	float GetMaxError(const FRichCurve& InCurve) const;
+protected:
+	inline float EvalInRange(float InTime) const
+	{
+		const int32 LastIdx = Samples.Num() - 1;
+		const float Pos = FMath::Clamp((InTime - MinTime) * InvStep, 0.0f, (float)LastIdx);
+		const int32 Idx = FMath::Min((int32)Pos, LastIdx - 1);
+		return FMath::Lerp(Samples[Idx], Samples[Idx + 1], Pos - (float)Idx);
+	}
+	float EvalExtrapolated(float InTime) const;
+};
+
 //EGAMagnitudeCalculation::CurveBased
 USTRUCT(BlueprintType)
 struct FGACurveBasedModifier
@@ -130,9 +198,40 @@ public:
 	*/
 	UPROPERTY(EditAnywhere)
 		FCurveTableRowHandle CurveTable;
+	/*
+	How many samples are taken from curve, when it is baked into table.
+	*/
+	UPROPERTY(EditAnywhere, AdvancedDisplay, meta = (ClampMin = "2"))
+		int32 BakeSamples;
+	/*
+	Max allowed difference between baked table and source curve.
+	If it is bigger, you will get warning in editor and should increase BakeSamples.
+	*/
+	UPROPERTY(EditAnywhere, AdvancedDisplay)
+		float MaxBakeError;
+
+	/* Baked only on game thread (load, save, edit, property initialization), read only during evaluation. */
+	UPROPERTY()
+		FAFBakedCurve BakedCurve;
+
+	FGACurveBasedModifier()
+		: Source(EGAAttributeSource::Instigator),
+		BakeSamples(64),
+		MaxBakeError(0.01f)
+	{}
+
+	/* Rebakes table from current curve. */
+	void BakeCurve();
+	inline bool UsesCurveTable(const UCurveTable* InTable) const { return InTable && CurveTable.CurveTable == InTable; }
+#if WITH_EDITOR
+	bool ValidateBakedCurve(FString& OutError) const;
+#endif //WITH_EDITOR
 
 	float GetValue(const FGAEffectContext& ContextIn);
 	float GetValue(const FGAEffectContext& ContextIn) const;
+protected:
+	/* Evaluates source curve if table isn't baked (ie. curve missing). */
+	float EvalCurve(float InValue) const;
 };
 //EGAMagnitudeCalculation::CustomCalculation
 USTRUCT(BlueprintType)
@@ -152,4 +251,7 @@ public:
 
 	float GetValue(const struct FGAEffectHandle& HandleIn);
 	float GetValue(const struct FGAEffectHandle& HandleIn) const;
+	float GetValue(const struct FGAEffectHandle& HandleIn, const FGAEffectContext& InContext) const;
+	void GetValues(const TArray<struct FGAEffectHandle>& InHandles,
+		const TArray<const FGAEffectContext*>& InContexts, TArray<float>& OutValues) const;
 };
\ No newline at end of file
@@ -9,10 +9,12 @@
 #include "../AFAbilityComponent.h"
 #include "GAEffectExecution.h"
 #include "GAEffectExtension.h"
+#include "AFEffectExtensionPool.h"
 #include "../GAGlobalTypes.h"
 #include "AFEffectApplicationRequirement.h"
 #include "AFEffectCustomApplication.h"
 #include "GAGameEffect.h"
+#include "../AFCueReplication.h"
 
 DEFINE_STAT(STAT_GatherModifiers);
 
@@ -21,6 +23,11 @@ void FGAEffectProperty::Initialize()
 	if (SpecClass.SpecClass)
 	{
 		Spec = SpecClass.SpecClass->GetDefaultObject<UGAGameEffectSpec>();
+		//specs created at runtime are never loaded, bake them before anything evaluates them.
+		if (IsInGameThread())
+		{
+			Spec->BakeCurves(true);
+		}
 		ApplicationRequirement = GetSpec()->ApplicationRequirement.GetDefaultObject();
 		Application = GetSpec()->Application.GetDefaultObject();
 		Execution = GetSpec()->ExecutionType.GetDefaultObject();
@@ -50,11 +57,19 @@ void FAFEffectRepInfo::OnRemoved()
 void FAFEffectRepInfo::PreReplicatedRemove(const struct FGAEffectContainer& InArraySerializer)
 {
 	InArraySerializer.EffectInfos.Remove(Handle);
+	if (const FAFEffectRepInfoDelegate* Listeners = InArraySerializer.RepInfoListeners.Find(EffectClass))
+	{
+		Listeners->Broadcast(*this, true);
+	}
 	InArraySerializer.OwningComponent->OnEffectRepInfoRemoved.Broadcast(this);
 }
 void FAFEffectRepInfo::PostReplicatedAdd(const struct FGAEffectContainer& InArraySerializer)
 {
 	InArraySerializer.EffectInfos.Add(Handle, this);
+	if (const FAFEffectRepInfoDelegate* Listeners = InArraySerializer.RepInfoListeners.Find(EffectClass))
+	{
+		Listeners->Broadcast(*this, false);
+	}
 	InArraySerializer.OwningComponent->OnEffectRepInfoApplied.Broadcast(this);
 }
 void FAFEffectRepInfo::PostReplicatedChange(const struct FGAEffectContainer& InArraySerializer)
@@ -79,7 +94,8 @@ float FGAMagnitude::GetFloatValue(const FGAEffectContext& Context)
 	}
 	case EGAMagnitudeCalculation::CustomCalculation:
 	{
-		//return  Custom.GetValue(*this);
+		//there is no effect yet when magnitude is evaluated from context.
+		return Custom.GetValue(FGAEffectHandle(), Context);
 	}
 	default:
 		return 0;
@@ -87,30 +103,83 @@ float FGAMagnitude::GetFloatValue(const FGAEffectContext& Context)
 
 	return 0;
 }
+void FGAMagnitude::GetFloatValues(const TArray<FGAEffectHandle>& InHandles,
+	const TArray<const FGAEffectContext*>& InContexts, TArray<float>& OutValues)
+{
+	check(InHandles.Num() == InContexts.Num());
+	if (CalculationType == EGAMagnitudeCalculation::CustomCalculation)
+	{
+		Custom.GetValues(InHandles, InContexts, OutValues);
+		return;
+	}
+	const int32 Num = InContexts.Num();
+	OutValues.SetNumUninitialized(Num, false);
+	for (int32 Idx = 0; Idx < Num; Idx++)
+	{
+		OutValues[Idx] = GetFloatValue(*InContexts[Idx]);
+	}
+}
+void FGAMagnitude::BakeCurves(bool bInOnlyMissing)
+{
+	if (CalculationType != EGAMagnitudeCalculation::CurveBased)
+		return;
+	if (bInOnlyMissing && CurveBased.BakedCurve.IsBaked())
+		return;
+
+	CurveBased.BakeCurve();
+}
+bool FGAMagnitude::UsesCurveTable(const UCurveTable* InTable) const
+{
+	return CalculationType == EGAMagnitudeCalculation::CurveBased && CurveBased.UsesCurveTable(InTable);
+}
+void FGAMagnitude::CaptureAttributes(FGAEffectContext& InContext) const
+{
+	switch (CalculationType)
+	{
+	case EGAMagnitudeCalculation::AttributeBased:
+		if (AttributeBased.Attribute.IsValid())
+			InContext.CaptureAttribute(AttributeBased.Source, AttributeBased.Attribute);
+		break;
+	case EGAMagnitudeCalculation::CurveBased:
+		if (CurveBased.Attribute.IsValid())
+			InContext.CaptureAttribute(CurveBased.Source, CurveBased.Attribute);
+		break;
+	default:
+		break;
+	}
+}
 FGAEffect::FGAEffect(class UGAGameEffectSpec* GameEffectIn,
 	const FGAEffectContext& ContextIn)
+	: FGAEffect(GameEffectIn, FAFContextHandle::Generate(ContextIn))
+{
+}
+FGAEffect::FGAEffect(class UGAGameEffectSpec* GameEffectIn,
+	const FAFContextHandle& ContextIn)
 	: GameEffect(GameEffectIn),
 	Context(ContextIn)
 {
 	OwnedTags = GameEffectIn->OwnedTags;
-	if (GameEffect->Extension)
-	{
-		Extension = NewObject<UGAEffectExtension>(Context.Target.Get(), GameEffect->Extension);
-		Extension->OwningComponent = Context.TargetComp.Get();
-	}
-	if (ContextIn.TargetComp.IsValid())
+	TargetWorld = nullptr;
+	if (Context->TargetComp.IsValid())
 	{
-		TargetWorld = ContextIn.TargetComp->GetWorld();
+		TargetWorld = Context->TargetComp->GetWorld();
 		AppliedTime = TargetWorld->TimeSeconds;
 		LastTickTime = TargetWorld->TimeSeconds;
 	}
-	else if (ContextIn.InstigatorComp.IsValid())
+	else if (Context->InstigatorComp.IsValid())
 	{
-		TargetWorld = ContextIn.InstigatorComp->GetWorld();
+		TargetWorld = Context->InstigatorComp->GetWorld();
 		AppliedTime = TargetWorld->TimeSeconds;
 		LastTickTime = TargetWorld->TimeSeconds;
 	}
+	if (GameEffect->Extension && TargetWorld)
+	{
+		Extension = UAFEffectExtensionPool::Get()->Acquire(TargetWorld, GameEffect->Extension);
+		Extension->OwningComponent = Context->TargetComp.Get();
+		Extension->SetParameters(Context);
+	}
 	IsActive = false;
+	bCuesActive = false;
 }
 
 float FAFStatics::GetFloatFromAttributeMagnitude(const FGAMagnitude& AttributeIn
@@ -133,7 +202,7 @@ float FAFStatics::GetFloatFromAttributeMagnitude(const FGAMagnitude& AttributeIn
 	}
 	case EGAMagnitudeCalculation::CustomCalculation:
 	{
-		return AttributeIn.Custom.GetValue(InHandle);
+		return AttributeIn.Custom.GetValue(InHandle, InContext);
 	}
 	default:
 		break;
@@ -171,7 +240,7 @@ FGAEffectMod FAFStatics::GetAttributeModifier(FGAAttributeModifier& ModInfoIn
 		case EGAMagnitudeCalculation::CustomCalculation:
 		{
 			return FGAEffectMod(ModInfoIn.Attribute,
-				ModInfoIn.Magnitude.Custom.GetValue(InHandle), ModInfoIn.AttributeMod, InHandle, InSpec->AttributeTags);
+				ModInfoIn.Magnitude.Custom.GetValue(InHandle, InContext), ModInfoIn.AttributeMod, InHandle, InSpec->AttributeTags);
 
 		}
 		default:
@@ -184,13 +253,21 @@ FGAEffect::~FGAEffect()
 {
 	if (Extension.IsValid())
 	{
-		Extension->MarkPendingKill();
+		UAFEffectExtensionPool::Get()->Release(Extension.Get());
 		Extension.Reset();
 	}
 }
 void FGAEffect::SetContext(const FGAEffectContext& ContextIn)
+{
+	SetContext(FAFContextHandle::Generate(ContextIn));
+}
+void FGAEffect::SetContext(const FAFContextHandle& ContextIn)
 {
 	Context = ContextIn;
+	if (Extension.IsValid())
+	{
+		Extension->SetParameters(Context);
+	}
 }
 
 void FGAEffect::OnApplied()
@@ -236,6 +313,69 @@ void FGAEffect::DurationExpired()
 {
 
 }
+FGAEffectCueParams FGAEffect::MakeCueParams() const
+{
+	FGAEffectCueParams CueParams;
+	if (Context.IsValid())
+	{
+		const FGAEffectContext& EffectContext = Context.GetRef();
+		CueParams = FGAEffectCueParams(EffectContext.HitResult, EffectContext.Instigator.Get(), EffectContext.Causer.Get());
+		//applied directly to actor, there is no hit to place cue at.
+		if (!EffectContext.HitResult.bBlockingHit)
+		{
+			CueParams.HitResult.Location = EffectContext.TargetHitLocation;
+			CueParams.HitResult.ImpactPoint = EffectContext.TargetHitLocation;
+			CueParams.HitResult.Actor = Cast<AActor>(EffectContext.Target.Get());
+		}
+	}
+	if (GameEffect)
+	{
+		CueParams.CueTags = GameEffect->Cues.CueTags;
+	}
+	return CueParams;
+}
+void FGAEffect::InitializeTimerRecord(const FGAEffectProperty& InProperty, const FAFFunctionModifier& InModifier)
+{
+	TimerRecord.Initialize(InProperty, InModifier);
+}
+void FGAEffect::OnPeriodTimer()
+{
+	if (UAFAbilityComponent* TargetComp = GetTargetComp())
+	{
+		FGAEffectProperty Property;
+		TimerRecord.MakeProperty(Property);
+		TargetComp->ExecuteEffect(Handle, Property, TimerRecord.Modifier, Context.GetRef());
+	}
+}
+void FGAEffect::OnDurationTimer()
+{
+	if (UAFAbilityComponent* TargetComp = GetTargetComp())
+	{
+		FGAEffectProperty Property;
+		TimerRecord.MakeProperty(Property);
+		TargetComp->ExpireEffect(Handle, Property, Context.GetRef());
+	}
+}
+
+void FAFEffectTimerRecord::Initialize(const FGAEffectProperty& InProperty, const FAFFunctionModifier& InModifier)
+{
+	Spec = InProperty.Spec;
+	Modifier = InModifier;
+	Duration = InProperty.Duration;
+	Period = InProperty.Period;
+}
+void FAFEffectTimerRecord::MakeProperty(FGAEffectProperty& OutProperty) const
+{
+	if (!Spec)
+		return;
+	OutProperty.SpecClass.SpecClass = Spec->GetClass();
+	OutProperty.Spec = Spec;
+	OutProperty.ApplicationRequirement = Spec->ApplicationRequirement.GetDefaultObject();
+	OutProperty.Application = Spec->Application.GetDefaultObject();
+	OutProperty.Execution = Spec->ExecutionType.GetDefaultObject();
+	OutProperty.Duration = Duration;
+	OutProperty.Period = Period;
+}
 
 float FGAEffect::GetDurationTime() const
 {
@@ -255,15 +395,15 @@ float FGAEffect::GetFloatFromAttributeMagnitude(const FGAMagnitude& AttributeIn)
 	}
 	case EGAMagnitudeCalculation::AttributeBased:
 	{
-		return AttributeIn.AttributeBased.GetValue(Context);
+		return AttributeIn.AttributeBased.GetValue(Context.GetRef());
 	}
 	case EGAMagnitudeCalculation::CurveBased:
 	{
-		return AttributeIn.CurveBased.GetValue(Context);
+		return AttributeIn.CurveBased.GetValue(Context.GetRef());
 	}
 	case EGAMagnitudeCalculation::CustomCalculation:
 	{
-		return AttributeIn.Custom.GetValue(Handle);
+		return AttributeIn.Custom.GetValue(Handle, Context.GetRef());
 	}
 	default:
 		break;
@@ -316,6 +456,7 @@ FGAEffectHandle FGAEffectContainer::ApplyEffect(FGAEffect* EffectIn, FGAEffectPr
 	if (bHasDuration || bHasPeriod)
 	{
 		Handle = FGAEffectHandle::GenerateHandle(EffectIn);
+		EffectIn->InitializeTimerRecord(InProperty, Modifier);
 	}
 	if (InProperty.ApplicationRequirement->CanApply(EffectIn, InProperty, this, InContext, Handle))
 	{
@@ -328,6 +469,7 @@ FGAEffectHandle FGAEffectContainer::ApplyEffect(FGAEffect* EffectIn, FGAEffectPr
 				{
 					Handle = InProperty.Handle;
 					InProperty.Application->ExecuteEffect(InProperty.Handle, InProperty, InContext, Modifier);
+					ExecuteEffectCues(EffectIn, InProperty, false);
 					//	UE_LOG(GameAttributes, Log, TEXT("FGAEffectContainer::EffectApplied %s"), *HandleIn.GetEffectSpec()->GetName() );
 				}
 			}
@@ -340,6 +482,7 @@ FGAEffectHandle FGAEffectContainer::ApplyEffect(FGAEffect* EffectIn, FGAEffectPr
 					EffectIn, InProperty, this, InContext))
 				{
 					InProperty.Application->ExecuteEffect(Handle, InProperty, InContext, Modifier);
+					ExecuteEffectCues(EffectIn, InProperty, false);
 					//	UE_LOG(GameAttributes, Log, TEXT("FGAEffectContainer::EffectApplied %s"), *HandleIn.GetEffectSpec()->GetName() );
 				}
 			}
@@ -353,6 +496,7 @@ FGAEffectHandle FGAEffectContainer::ApplyEffect(FGAEffect* EffectIn, FGAEffectPr
 			{
 				InProperty.Application->ExecuteEffect(Handle, InProperty, InContext, Modifier);
 				ApplyReplicationInfo(Handle, InProperty);
+				ExecuteEffectCues(EffectIn, InProperty, true);
 				//	UE_LOG(GameAttributes, Log, TEXT("FGAEffectContainer::EffectApplied %s"), *HandleIn.GetEffectSpec()->GetName() );
 			}
 			
@@ -376,6 +520,7 @@ void FGAEffectContainer::ApplyReplicationInfo(const FGAEffectHandle& InHandle, c
 		const UWorld* World = OwningComponent->GetWorld();
 		FAFEffectRepInfo RepInfo(World->GetTimeSeconds(), InProperty.Period, InProperty.Duration, 0);
 		RepInfo.Handle = InHandle;
+		RepInfo.EffectClass = InProperty.GetClass();
 		MarkItemDirty(RepInfo);
 		ActiveEffectInfos.Add(RepInfo);
 		MarkArrayDirty();
@@ -387,6 +532,33 @@ void FGAEffectContainer::ApplyReplicationInfo(const FGAEffectHandle& InHandle, c
 	}
 }
 
+void FGAEffectContainer::ExecuteEffectCues(FGAEffect* InEffect, const FGAEffectProperty& InProperty, bool bInPersistent)
+{
+	if (!InEffect || !InEffect->GameEffect || InEffect->GameEffect->Cues.CueTags.Num() == 0 || !OwningComponent)
+	{
+		return;
+	}
+	//clients get cues from server.
+	if (OwningComponent->GetNetMode() == NM_Client)
+	{
+		return;
+	}
+	FGAEffectCueParams CueParams = InEffect->MakeCueParams();
+	CueParams.Period = InProperty.Period;
+	CueParams.Duration = InProperty.Duration;
+	UAFCueReplicationComponent::ExecuteCue(OwningComponent->GetWorld(), CueParams.CueTags, CueParams, false);
+	InEffect->bCuesActive = bInPersistent;
+}
+void FGAEffectContainer::RemoveEffectCues(FGAEffect* InEffect)
+{
+	if (!InEffect || !InEffect->bCuesActive || !OwningComponent)
+	{
+		return;
+	}
+	InEffect->bCuesActive = false;
+	FGAEffectCueParams CueParams = InEffect->MakeCueParams();
+	UAFCueReplicationComponent::RemoveCue(OwningComponent->GetWorld(), CueParams.CueTags, CueParams);
+}
 EGAEffectAggregation FGAEffectContainer::GetEffectAggregation(const FGAEffectHandle& HandleIn) const
 {
 	UGAGameEffectSpec* Spec = HandleIn.GetEffectSpec();
@@ -545,9 +717,10 @@ void FGAEffectContainer::RemoveInstigatorEffect(const FGAEffectHandle& HandleIn
 	}
 	if (Effect.IsValid())
 	{
+		RemoveEffectCues(Effect.Get());
 		Effect->OnEffectRemoved.Broadcast(Effect->Handle);
 		Target->RemoveTagContainer(Effect->ApplyTags);
-		FTimerManager& DurationTimer = Effect->Context.TargetComp->GetWorld()->GetTimerManager();
+		FTimerManager& DurationTimer = Effect->Context->TargetComp->GetWorld()->GetTimerManager();
 		DurationTimer.ClearTimer(Effect->DurationTimerHandle);
 		DurationTimer.ClearTimer(Effect->PeriodTimerHandle);
 	}
@@ -561,6 +734,13 @@ void FGAEffectContainer::RemoveEffectByHandle(const FGAEffectHandle& InHandle, c
 	EGAEffectAggregation Aggregation = Spec->EffectAggregation;
 	//TSet<FGAEffectHandle>* handles = EffectByClass.Find(FObjectKey(HandleIn.GetClass()));//GetHandlesByClass(HandleIn, InContext);
 
+	FAFEffectRepInfo* Out = nullptr;
+	EffectInfos.RemoveAndCopyValue(InHandle, Out);
+	if (Out)
+	{
+		ActiveEffectInfos.Remove(*Out);
+		delete Out;
+	}
 	if (!ActiveEffectHandles.Contains(InHandle))
 	{
 		UE_LOG(GameAttributes, Log, TEXT("RemoveEffect Effect %s Is not applied"), *InHandle.GetEffectRef().ToString());
@@ -604,9 +784,10 @@ void FGAEffectContainer::RemoveTargetEffect(const FGAEffectHandle& HandleIn
 	RemoveEffectProtected(HandleIn, InProperty);
 	if (Effect.IsValid())
 	{
+		RemoveEffectCues(Effect.Get());
 		Effect->OnEffectRemoved.Broadcast(Effect->Handle);
 		Target->RemoveTagContainer(Effect->ApplyTags);
-		FTimerManager& DurationTimer = Effect->Context.TargetComp->GetWorld()->GetTimerManager();
+		FTimerManager& DurationTimer = Effect->Context->TargetComp->GetWorld()->GetTimerManager();
 		DurationTimer.ClearTimer(Effect->DurationTimerHandle);
 		DurationTimer.ClearTimer(Effect->PeriodTimerHandle);
 	}
@@ -706,4 +887,103 @@ UGAGameEffectSpec::UGAGameEffectSpec()
 	ExecutionType = UGAEffectExecution::StaticClass();
 	ApplicationRequirement = UAFEffectApplicationRequirement::StaticClass();
 	Application = UAFEffectCustomApplication::StaticClass();
-}
\ No newline at end of file
+	AttributeCapture = EAFAttributeCapture::Live;
+}
+void UGAGameEffectSpec::PostLoad()
+{
+	Super::PostLoad();
+	BakeCurves();
+}
+void UGAGameEffectSpec::PreSave(const class ITargetPlatform* TargetPlatform)
+{
+	Super::PreSave(TargetPlatform);
+	BakeCurves();
+#if WITH_EDITOR
+	ValidateBakedCurves();
+#endif //WITH_EDITOR
+}
+#if WITH_EDITOR
+void UGAGameEffectSpec::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+	BakeCurves();
+	ValidateBakedCurves();
+}
+#endif //WITH_EDITOR
+void UGAGameEffectSpec::BakeCurves(bool bInOnlyMissing)
+{
+	Duration.BakeCurves(bInOnlyMissing);
+	Period.BakeCurves(bInOnlyMissing);
+	AtributeModifier.Magnitude.BakeCurves(bInOnlyMissing);
+	for (FGAAttributeModifier& Modifier : Modifiers.Modifiers)
+	{
+		Modifier.Magnitude.BakeCurves(bInOnlyMissing);
+	}
+}
+void UGAGameEffectSpec::GetMagnitudes(TArray<const FGAMagnitude*>& OutMagnitudes) const
+{
+	OutMagnitudes.Add(&Duration);
+	OutMagnitudes.Add(&Period);
+	OutMagnitudes.Add(&AtributeModifier.Magnitude);
+	for (const FGAAttributeModifier& Modifier : Modifiers.Modifiers)
+	{
+		OutMagnitudes.Add(&Modifier.Magnitude);
+	}
+}
+#if WITH_EDITOR
+void UGAGameEffectSpec::HandleObjectPropertyChanged(UObject* InObject, FPropertyChangedEvent& InEvent)
+{
+	UCurveTable* Table = Cast<UCurveTable>(InObject);
+	if (!Table)
+	{
+		return;
+	}
+	//specs are mostly used trough class default objects, include them.
+	TArray<UObject*> Specs;
+	GetObjectsOfClass(UGAGameEffectSpec::StaticClass(), Specs, true, RF_NoFlags);
+	for (UObject* Object : Specs)
+	{
+		UGAGameEffectSpec* Spec = CastChecked<UGAGameEffectSpec>(Object);
+		TArray<const FGAMagnitude*> Magnitudes;
+		Spec->GetMagnitudes(Magnitudes);
+		for (const FGAMagnitude* Magnitude : Magnitudes)
+		{
+			if (Magnitude->UsesCurveTable(Table))
+			{
+				Spec->BakeCurves();
+				break;
+			}
+		}
+	}
+}
+void UGAGameEffectSpec::ValidateBakedCurves() const
+{
+	TArray<const FGAMagnitude*> Magnitudes;
+	GetMagnitudes(Magnitudes);
+	for (const FGAMagnitude* Magnitude : Magnitudes)
+	{
+		if (Magnitude->CalculationType != EGAMagnitudeCalculation::CurveBased)
+			continue;
+
+		FString Error;
+		if (!Magnitude->CurveBased.ValidateBakedCurve(Error))
+		{
+			UE_LOG(GameAttributesEffects, Warning, TEXT("%s: %s"), *GetName(), *Error);
+		}
+	}
+}
+#endif //WITH_EDITOR
+
+void UGAGameEffectSpec::CaptureAttributes(FGAEffectContext& InContext) const
+{
+	if (AttributeCapture != EAFAttributeCapture::Snapshot)
+		return;
+	//read from magnitudes every time, so specs created at runtime and edited magnitudes are captured too.
+	Duration.CaptureAttributes(InContext);
+	Period.CaptureAttributes(InContext);
+	AtributeModifier.Magnitude.CaptureAttributes(InContext);
+	for (const FGAAttributeModifier& Modifier : Modifiers.Modifiers)
+	{
+		Modifier.Magnitude.CaptureAttributes(InContext);
+	}
+}
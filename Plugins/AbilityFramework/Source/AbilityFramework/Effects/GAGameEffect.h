@@ -7,6 +7,13 @@
 
 DECLARE_STATS_GROUP(TEXT("GameEffect"), STATGROUP_GameEffect, STATCAT_Advanced);
 DECLARE_CYCLE_STAT_EXTERN(TEXT("GatherModifiers"), STAT_GatherModifiers, STATGROUP_GameEffect, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Context Bytes Copied"), STAT_ContextBytesCopied, STATGROUP_GameEffect, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Live Context Handles"), STAT_LiveContextHandles, STATGROUP_GameEffect, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Pooled Contexts"), STAT_PooledContexts, STATGROUP_GameEffect, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Extensions Created"), STAT_ExtensionsCreated, STATGROUP_GameEffect, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Extensions Reused"), STAT_ExtensionsReused, STATGROUP_GameEffect, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Extensions Discarded (GC)"), STAT_ExtensionsDiscarded, STATGROUP_GameEffect, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Pooled Extensions"), STAT_PooledExtensions, STATGROUP_GameEffect, );
 
 /*
 	Modifier type for simple attribute operatinos.
@@ -29,6 +36,15 @@ enum class EGAMakeSpecResult : uint8
 	Invalid
 };
 
+UENUM()
+enum class EAFAttributeCapture : uint8
+{
+	/* Attributes are read every time magnitude is evaluated. */
+	Live,
+	/* Attributes are read once when effect is applied and stored in context. */
+	Snapshot
+};
+
 USTRUCT(BlueprintType)
 struct ABILITYFRAMEWORK_API FGAMagnitude
 {
@@ -63,6 +79,17 @@ public:
 		FGACustomCalculationModifier Custom;
 
 	float GetFloatValue(const FGAEffectContext& Context);
+	/*
+		Evaluates magnitude for many effects at once. InHandles and InContexts are parallel arrays.
+		Custom calculations get whole batch in single call.
+	*/
+	void GetFloatValues(const TArray<struct FGAEffectHandle>& InHandles,
+		const TArray<const FGAEffectContext*>& InContexts, TArray<float>& OutValues);
+	/* Bakes curve into lookup table if this magnitude is curve based. Game thread only. */
+	void BakeCurves(bool bInOnlyMissing = false);
+	bool UsesCurveTable(const UCurveTable* InTable) const;
+	/* Stores value of attribute read by this magnitude (if any) in context snapshot. */
+	void CaptureAttributes(FGAEffectContext& InContext) const;
 };
 USTRUCT(BlueprintType)
 struct ABILITYFRAMEWORK_API FGAAttributeModifier
@@ -264,8 +291,41 @@ public:
 	/* Tags, required for this effect to be executed. If these tags are not present, effect will be ignored. */
 	UPROPERTY(EditAnywhere, Category = "Tags")
 		FGameplayTagContainer ExecutionRequiredTags;
+
+	/*
+		Live - attributes are read from source every time magnitude is evaluated.
+		Snapshot - attributes used by magnitudes are captured once, when effect is applied,
+		and all later evaluations (duration, period, every periodic tick) use captured values.
+	*/
+	UPROPERTY(EditAnywhere, Category = "Attribute Capture")
+		EAFAttributeCapture AttributeCapture;
 public:
 	UGAGameEffectSpec();
+
+	virtual void PostLoad() override;
+	virtual void PreSave(const class ITargetPlatform* TargetPlatform) override;
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif //WITH_EDITOR
+
+	/* 
+		Bakes all curve based magnitudes into lookup tables. Game thread only.
+		bInOnlyMissing skips magnitudes which are already baked.
+	*/
+	void BakeCurves(bool bInOnlyMissing = false);
+	void GetMagnitudes(TArray<const FGAMagnitude*>& OutMagnitudes) const;
+#if WITH_EDITOR
+	/* Checks if baked tables are within MaxBakeError from source curves. */
+	void ValidateBakedCurves() const;
+	/* Rebakes specs using curve table which was changed (ie. reimported). */
+	static void HandleObjectPropertyChanged(UObject* InObject, FPropertyChangedEvent& InEvent);
+#endif //WITH_EDITOR
+
+	/* 
+		Stores values of attributes read by magnitudes in context snapshot, if AttributeCapture is Snapshot.
+		Called for every application, with context of that application.
+	*/
+	void CaptureAttributes(FGAEffectContext& InContext) const;
 };
 /*
 	Base effect class to extend from when creating effect blueprints.
@@ -426,6 +486,29 @@ struct FAFStatics
 		const FGAEffectHandle& InHandle);
 };
 
+/*
+	Stable per effect data used by duration and period timers.
+	Filled once when effect with duration/period is applied, so timers don't need
+	to carry copy of FGAEffectProperty (and it's Handles map) in their payloads.
+*/
+struct FAFEffectTimerRecord
+{
+	class UGAGameEffectSpec* Spec;
+	FAFFunctionModifier Modifier;
+	float Duration;
+	float Period;
+
+	FAFEffectTimerRecord()
+		: Spec(nullptr),
+		Duration(0),
+		Period(0)
+	{}
+
+	void Initialize(const FGAEffectProperty& InProperty, const FAFFunctionModifier& InModifier);
+	/* Property view over Spec (CDOs only, no handles) for component calls made by timers. */
+	void MakeProperty(FGAEffectProperty& OutProperty) const;
+};
+
 /*
 	Calculcated magnitudes, captured attributes and tags, set duration.
 	Final effect which then is used to apply custom calculations and attribute changes.
@@ -448,10 +531,13 @@ struct ABILITYFRAMEWORK_API FGAEffect : public TSharedFromThis<FGAEffect>
 	/* Contains all tags gathered on the way to application ? */
 
 	bool IsActive;
+	/* Cues of spec were started for this effect and must be removed with it. */
+	bool bCuesActive;
 public:
 	//pointer ? Acces trough handle ?
 	class UGAGameEffectSpec* GameEffect;
-	FGAEffectContext Context;
+	/* Shared with extension and anything else which needs context of this effect. */
+	FAFContextHandle Context;
 	FGameplayTagContainer OwnedTags;
 	FGameplayTagContainer ApplyTags;
 	FGameplayTagContainer RequiredTags;
@@ -462,6 +548,8 @@ public:
 	mutable FTimerHandle DurationTimerHandle;
 
 	FGAEffectMod AttributeMod;
+
+	FAFEffectTimerRecord TimerRecord;
 //because I'm fancy like that and like to make spearate public for fields and functions.
 public:
 	//Simple delegates to make sure they are bound only to one object.
@@ -473,9 +561,10 @@ public:
 	float LastTickTime;
 public:
 	void SetContext(const FGAEffectContext& ContextIn);
+	void SetContext(const FAFContextHandle& ContextIn);
 
-	class UAFAbilityComponent* GetInstigatorComp() { return Context.InstigatorComp.Get(); }
-	class UAFAbilityComponent* GetTargetComp() { return Context.TargetComp.Get(); }
+	class UAFAbilityComponent* GetInstigatorComp() { return Context.IsValid() ? Context->InstigatorComp.Get() : nullptr; }
+	class UAFAbilityComponent* GetTargetComp() { return Context.IsValid() ? Context->TargetComp.Get() : nullptr; }
 	inline void AddOwnedTags(const FGameplayTagContainer& TagsIn) { OwnedTags.AppendTags(TagsIn); }
 	inline void AddApplyTags(const FGameplayTagContainer& TagsIn) { ApplyTags.AppendTags(TagsIn); }
 	void OnApplied();
@@ -485,8 +574,18 @@ public:
 	void OnExecuted();
 	void DurationExpired();
 
+	/*
+		Timer callbacks. Bound trough CreateSP without payload, context and property
+		are taken from this effect (TimerRecord).
+	*/
+	void InitializeTimerRecord(const FGAEffectProperty& InProperty, const FAFFunctionModifier& InModifier);
+	void OnPeriodTimer();
+	void OnDurationTimer();
+
 	float GetDurationTime() const;
 	float GetPeriodTime() const;
+	/* Cue params made from context, with cue tags of spec. */
+	FGAEffectCueParams MakeCueParams() const;
 	float GetCurrentActivationTime();
 	float GetCurrentActivationTime() const;
 	float GetCurrentTickTime();
@@ -504,10 +603,13 @@ public:
 		return FString();
 	}
 	FGAEffect()
-		: GameEffect(nullptr)
+		: bCuesActive(false),
+		GameEffect(nullptr)
 	{}
 	FGAEffect(class UGAGameEffectSpec* GameEffectIn, 
 		const FGAEffectContext& ContextIn);
+	FGAEffect(class UGAGameEffectSpec* GameEffectIn,
+		const FAFContextHandle& ContextIn);
 
 	~FGAEffect();
 };
@@ -599,6 +701,9 @@ public:
 		float Duration;
 	UPROPERTY()
 		float ReplicationTime;
+	/* Spec class, so clients can tell what this effect is without effect itself. */
+	UPROPERTY()
+		UClass* EffectClass;
 
 	FSimpleDelegate OnAppliedDelegate;
 
@@ -640,6 +745,7 @@ public:
 		return AppliedTime + Duration;
 	}
 	FAFEffectRepInfo()
+		: EffectClass(nullptr)
 	{};
 
 	const bool operator==(const FAFEffectRepInfo& Other) const
@@ -651,9 +757,12 @@ public:
 		: AppliedTime(AppliedTimeIn),
 		PeriodTime(PeriodTimeIn),
 		Duration(DurationIn),
-		ReplicationTime(ReplicationTimeIn)
+		ReplicationTime(ReplicationTimeIn),
+		EffectClass(nullptr)
 	{};
 };
+/* Replicated effect info of given class was added (bRemoved = false) or removed on client. */
+DECLARE_MULTICAST_DELEGATE_TwoParams(FAFEffectRepInfoDelegate, const FAFEffectRepInfo&, bool);
 
 USTRUCT()
 struct ABILITYFRAMEWORK_API FGAGameCue
@@ -727,12 +836,26 @@ public:
 
 	UPROPERTY(NotReplicated)
 		class UAFAbilityComponent* OwningComponent;
+
+	/*
+		Called on clients when effect info of given spec class is replicated.
+		Abilities use it to keep cached cooldown/activation times, for effects they didn't apply locally.
+	*/
+	TMap<UClass*, FAFEffectRepInfoDelegate> RepInfoListeners;
+	/* Cooldowns shared by abilities of owning component with the same CooldownGroup. */
+	TMap<FGameplayTag, TWeakPtr<struct FAFCooldownGroupState>> CooldownGroups;
 public:
 	//FGAEffectContainer();
 	FGAEffectHandle ApplyEffect(FGAEffect* EffectIn, FGAEffectProperty& InProperty
 		, const FGAEffectContext& InContext
 		, const FAFFunctionModifier& Modifier = FAFFunctionModifier());
 	void ApplyReplicationInfo(const FGAEffectHandle& InHandle, const FGAEffectProperty& InProperty);
+	/*
+		Plays and replicates cues of effect spec. Server only, clients get them trough UAFCueReplicationComponent.
+		Persistent cues are removed when effect is removed or expires.
+	*/
+	void ExecuteEffectCues(FGAEffect* InEffect, const FGAEffectProperty& InProperty, bool bInPersistent);
+	void RemoveEffectCues(FGAEffect* InEffect);
 	/* Removesgiven number of effects of the same type. If Num == 0 Removes all effects */
 	void RemoveEffect(const FGAEffectProperty& HandleIn, int32 Num = 1);
 	/* Removesgiven number of effects of the same type. If Num == 0 Removes all effects */
@@ -805,6 +928,19 @@ public:
 			return 0;
 		return Info->GetEndTime();
 	}
+	/*
+		End time of effect just applied on this machine, from duration of applied property.
+		Doesn't need replicated info, so it works on server as well.
+		0 if effect is not active (instant), MAX_flt if it has no duration and lasts until removed.
+	*/
+	float GetAppliedEndTime(const FGAEffectHandle& InHandle, float InDuration)
+	{
+		if (!InHandle.IsValid() || !IsEffectActive(InHandle))
+			return 0;
+		if (InDuration <= 0)
+			return MAX_flt;
+		return GetWorld()->GetTimeSeconds() + InDuration;
+	}
 };
 template<>
 struct TStructOpsTypeTraits< FGAEffectContainer > : public TStructOpsTypeTraitsBase2<FGAEffectContainer>
@@ -5,6 +5,7 @@
 #include "GameplayTagContainer.h"
 #include "AFAbilityComponent.h"
 #include "Attributes/GAAttributeBase.h"
+#include "Attributes/GAAttributesBase.h"
 #include "Effects/GAEffectExecution.h"
 #include "AFAbilityInterface.h"
 #include "Effects/GACustomCalculation.h"
@@ -28,6 +29,61 @@ FGAEffectContext::FGAEffectContext(TWeakObjectPtr<class UGAAttributesBase> Targe
 	InstigatorInterface = Cast<IAFAbilityInterface>(Instigator.Get());
 	IAFAbilityInterface* CauserInterface = Cast<IAFAbilityInterface>(Causer.Get());
 }
+DEFINE_STAT(STAT_ContextBytesCopied);
+DEFINE_STAT(STAT_LiveContextHandles);
+DEFINE_STAT(STAT_PooledContexts);
+
+namespace AFContextPool
+{
+	/* Only touched from game thread, same as effects. Other threads allocate and delete directly. */
+	static TArray<FGAEffectContext*> FreeContexts;
+	static const int32 MaxFreeContexts = 512;
+
+	struct FContextDeleter
+	{
+		void operator()(FGAEffectContext* InContext) const
+		{
+			DEC_DWORD_STAT(STAT_LiveContextHandles);
+			if (IsInGameThread() && FreeContexts.Num() < MaxFreeContexts)
+			{
+				InContext->Reset();
+				FreeContexts.Add(InContext);
+				INC_DWORD_STAT(STAT_PooledContexts);
+				return;
+			}
+			delete InContext;
+		}
+	};
+}
+
+FAFContextHandle FAFContextHandle::Generate(const FGAEffectContext& ContextIn)
+{
+	FGAEffectContext* Block = nullptr;
+	if (IsInGameThread() && AFContextPool::FreeContexts.Num() > 0)
+	{
+		Block = AFContextPool::FreeContexts.Pop(false);
+		*Block = ContextIn;
+		DEC_DWORD_STAT(STAT_PooledContexts);
+	}
+	else
+	{
+		Block = new FGAEffectContext(ContextIn);
+	}
+	INC_DWORD_STAT_BY(STAT_ContextBytesCopied, sizeof(FGAEffectContext));
+	INC_DWORD_STAT(STAT_LiveContextHandles);
+	return FAFContextHandle(TSharedPtr<FGAEffectContext>(Block, AFContextPool::FContextDeleter()));
+}
+void FAFContextHandle::EmptyPool()
+{
+	check(IsInGameThread());
+	for (FGAEffectContext* Block : AFContextPool::FreeContexts)
+	{
+		delete Block;
+	}
+	DEC_DWORD_STAT_BY(STAT_PooledContexts, AFContextPool::FreeContexts.Num());
+	AFContextPool::FreeContexts.Empty();
+}
+
 FGAEffectHandle::FGAEffectHandle(uint32 HandleIn, FGAEffect* EffectIn)
 	: Handle(HandleIn),
 	EffectPtr(EffectIn)
@@ -38,8 +94,9 @@ FGAEffectHandle::~FGAEffectHandle()
 {
 	Reset();
 }
-FGAEffectContext& FGAEffectHandle::GetContextRef() { return EffectPtr->Context; }
-FGAEffectContext& FGAEffectHandle::GetContextRef() const { return EffectPtr->Context; }
+const FGAEffectContext& FGAEffectHandle::GetContextRef() { return EffectPtr->Context.GetRef(); }
+const FGAEffectContext& FGAEffectHandle::GetContextRef() const { return EffectPtr->Context.GetRef(); }
+const FAFContextHandle& FGAEffectHandle::GetContextHandle() const { return EffectPtr->Context; }
 
 UGAGameEffectSpec* FGAEffectHandle::GetEffectSpec() { return EffectPtr->GameEffect; }
 UGAGameEffectSpec* FGAEffectHandle::GetEffectSpec() const { return EffectPtr->GameEffect; }
@@ -58,8 +115,8 @@ TSharedPtr<FGAEffect> FGAEffectHandle::GetEffectPtr() const { return EffectPtr;
 void FGAEffectHandle::SetContext(const FGAEffectContext& ContextIn) { EffectPtr->SetContext(ContextIn); }
 void FGAEffectHandle::SetContext(const FGAEffectContext& ContextIn) const { EffectPtr->SetContext(ContextIn); }
 
-FGAEffectContext& FGAEffectHandle::GetContext() { return EffectPtr->Context; }
-FGAEffectContext& FGAEffectHandle::GetContext() const { return EffectPtr->Context; }
+const FGAEffectContext& FGAEffectHandle::GetContext() { return EffectPtr->Context.GetRef(); }
+const FGAEffectContext& FGAEffectHandle::GetContext() const { return EffectPtr->Context.GetRef(); }
 
 /* Executes effect trough provided execution class. */
 
@@ -150,6 +207,7 @@ void FGAEffectContext::Reset()
 	Instigator.Reset();
 	TargetComp.Reset();
 	InstigatorComp.Reset();
+	Snapshot.Reset();
 }
 class UGAAttributesBase* FGAEffectContext::GetTargetAttributes()
 { 
@@ -197,6 +255,43 @@ class UGAAttributesBase* FGAEffectContext::GetCauserAttributes() const
 	return nullptr;
 }
 
+class IAFAbilityInterface* FGAEffectContext::GetSourceInterface(EGAAttributeSource InSource) const
+{
+	switch (InSource)
+	{
+	case EGAAttributeSource::Instigator:
+		return Cast<IAFAbilityInterface>(Instigator.Get());
+	case EGAAttributeSource::Target:
+		return Cast<IAFAbilityInterface>(Target.Get());
+	case EGAAttributeSource::Causer:
+		return Cast<IAFAbilityInterface>(Causer.Get());
+	default:
+		return nullptr;
+	}
+}
+float FGAEffectContext::GetAttributeValue(EGAAttributeSource InSource, const FGAAttribute& InAttribute) const
+{
+	if (const float* Captured = Snapshot.Find(InSource, InAttribute.AttributeName))
+	{
+		return *Captured;
+	}
+	IAFAbilityInterface* Interface = GetSourceInterface(InSource);
+	if (!Interface || !Interface->GetAttributes())
+		return 0;
+	FAFAttributeBase* Attribute = Interface->GetAttributes()->GetAttribute(InAttribute);
+	return Attribute ? Attribute->GetFinalValue() : 0;
+}
+void FGAEffectContext::CaptureAttribute(EGAAttributeSource InSource, const FGAAttribute& InAttribute)
+{
+	IAFAbilityInterface* Interface = GetSourceInterface(InSource);
+	if (!Interface || !Interface->GetAttributes())
+		return;
+	if (FAFAttributeBase* Attribute = Interface->GetAttributes()->GetAttribute(InAttribute))
+	{
+		Snapshot.Add(InSource, InAttribute.AttributeName, Attribute->GetFinalValue());
+	}
+}
+
 FGAEffectContext::~FGAEffectContext()
 {
 	Target.Reset();
@@ -191,6 +191,50 @@ public:
 };
 
 
+/*
+	Attribute values captured once, when effect is applied. Magnitudes read them from here
+	instead of going trough interface -> attributes -> reflection every time they are evaluated.
+	Few attributes per spec at most, so it's just small inline array.
+*/
+struct ABILITYFRAMEWORK_API FAFAttributeSnapshot
+{
+	struct FCapturedValue
+	{
+		FName Attribute;
+		EGAAttributeSource Source;
+		float Value;
+	};
+	TArray<FCapturedValue, TInlineAllocator<4>> Values;
+
+	inline const float* Find(EGAAttributeSource InSource, const FName& InAttribute) const
+	{
+		for (const FCapturedValue& Captured : Values)
+		{
+			if (Captured.Source == InSource && Captured.Attribute == InAttribute)
+				return &Captured.Value;
+		}
+		return nullptr;
+	}
+	inline void Add(EGAAttributeSource InSource, const FName& InAttribute, float InValue)
+	{
+		for (FCapturedValue& Captured : Values)
+		{
+			if (Captured.Source == InSource && Captured.Attribute == InAttribute)
+			{
+				Captured.Value = InValue;
+				return;
+			}
+		}
+		FCapturedValue& Captured = Values[Values.AddUninitialized()];
+		Captured.Attribute = InAttribute;
+		Captured.Source = InSource;
+		Captured.Value = InValue;
+	}
+	inline void Reset() { Values.Reset(); }
+	inline bool IsEmpty() const { return Values.Num() == 0; }
+};
+
+
 USTRUCT(BlueprintType)
 struct ABILITYFRAMEWORK_API FGAEffectContext
 {
@@ -244,6 +288,10 @@ public:
 
 	class IAFAbilityInterface* TargetInterface;
 	class IAFAbilityInterface* InstigatorInterface;
+	/*
+		Attributes captured by spec at application time (if spec use snapshot capture).
+	*/
+	FAFAttributeSnapshot Snapshot;
 	template<class T>
 	inline T* GetTarget()
 	{
@@ -296,6 +344,13 @@ public:
 	class UGAAttributesBase* GetInstigatorAttributes() const;
 	class UGAAttributesBase* GetCauserAttributes() const;
 
+	class IAFAbilityInterface* GetSourceInterface(EGAAttributeSource InSource) const;
+	/*
+		Captured value if there is one, otherwise current final value of attribute.
+	*/
+	float GetAttributeValue(EGAAttributeSource InSource, const struct FGAAttribute& InAttribute) const;
+	void CaptureAttribute(EGAAttributeSource InSource, const struct FGAAttribute& InAttribute);
+
 	FGAEffectContext()
 	{}
 
@@ -309,6 +364,49 @@ public:
 	~FGAEffectContext();
 };
 
+/*
+	Shared, immutable context. Context is created once per application and then everything
+	(effect, timers, extension, ability) only holds reference to it.
+	If you need different context, generate new handle, don't modify existing one.
+
+	Released blocks are kept in small pool on game thread and reused for next applications.
+*/
+USTRUCT(BlueprintType)
+struct ABILITYFRAMEWORK_API FAFContextHandle
+{
+	GENERATED_BODY()
+protected:
+	TSharedPtr<FGAEffectContext> Data;
+public:
+	static FAFContextHandle Generate(const FGAEffectContext& ContextIn);
+	/* Drops pooled context blocks. */
+	static void EmptyPool();
+
+	inline bool IsValid() const { return Data.IsValid(); }
+	inline const FGAEffectContext& GetRef() const { return *Data.Get(); }
+	inline const FGAEffectContext* Get() const { return Data.Get(); }
+	inline const FGAEffectContext* operator->() const { return Data.Get(); }
+	inline void Reset() { Data.Reset(); }
+
+	bool operator==(const FAFContextHandle& Other) const
+	{
+		return Data == Other.Data;
+	}
+	bool operator!=(const FAFContextHandle& Other) const
+	{
+		return Data != Other.Data;
+	}
+
+	FAFContextHandle()
+	{
+
+	}
+protected:
+	FAFContextHandle(const TSharedPtr<FGAEffectContext>& InData)
+		: Data(InData)
+	{}
+};
+
 struct FGAEffect;
 class UGAGameEffectSpec;
 struct FGAEffectMod;
@@ -326,8 +424,9 @@ protected:
 	TSharedPtr<FGAEffect> EffectPtr;
 public:
 
-	FGAEffectContext& GetContextRef();
-	FGAEffectContext& GetContextRef() const;
+	const FGAEffectContext& GetContextRef();
+	const FGAEffectContext& GetContextRef() const;
+	const FAFContextHandle& GetContextHandle() const;
 
 	UGAGameEffectSpec* GetEffectSpec();
 	UGAGameEffectSpec* GetEffectSpec() const;
@@ -346,8 +445,8 @@ public:
 	void SetContext(const FGAEffectContext& ContextIn);
 	void SetContext(const FGAEffectContext& ContextIn) const;
 
-	FGAEffectContext& GetContext();
-	FGAEffectContext& GetContext() const;
+	const FGAEffectContext& GetContext();
+	const FGAEffectContext& GetContext() const;
 
 	void AppendOwnedTags(const FGameplayTagContainer& TagsIn);
 	void AppendOwnedTags(const FGameplayTagContainer& TagsIn) const;
@@ -754,18 +853,6 @@ public:
 };
 
 
-USTRUCT(BlueprintType)
-struct ABILITYFRAMEWORK_API FAFContextHandle
-{
-	GENERATED_BODY()
-protected:
-	TSharedPtr<FGAEffectContext> Data;
-public:
-	FAFContextHandle()
-	{
-
-	}
-};
 
 USTRUCT(BlueprintType)
 struct ABILITYFRAMEWORK_API FGAEffectCueParams
@@ -0,0 +1,251 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "../AbilityFramework.h"
+#include "GALatentFunctionBase.h"
+#include "AFLatentActionScheduler.h"
+
+DEFINE_STAT(STAT_TickLatentActions);
+DEFINE_STAT(STAT_TickingLatentActions);
+DEFINE_STAT(STAT_QueuedLatentDeadlines);
+DEFINE_STAT(STAT_LatentDeadlinesFired);
+
+void FAFLatentActionTickFunction::ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent)
+{
+	if (Scheduler && World.IsValid())
+	{
+		Scheduler->TickWorld(World.Get(), DeltaTime, TickType);
+	}
+}
+
+FString FAFLatentActionTickFunction::DiagnosticMessage()
+{
+	return FString(TEXT("UAFLatentActionScheduler[TickLatentActions]"));
+}
+
+UAFLatentActionScheduler* UAFLatentActionScheduler::SchedulerInstance = nullptr;
+
+UAFLatentActionScheduler::UAFLatentActionScheduler(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+}
+
+UAFLatentActionScheduler* UAFLatentActionScheduler::Get()
+{
+	if (SchedulerInstance)
+	{
+		return SchedulerInstance;
+	}
+	SchedulerInstance = NewObject<UAFLatentActionScheduler>(GEngine, UAFLatentActionScheduler::StaticClass(), "UAFLatentActionSchedulerInstance",
+		RF_MarkAsRootSet);
+	SchedulerInstance->AddToRoot();
+	SchedulerInstance->Initialize();
+
+	return SchedulerInstance;
+}
+void UAFLatentActionScheduler::AddReferencedObjects(UObject* InThis, FReferenceCollector& Collector)
+{
+	UAFLatentActionScheduler* This = CastChecked<UAFLatentActionScheduler>(InThis);
+	for (auto WorldIt = This->WorldActions.CreateIterator(); WorldIt; ++WorldIt)
+	{
+		FWorldLatentActions& Actions = *WorldIt->Value;
+		Collector.AddReferencedObjects(Actions.Ticking, This);
+		for (FAFLatentDeadline& Deadline : Actions.Deadlines)
+		{
+			Collector.AddReferencedObject(Deadline.Action, This);
+		}
+	}
+	Super::AddReferencedObjects(InThis, Collector);
+}
+void UAFLatentActionScheduler::Initialize()
+{
+	FWorldDelegates::OnWorldCleanup.AddUObject(this, &UAFLatentActionScheduler::HandleWorldCleanup);
+}
+
+void UAFLatentActionScheduler::AddTickAction(UGALatentFunctionBase* InAction, UWorld* InWorld)
+{
+	if (!InAction || !InWorld || InAction->TickIndex != INDEX_NONE)
+	{
+		return;
+	}
+	FWorldLatentActions& Actions = FindOrAddWorld(InWorld);
+	InAction->TickIndex = Actions.Ticking.Add(InAction);
+	InAction->TickWorld = FObjectKey(InWorld);
+	INC_DWORD_STAT(STAT_TickingLatentActions);
+}
+void UAFLatentActionScheduler::RemoveTickAction(UGALatentFunctionBase* InAction)
+{
+	if (!InAction || InAction->TickIndex == INDEX_NONE)
+	{
+		return;
+	}
+	TUniquePtr<FWorldLatentActions>* ActionsPtr = WorldActions.Find(InAction->TickWorld);
+	const int32 Index = InAction->TickIndex;
+	InAction->TickIndex = INDEX_NONE;
+	InAction->TickWorld = FObjectKey();
+	if (!ActionsPtr || !ActionsPtr->IsValid())
+	{
+		return;
+	}
+	FWorldLatentActions& Actions = **ActionsPtr;
+	if (!Actions.Ticking.IsValidIndex(Index) || Actions.Ticking[Index] != InAction)
+	{
+		return;
+	}
+	//don't move anything around while iterating, just leave hole.
+	if (Actions.bIsTicking)
+	{
+		Actions.Ticking[Index] = nullptr;
+		Actions.bNeedsCompact = true;
+		return;
+	}
+	DEC_DWORD_STAT(STAT_TickingLatentActions);
+	Actions.Ticking.RemoveAtSwap(Index, 1, false);
+	if (Actions.Ticking.IsValidIndex(Index) && Actions.Ticking[Index])
+	{
+		Actions.Ticking[Index]->TickIndex = Index;
+	}
+}
+void UAFLatentActionScheduler::AddDeadline(UGALatentFunctionBase* InAction, UWorld* InWorld, float InTime)
+{
+	if (!InAction || !InWorld)
+	{
+		return;
+	}
+	FWorldLatentActions& Actions = FindOrAddWorld(InWorld);
+	//invalidates previous deadline of this action, if there is any.
+	InAction->DeadlineSerial++;
+	FAFLatentDeadline Deadline;
+	Deadline.Time = InTime;
+	Deadline.Sequence = Actions.NextSequence++;
+	Deadline.Serial = InAction->DeadlineSerial;
+	Deadline.Action = InAction;
+	Actions.Deadlines.HeapPush(Deadline);
+	INC_DWORD_STAT(STAT_QueuedLatentDeadlines);
+}
+void UAFLatentActionScheduler::RemoveAction(UGALatentFunctionBase* InAction)
+{
+	if (!InAction)
+	{
+		return;
+	}
+	RemoveTickAction(InAction);
+	InAction->DeadlineSerial++;
+}
+
+void UAFLatentActionScheduler::TickWorld(UWorld* InWorld, float DeltaTime, ELevelTick TickType)
+{
+	SCOPE_CYCLE_COUNTER(STAT_TickLatentActions);
+	TUniquePtr<FWorldLatentActions>* ActionsPtr = WorldActions.Find(FObjectKey(InWorld));
+	if (!ActionsPtr || !ActionsPtr->IsValid())
+	{
+		return;
+	}
+	FWorldLatentActions& Actions = **ActionsPtr;
+	FireDeadlines(Actions, InWorld->GetTimeSeconds());
+
+	Actions.bIsTicking = true;
+	//actions added during tick, will tick next frame.
+	const int32 Num = Actions.Ticking.Num();
+	for (int32 Idx = 0; Idx < Num; Idx++)
+	{
+		UGALatentFunctionBase* Action = Actions.Ticking[Idx];
+		if (!Action)
+		{
+			//removed during tick or cleared by GC.
+			Actions.bNeedsCompact = true;
+			continue;
+		}
+		if (Action->IsPendingKillOrUnreachable())
+		{
+			continue;
+		}
+		Action->TickAction(DeltaTime, TickType);
+	}
+	Actions.bIsTicking = false;
+	if (Actions.bNeedsCompact)
+	{
+		Compact(Actions);
+	}
+}
+
+void UAFLatentActionScheduler::FireDeadlines(FWorldLatentActions& InActions, float InWorldTime)
+{
+	//take everything due first, so deadlines scheduled from OnDeadline wait at least until next frame.
+	DueDeadlines.Reset();
+	while (InActions.Deadlines.Num() > 0 && InActions.Deadlines.HeapTop().Time <= InWorldTime)
+	{
+		FAFLatentDeadline Deadline;
+		InActions.Deadlines.HeapPop(Deadline, false);
+		DEC_DWORD_STAT(STAT_QueuedLatentDeadlines);
+		DueDeadlines.Add(Deadline);
+	}
+	for (const FAFLatentDeadline& Deadline : DueDeadlines)
+	{
+		UGALatentFunctionBase* Action = Deadline.Action;
+		if (!Action || Action->IsPendingKillOrUnreachable() || Action->DeadlineSerial != Deadline.Serial)
+		{
+			continue;
+		}
+		INC_DWORD_STAT(STAT_LatentDeadlinesFired);
+		Action->OnDeadline();
+	}
+	DueDeadlines.Reset();
+}
+
+UAFLatentActionScheduler::FWorldLatentActions& UAFLatentActionScheduler::FindOrAddWorld(UWorld* InWorld)
+{
+	TUniquePtr<FWorldLatentActions>& Actions = WorldActions.FindOrAdd(FObjectKey(InWorld));
+	if (!Actions.IsValid())
+	{
+		Actions = MakeUnique<FWorldLatentActions>();
+		FAFLatentActionTickFunction& TickFunction = Actions->TickFunction;
+		TickFunction.Scheduler = this;
+		TickFunction.World = InWorld;
+		TickFunction.TickGroup = TG_PrePhysics;
+		TickFunction.bCanEverTick = true;
+		TickFunction.bStartWithTickEnabled = true;
+		TickFunction.bAllowTickOnDedicatedServer = true;
+		TickFunction.RegisterTickFunction(InWorld->PersistentLevel);
+	}
+	return *Actions;
+}
+void UAFLatentActionScheduler::Compact(FWorldLatentActions& InActions)
+{
+	int32 WriteIdx = 0;
+	for (int32 ReadIdx = 0; ReadIdx < InActions.Ticking.Num(); ReadIdx++)
+	{
+		UGALatentFunctionBase* Action = InActions.Ticking[ReadIdx];
+		if (Action)
+		{
+			Action->TickIndex = WriteIdx;
+			InActions.Ticking[WriteIdx++] = Action;
+		}
+	}
+	DEC_DWORD_STAT_BY(STAT_TickingLatentActions, InActions.Ticking.Num() - WriteIdx);
+	InActions.Ticking.SetNum(WriteIdx, false);
+	InActions.bNeedsCompact = false;
+}
+void UAFLatentActionScheduler::HandleWorldCleanup(UWorld* InWorld, bool bSessionEnded, bool bCleanupResources)
+{
+	TUniquePtr<FWorldLatentActions>* ActionsPtr = WorldActions.Find(FObjectKey(InWorld));
+	if (!ActionsPtr)
+	{
+		return;
+	}
+	if (ActionsPtr->IsValid())
+	{
+		FWorldLatentActions& Actions = **ActionsPtr;
+		for (UGALatentFunctionBase* Action : Actions.Ticking)
+		{
+			if (Action)
+			{
+				Action->TickIndex = INDEX_NONE;
+				Action->TickWorld = FObjectKey();
+			}
+		}
+		DEC_DWORD_STAT_BY(STAT_TickingLatentActions, Actions.Ticking.Num());
+		DEC_DWORD_STAT_BY(STAT_QueuedLatentDeadlines, Actions.Deadlines.Num());
+		Actions.TickFunction.UnRegisterTickFunction();
+	}
+	WorldActions.Remove(FObjectKey(InWorld));
+}
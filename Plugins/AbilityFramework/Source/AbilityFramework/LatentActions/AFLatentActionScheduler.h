@@ -0,0 +1,113 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/NoExportTypes.h"
+#include "Engine/EngineBaseTypes.h"
+#include "../Abilities/AFAbilityStats.h"
+#include "AFLatentActionScheduler.generated.h"
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Tick Latent Actions"), STAT_TickLatentActions, STATGROUP_Abilities, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Ticking Latent Actions"), STAT_TickingLatentActions, STATGROUP_Abilities, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Queued Latent Deadlines"), STAT_QueuedLatentDeadlines, STATGROUP_Abilities, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Latent Deadlines Fired"), STAT_LatentDeadlinesFired, STATGROUP_Abilities, );
+
+USTRUCT()
+struct FAFLatentActionTickFunction : public FTickFunction
+{
+	GENERATED_USTRUCT_BODY()
+	class UAFLatentActionScheduler* Scheduler;
+	TWeakObjectPtr<UWorld> World;
+
+	virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent) override;
+	virtual FString DiagnosticMessage() override;
+};
+template<>
+struct TStructOpsTypeTraits<FAFLatentActionTickFunction> : public TStructOpsTypeTraitsBase2<FAFLatentActionTickFunction>
+{
+	enum
+	{
+		WithCopy = false
+	};
+};
+
+/*
+	Drives all UGALatentFunctionBase in world from single tick function.
+
+	Waiting actions are kept in deadline queue (binary heap on world time), so only actions
+	which are due are touched in frame. Actions which need per frame update are in separate,
+	contiguous tick list.
+	Scheduler keeps strong references to queued and ticking actions, so they stay alive until
+	they end, without any per action tick function or timer.
+
+	Deadlines are not removed from queue when action ends or is rescheduled, action serial
+	is bumped instead and stale entries are dropped when they reach top of queue.
+*/
+UCLASS()
+class ABILITYFRAMEWORK_API UAFLatentActionScheduler : public UObject
+{
+	GENERATED_BODY()
+protected:
+	static UAFLatentActionScheduler* SchedulerInstance;
+
+	struct FAFLatentDeadline
+	{
+		float Time;
+		/* Order of insertion, actions due at the same time fire in order they were scheduled. */
+		uint32 Sequence;
+		/* Must match UGALatentFunctionBase::DeadlineSerial, otherwise entry is stale. */
+		uint32 Serial;
+		class UGALatentFunctionBase* Action;
+
+		bool operator<(const FAFLatentDeadline& Other) const
+		{
+			return Time < Other.Time || (Time == Other.Time && Sequence < Other.Sequence);
+		}
+	};
+
+	struct FWorldLatentActions
+	{
+		FAFLatentActionTickFunction TickFunction;
+		TArray<FAFLatentDeadline> Deadlines;
+		TArray<class UGALatentFunctionBase*> Ticking;
+		uint32 NextSequence;
+		bool bIsTicking;
+		bool bNeedsCompact;
+
+		FWorldLatentActions()
+			: NextSequence(0),
+			bIsTicking(false),
+			bNeedsCompact(false)
+		{}
+	};
+
+	TMap<FObjectKey, TUniquePtr<FWorldLatentActions>> WorldActions;
+
+	/* Deadlines due this frame, reused. */
+	TArray<FAFLatentDeadline> DueDeadlines;
+public:
+	UAFLatentActionScheduler(const FObjectInitializer& ObjectInitializer);
+
+	static UAFLatentActionScheduler* Get();
+	/* Doesn't create scheduler, use during destruction. */
+	static UAFLatentActionScheduler* GetIfExists() { return SchedulerInstance; }
+	static void AddReferencedObjects(UObject* InThis, FReferenceCollector& Collector);
+
+	void Initialize();
+
+	void AddTickAction(class UGALatentFunctionBase* InAction, UWorld* InWorld);
+	void RemoveTickAction(class UGALatentFunctionBase* InAction);
+	/* Calls InAction->OnDeadline() once world time reaches InTime. Replaces previous deadline of action. */
+	void AddDeadline(class UGALatentFunctionBase* InAction, UWorld* InWorld, float InTime);
+	/* Drops tick and pending deadline. */
+	void RemoveAction(class UGALatentFunctionBase* InAction);
+
+	void TickWorld(UWorld* InWorld, float DeltaTime, ELevelTick TickType);
+
+protected:
+	FWorldLatentActions& FindOrAddWorld(UWorld* InWorld);
+	void FireDeadlines(FWorldLatentActions& InActions, float InWorldTime);
+	void Compact(FWorldLatentActions& InActions);
+	void HandleWorldCleanup(UWorld* InWorld, bool bSessionEnded, bool bCleanupResources);
+};
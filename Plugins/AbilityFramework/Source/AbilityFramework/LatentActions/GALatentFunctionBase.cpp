@@ -1,57 +1,60 @@
 // Copyright 1998-2014 Epic Games, Inc. All Rights Reserved.
 
 #include "../AbilityFramework.h"
+#include "AFLatentActionScheduler.h"
 #include "GALatentFunctionBase.h"
 
-void FGALatentFunctionTick::ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent)
-{
-	if (Target && !Target->IsPendingKillOrUnreachable())
-	{
-		FScopeCycleCounterUObject ActorScope(Target);
-		Target->TickAction(DeltaTime, TickType, *this);
-	}
-}
-
-FString FGALatentFunctionTick::DiagnosticMessage()
-{
-	return Target->GetFullName() + TEXT("[TickAction]");
-}
-
 UGALatentFunctionBase::UGALatentFunctionBase(const FObjectInitializer& ObjectInitializer)
 : Super(ObjectInitializer)
 {
-	TickFunction.TickGroup = TG_PrePhysics;
-	// Default to no tick function, but if we set 'never ticks' to false (so there is a tick function) it is enabled by default
-	TickFunction.bCanEverTick = false;
-	TickFunction.bStartWithTickEnabled = true;
-	TickFunction.bAllowTickOnDedicatedServer = true;
-	TickFunction.bRunOnAnyThread = true;
-
-	TickFunction.SetTickFunctionEnable(true);
-	SetFlags(RF_StrongRefOnFrame);
+	bTickable = false;
+	TickIndex = INDEX_NONE;
+	DeadlineSerial = 0;
 }
 
 void UGALatentFunctionBase::Initialize()
 {
-	if (GetWorld())
+	if (bTickable)
 	{
-		TickFunction.Target = this;
-		ULevel* level = GetWorld()->GetCurrentLevel();
-		if (level)
-		{
-			TickFunction.RegisterTickFunction(level);
-		}
+		StartTicking();
 	}
 }
 void UGALatentFunctionBase::EndTask()
 {
-	if (TickFunction.bCanEverTick && TickFunction.IsTickFunctionRegistered())
+	if (UAFLatentActionScheduler* Scheduler = UAFLatentActionScheduler::GetIfExists())
 	{
-		TickFunction.UnRegisterTickFunction();
-		TickFunction.SetTickFunctionEnable(false);
+		Scheduler->RemoveAction(this);
 	}
 	MarkPendingKill();
 }
+void UGALatentFunctionBase::StartTicking()
+{
+	if (UWorld* World = GetWorld())
+	{
+		UAFLatentActionScheduler::Get()->AddTickAction(this, World);
+	}
+}
+void UGALatentFunctionBase::StopTicking()
+{
+	if (UAFLatentActionScheduler* Scheduler = UAFLatentActionScheduler::GetIfExists())
+	{
+		Scheduler->RemoveTickAction(this);
+	}
+}
+void UGALatentFunctionBase::WaitFor(float InSeconds)
+{
+	if (UWorld* World = GetWorld())
+	{
+		WaitUntil(World->GetTimeSeconds() + InSeconds);
+	}
+}
+void UGALatentFunctionBase::WaitUntil(float InWorldTime)
+{
+	if (UWorld* World = GetWorld())
+	{
+		UAFLatentActionScheduler::Get()->AddDeadline(this, World, InWorldTime);
+	}
+}
 void UGALatentFunctionBase::BeginDestroy()
 {
 	Super::BeginDestroy();
@@ -68,4 +71,4 @@ UWorld* UGALatentFunctionBase::GetWorld() const
 		return TaskOwner->GetWorld();
 	}
 	return nullptr;
-}
\ No newline at end of file
+}
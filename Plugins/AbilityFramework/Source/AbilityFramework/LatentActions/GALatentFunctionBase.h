@@ -4,23 +4,10 @@
 #include "Messaging.h"
 #include "GALatentFunctionBase.generated.h"
 
-struct FGALatentFunctionTick: public FTickFunction
-{
-	/**  AActor  that is the target of this tick **/
-	class UGALatentFunctionBase* Target;
-
-	/**
-	* Abstract function actually execute the tick.
-	* @param DeltaTime - frame time to advance, in seconds
-	* @param TickType - kind of tick for this frame
-	* @param CurrentThread - thread we are executing on, useful to pass along as new tasks are created
-	* @param MyCompletionGraphEvent - completion event for this task. Useful for holding the completetion of this task until certain child tasks are complete.
-	**/
-	virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent) override;
-	/** Abstract function to describe this tick. Used to print messages about illegal cycles in the dependency graph **/
-	virtual FString DiagnosticMessage() override;
-};
-
+/*
+	Latent actions are driven by UAFLatentActionScheduler. Action which needs per frame update
+	sets bTickable (or calls StartTicking), waiting is done with WaitFor/WaitUntil and OnDeadline.
+*/
 UCLASS(meta = (ExposedAsyncProxy = "true"))
 class ABILITYFRAMEWORK_API UGALatentFunctionBase : public UObject
 {
@@ -29,20 +16,34 @@ class ABILITYFRAMEWORK_API UGALatentFunctionBase : public UObject
 protected:
 	UPROPERTY()
 		UObject* TaskOwner;
-	friend struct FGALatentFunctionTick;
-	FGALatentFunctionTick TickFunction;
+	friend class UAFLatentActionScheduler;
+	/* Start ticking right after Initialize. */
+	bool bTickable;
+	/* Index in scheduler tick list, INDEX_NONE when not ticking. */
+	int32 TickIndex;
+	FObjectKey TickWorld;
+	/* Bumped whenever deadline is scheduled or dropped. */
+	uint32 DeadlineSerial;
 
 	TSharedPtr<FMessageEndpoint, ESPMode::ThreadSafe> Endpoint;
 	UGALatentFunctionBase(const FObjectInitializer& ObjectInitializer);
 	virtual UWorld* GetWorld() const override;
 
 	//virtual void Tick(float DeltaSecondsIn);
-	virtual void TickAction(float DeltaSeconds, ELevelTick TickType, FGALatentFunctionTick& ThisTickFunction) {};
+	virtual void TickAction(float DeltaSeconds, ELevelTick TickType) {};
+	/* Called by scheduler when deadline set by WaitFor/WaitUntil is reached. */
+	virtual void OnDeadline() {};
 	virtual void Initialize();
 	virtual void ReadyForActivation() {};
 	virtual void Activate() {};
 	virtual void EndTask();
 	virtual void BeginDestroy() override;
+
+	void StartTicking();
+	void StopTicking();
+	/* InSeconds from now, in world time. */
+	void WaitFor(float InSeconds);
+	void WaitUntil(float InWorldTime);
 	
 	template <class T>
 	FORCEINLINE static T* NewTask(UObject* WorldContextObject, UObject* InTaskOwner, FName InstanceName = FName())
@@ -6,11 +6,8 @@
 UGAWaitAction::UGAWaitAction(const FObjectInitializer& ObjectInitializer)
 : Super(ObjectInitializer)
 {
-	TickFunction.bCanEverTick = true;
-	TickFunction.bStartWithTickEnabled = true;
-	TickFunction.bAllowTickOnDedicatedServer = true;
-	TickFunction.bRunOnAnyThread = true;
-	SetFlags(RF_StrongRefOnFrame);
+	//OnTick can only be bound after factory returns, first tick decides if it's needed.
+	bTickable = true;
 }
 
 UGAWaitAction* UGAWaitAction::NewGAWaitAction(UObject* InTaskOwner, float Time)
@@ -30,24 +27,25 @@ UGAWaitAction* UGAWaitAction::NewGAWaitAction(UObject* InTaskOwner, float Time)
 void UGAWaitAction::Activate()
 {
 	OnInitialized.Broadcast();
-	if (GEngine)
+	if (UWorld* World = GetWorld())
 	{
-		GEngine->AddOnScreenDebugMessage(0, 1, FColor::Red, FString("ObjectName: ") + GetName());
-	}
-	if (TaskOwner && TaskOwner->GetWorld())
-	{
-		UWorld* World = TaskOwner->GetWorld();
 		TimeStarted = World->GetTimeSeconds();
-
-		// Use a dummy timer handle as we don't need to store it for later but we don't need to look for something to clear
-		FTimerHandle TimerHandle;
-		World->GetTimerManager().SetTimer(TimerHandle, this, &UGAWaitAction::OnTimeFinish, Time, false);
+		WaitFor(Time);
 	}
 }
-void UGAWaitAction::TickAction(float DeltaSeconds, ELevelTick TickType, FGALatentFunctionTick& ThisTickFunction)
+void UGAWaitAction::TickAction(float DeltaSeconds, ELevelTick TickType)
 {
+	if (!OnTick.IsBound())
+	{
+		StopTicking();
+		return;
+	}
 	OnTick.Broadcast();
 };
+void UGAWaitAction::OnDeadline()
+{
+	OnTimeFinish();
+}
 void UGAWaitAction::OnTimeFinish()
 {
 	OnFinish.Broadcast();
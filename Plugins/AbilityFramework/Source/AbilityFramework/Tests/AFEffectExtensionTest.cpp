@@ -0,0 +1,10 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AbilityFramework.h"
+#include "AFEffectExtensionTest.h"
+
+UAFEffectExtensionTest::UAFEffectExtensionTest(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	Counter = 1;
+}
@@ -0,0 +1,23 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "../Effects/GAEffectExtension.h"
+#include "AFEffectExtensionTest.generated.h"
+
+/**
+ * Extension with own state, which must not leak between pooled uses.
+ */
+UCLASS()
+class ABILITYFRAMEWORK_API UAFEffectExtensionTest : public UGAEffectExtension
+{
+	GENERATED_BODY()
+	
+public:
+	UPROPERTY()
+		int32 Counter;
+	UPROPERTY()
+		TArray<int32> Values;
+
+	UAFEffectExtensionTest(const FObjectInitializer& ObjectInitializer);
+};
@@ -0,0 +1,17 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AbilityFramework.h"
+#include "../Abilities/AFNonInstancedAbility.h"
+#include "AFNonInstancedAbilityTest.h"
+
+UAFNonInstancedAbilityTest::UAFNonInstancedAbilityTest(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	Instancing = EAFAbilityInstancing::NonInstanced;
+	ActivationCount = 0;
+}
+
+void UAFNonInstancedAbilityTest::NativeOnActivateNonInstanced(FAFAbilityInstanceState& InState, UAFAbilityComponent* InComponent)
+{
+	ActivationCount++;
+}
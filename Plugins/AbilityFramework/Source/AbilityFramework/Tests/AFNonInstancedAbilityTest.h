@@ -0,0 +1,22 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "../Abilities/GAAbilityBase.h"
+#include "AFNonInstancedAbilityTest.generated.h"
+
+/**
+ * Non-instanced ability, counts activations on class default object.
+ */
+UCLASS()
+class ABILITYFRAMEWORK_API UAFNonInstancedAbilityTest : public UGAAbilityBase
+{
+	GENERATED_BODY()
+	
+public:
+	int32 ActivationCount;
+
+	UAFNonInstancedAbilityTest(const FObjectInitializer& ObjectInitializer);
+
+	virtual void NativeOnActivateNonInstanced(FAFAbilityInstanceState& InState, UAFAbilityComponent* InComponent) override;
+};
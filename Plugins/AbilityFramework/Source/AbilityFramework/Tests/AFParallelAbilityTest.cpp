@@ -0,0 +1,26 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AbilityFramework.h"
+#include "../Abilities/AFAbilityUpdateTypes.h"
+#include "AFParallelAbilityTest.h"
+
+UAFParallelAbilityTest::UAFParallelAbilityTest(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	bAlwaysTick = true;
+	bParallelUpdate = true;
+	SnapshotAttributes.Add(FGAAttribute("Health"));
+	DamageTarget = nullptr;
+	Charge = 0;
+}
+
+void UAFParallelAbilityTest::NativeParallelUpdate(float DeltaSeconds, const FAFAbilityFrameSnapshot& InSnapshot,
+	FAFAbilityCommandQueue& OutCommands)
+{
+	Charge += DeltaSeconds * (InSnapshot.AttributeValues[0] / 100.0f);
+	if (Charge >= 1.0f)
+	{
+		Charge -= 1.0f;
+		OutCommands.ApplyEffect(this, DamageEffect, DamageTarget);
+	}
+}
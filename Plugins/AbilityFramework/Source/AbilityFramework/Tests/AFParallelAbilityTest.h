@@ -0,0 +1,28 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "../Abilities/GAAbilityBase.h"
+#include "AFParallelAbilityTest.generated.h"
+
+/**
+ * Ability updated in parallel phase. Charges up by owner Health / 100 per second
+ * and applies DamageEffect to DamageTarget every time charge is full.
+ */
+UCLASS()
+class ABILITYFRAMEWORK_API UAFParallelAbilityTest : public UGAAbilityBase
+{
+	GENERATED_BODY()
+	
+public:
+	UPROPERTY()
+		FGAEffectProperty DamageEffect;
+	UPROPERTY()
+		UObject* DamageTarget;
+	float Charge;
+
+	UAFParallelAbilityTest(const FObjectInitializer& ObjectInitializer);
+
+	virtual void NativeParallelUpdate(float DeltaSeconds, const FAFAbilityFrameSnapshot& InSnapshot,
+		FAFAbilityCommandQueue& OutCommands) override;
+};
@@ -0,0 +1,34 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AbilityFramework.h"
+#include "AFTestPackageMap.h"
+
+bool UAFTestPackageMap::SerializeObject(FArchive& Ar, UClass* InClass, UObject*& Obj, FNetworkGUID* OutNetGUID)
+{
+	FNetworkGUID NetGUID;
+	if (Ar.IsSaving())
+	{
+		if (Obj)
+		{
+			FNetworkGUID* Found = ObjectToGUID.Find(Obj);
+			if (!Found)
+			{
+				//static objects have odd GUIDs, dynamic even, like in FNetGUIDCache.
+				Found = &ObjectToGUID.Add(Obj, FNetworkGUID((ObjectToGUID.Num() + 1) * 2));
+				GUIDToObject.Add(*Found, Obj);
+			}
+			NetGUID = *Found;
+		}
+		Ar << NetGUID;
+	}
+	else
+	{
+		Ar << NetGUID;
+		Obj = NetGUID.IsValid() ? GUIDToObject.FindRef(NetGUID) : nullptr;
+	}
+	if (OutNetGUID)
+	{
+		*OutNetGUID = NetGUID;
+	}
+	return true;
+}
@@ -0,0 +1,22 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "UObject/CoreNet.h"
+#include "AFTestPackageMap.generated.h"
+
+/**
+ * Stands in for UPackageMapClient in tests. Objects are written as packed net GUID,
+ * the same as client package map writes objects which export was already acknowledged.
+ */
+UCLASS()
+class ABILITYFRAMEWORK_API UAFTestPackageMap : public UPackageMap
+{
+	GENERATED_BODY()
+	
+public:
+	TMap<UObject*, FNetworkGUID> ObjectToGUID;
+	TMap<FNetworkGUID, UObject*> GUIDToObject;
+
+	virtual bool SerializeObject(FArchive& Ar, UClass* InClass, UObject*& Obj, FNetworkGUID* OutNetGUID = nullptr) override;
+};
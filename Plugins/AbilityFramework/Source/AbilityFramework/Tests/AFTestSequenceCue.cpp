@@ -0,0 +1,14 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AbilityFramework.h"
+#include "AFTestSequenceCue.h"
+
+AAFTestSequenceCue::AAFTestSequenceCue(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	Root = ObjectInitializer.CreateDefaultSubobject<USceneComponent>(this, "Root");
+	RootComponent = Root;
+	Animated = ObjectInitializer.CreateDefaultSubobject<USceneComponent>(this, "Animated");
+	Animated->SetupAttachment(Root);
+	bShareSequenceEvaluation = true;
+}
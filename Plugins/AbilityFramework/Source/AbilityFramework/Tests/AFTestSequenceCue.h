@@ -0,0 +1,23 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "../Effects/GAEffectCue.h"
+#include "AFTestSequenceCue.generated.h"
+
+/**
+ * Cue with one animated component, opted in to shared sequence evaluation.
+ */
+UCLASS()
+class ABILITYFRAMEWORK_API AAFTestSequenceCue : public AGAEffectCue
+{
+	GENERATED_BODY()
+	
+public:
+	UPROPERTY()
+		USceneComponent* Root;
+	UPROPERTY()
+		USceneComponent* Animated;
+
+	AAFTestSequenceCue(const FObjectInitializer& ObjectInitializer);
+};
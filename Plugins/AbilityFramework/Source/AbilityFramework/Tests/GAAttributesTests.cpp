@@ -10,11 +10,33 @@
 #include "../Attributes/GAAttributesBase.h"
 #include "../Effects/GAEffectExecution.h"
 #include "../Effects/GABlueprintLibrary.h"
+#include "../Effects/AFEffectEventTable.h"
 #include "GAAttributesTest.h"
 #include "GASpellExecutionTest.h"
 #include "GACharacterAttributeTest.h"
 #include "GACustomCalculationTest.h"
 #include "GAffectSpecTestOne.h"
+#include "AFParallelAbilityTest.h"
+#include "AFNonInstancedAbilityTest.h"
+#include "AFEffectExtensionTest.h"
+#include "../Effects/AFEffectExtensionPool.h"
+#include "../Abilities/AFNonInstancedAbility.h"
+#include "Serialization/ArchiveCountMem.h"
+#include "../Abilities/AFAbilityTickManager.h"
+#include "../Abilities/Tasks/GAAbilityTask_TargetData.h"
+#include "../LatentActions/GAWaitAction.h"
+#include "../AFCueManager.h"
+#include "../AFCueSet.h"
+#include "../AFCueReplication.h"
+#include "Serialization/BitWriter.h"
+#include "Serialization/BitReader.h"
+#include "AFTestPackageMap.h"
+#include "AFTestSequenceCue.h"
+#include "../AFSpatialIndex.h"
+#include "../Effects/GAEffectField.h"
+#include "EngineUtils.h"
+#include "Engine/DemoNetDriver.h"
+#include "Engine/CurveTable.h"
 #include "../Effects/ApplicationRequirement/AFAttributeStongerOverride.h"
 #include "../Effects/CustomApplications/AFAttributeDurationOverride.h"
 #include "../Effects/CustomApplications/AFPeriodApplicationOverride.h"
@@ -1536,6 +1558,1392 @@ public:
 		TickWorld(PeriodSecs);
 	}
 
+	void Test_ManyPeriodicEffects()
+	{
+		TArray<FName> OwnedTags;
+		OwnedTags.Add("Ability.Fireball");
+		TArray<FName> AttributeTags;
+		AttributeTags.Add(TEXT("Damage.Fire"));
+
+		TArray<FName> ApplyTags;
+		ApplyTags.Add(TEXT("Damage.Fire"));
+
+		FTagsInput TagsIn;
+		//power of two, so we don't lose precision when subtracting 10k times.
+		const float DamagePerPeriod = 1.0f / 1024.0f;
+		const int32 NumEffects = 10000;
+		const float PeriodSecs = 1.0f;
+
+		FGAEffectProperty Effect = CreateEffectPeriodicSpec(OwnedTags, DamagePerPeriod,
+			EGAAttributeMod::Subtract, TEXT("Health"), EGAEffectStacking::Add,
+			AttributeTags, ApplyTags, TagsIn, UGAGameEffectSpec::StaticClass(),
+			UAFPeriodApplicationAdd::StaticClass());
+
+		float PreVal = DestComponent->GetAttributeValue(FGAAttribute("Health"));
+		TestEqual("Source Health Pre: ", PreVal, 100.0f);
+		FAFFunctionModifier FuncMod;
+		const double ApplyStart = FPlatformTime::Seconds();
+		for (int32 Idx = 0; Idx < NumEffects; Idx++)
+		{
+			UGABlueprintLibrary::ApplyGameEffectToActor(Effect, DestActor, SourceActor, SourceActor, FuncMod);
+		}
+		const double ApplyTime = FPlatformTime::Seconds() - ApplyStart;
+
+		TickWorld(SMALL_NUMBER);
+		TickWorld(PeriodSecs * .1f);
+
+		const double TickStart = FPlatformTime::Seconds();
+		TickWorld(PeriodSecs);
+		const double TickTime = FPlatformTime::Seconds() - TickStart;
+
+		float PostVal = DestComponent->GetAttributeValue(FGAAttribute("Health"));
+		Test->TestEqual(TEXT("Source Health After One Period"), PostVal, 100.0f - (DamagePerPeriod * NumEffects), 0.01f);
+
+		UE_LOG(GameAttributes, Log, TEXT("Test_ManyPeriodicEffects: %d effects, apply %f ms, period tick %f ms, timer record %d bytes per effect"),
+			NumEffects, ApplyTime * 1000.0, TickTime * 1000.0, (int32)sizeof(FAFEffectTimerRecord));
+	}
+
+	void Test_EffectExtensionPool()
+	{
+		UAFEffectExtensionPool* Pool = UAFEffectExtensionPool::Get();
+		UAFEffectExtensionTest* Extension = Cast<UAFEffectExtensionTest>(Pool->Acquire(World, UAFEffectExtensionTest::StaticClass()));
+		TestTrue("Extension created", Extension != nullptr);
+		Extension->Counter = 5;
+		Extension->Values.Add(3);
+		Pool->Release(Extension);
+
+		UAFEffectExtensionTest* Reused = Cast<UAFEffectExtensionTest>(Pool->Acquire(World, UAFEffectExtensionTest::StaticClass()));
+		TestTrue("Extension reused", Reused == Extension);
+		TestEqual("Subclass state reset to defaults", Reused->Counter, 1);
+		TestEqual("Subclass containers reset", Reused->Values.Num(), 0);
+		Pool->Release(Reused);
+
+		UWorld* OtherWorld = UWorld::CreateWorld(EWorldType::Game, false);
+		FWorldContext& OtherContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+		OtherContext.SetCurrentWorld(OtherWorld);
+		UGAEffectExtension* Orphan = Pool->Acquire(OtherWorld, UAFEffectExtensionTest::StaticClass());
+		const int32 NumPools = Pool->GetNumWorldPools();
+		GEngine->DestroyWorldContext(OtherWorld);
+		OtherWorld->DestroyWorld(false);
+		TestEqual("World pool removed on cleanup", Pool->GetNumWorldPools(), NumPools - 1);
+
+		//effect outliving it's world gives extension back after cleanup.
+		Pool->Release(Orphan);
+		TestEqual("Pool not recreated for cleaned up world", Pool->GetNumWorldPools(), NumPools - 1);
+		TestTrue("Extension destroyed instead of pooled", Orphan->IsPendingKill());
+	}
+	void Test_BakedCurveExtrapolation()
+	{
+		FRichCurve Curve;
+		Curve.SetKeyInterpMode(Curve.AddKey(0, 0), RCIM_Linear);
+		Curve.SetKeyInterpMode(Curve.AddKey(5, 20), RCIM_Linear);
+		Curve.SetKeyInterpMode(Curve.AddKey(10, 100), RCIM_Linear);
+
+		const ERichCurveExtrapolation Modes[] = { RCCE_Constant, RCCE_Linear, RCCE_Cycle, RCCE_CycleWithOffset, RCCE_Oscillate };
+		const float Times[] = { -23.0f, -1.0f, 2.5f, 7.5f, 12.5f, 27.0f };
+		for (ERichCurveExtrapolation Mode : Modes)
+		{
+			Curve.PreInfinityExtrap = Mode;
+			Curve.PostInfinityExtrap = Mode;
+			FAFBakedCurve Baked;
+			//keys are on samples, so linear segments are exact.
+			Baked.Bake(Curve, 21);
+			for (float Time : Times)
+			{
+				TestEqual(FString::Printf(TEXT("Baked curve extrapolation %d at %f"), (int32)Mode, Time),
+					Baked.Eval(Time), Curve.Eval(Time), 0.01f);
+			}
+			TestTrue("Validation checks outside of key range", Baked.GetMaxError(Curve) < 0.01f);
+		}
+		//baked as constant, source extrapolates, validation must notice.
+		FAFBakedCurve Clamped;
+		Curve.PreInfinityExtrap = RCCE_Constant;
+		Curve.PostInfinityExtrap = RCCE_Constant;
+		Clamped.Bake(Curve, 21);
+		Curve.PostInfinityExtrap = RCCE_Linear;
+		TestTrue("Extrapolation error detected", Clamped.GetMaxError(Curve) > 1.0f);
+
+		//value is twice instigator Health, in and out of baked range.
+		UCurveTable* Table = NewObject<UCurveTable>();
+		Table->CreateTableFromCSVString(TEXT("---,0,1000\r\nRow,0,2000"));
+		UGAGameEffectSpec* Spec = NewObject<UGAGameEffectSpec>();
+		Spec->Duration.CalculationType = EGAMagnitudeCalculation::CurveBased;
+		Spec->Duration.CurveBased.Source = EGAAttributeSource::Instigator;
+		Spec->Duration.CurveBased.Attribute = FGAAttribute("Health");
+		Spec->Duration.CurveBased.CurveTable.CurveTable = Table;
+		Spec->Duration.CurveBased.CurveTable.RowName = TEXT("Row");
+		FHitResult Hit(ForceInit);
+		FGAEffectContext Context = UGABlueprintLibrary::MakeContext(DestActor, SourceActor, nullptr, SourceActor, Hit);
+		const float Health = SourceComponent->GetAttributeValue(FGAAttribute("Health"));
+
+		//spec created at runtime is never loaded, evaluation doesn't bake it.
+		TestEqual("Evaluated from curve", Spec->Duration.GetFloatValue(Context), Health * 2, 0.01f);
+		TestFalse("Evaluation doesn't bake", Spec->Duration.CurveBased.BakedCurve.IsBaked());
+		Spec->BakeCurves(true);
+		TestTrue("Baked on game thread", Spec->Duration.CurveBased.BakedCurve.IsBaked());
+		TestEqual("Evaluated from baked curve", Spec->Duration.GetFloatValue(Context), Health * 2, 0.01f);
+#if WITH_EDITOR
+		//reimported curve table rebakes specs using it.
+		Table->CreateTableFromCSVString(TEXT("---,0,1000\r\nRow,0,4000"));
+		FPropertyChangedEvent ChangedEvent(nullptr);
+		UGAGameEffectSpec::HandleObjectPropertyChanged(Table, ChangedEvent);
+		TestEqual("Baked curve invalidated", Spec->Duration.GetFloatValue(Context), Health * 4, 0.01f);
+#endif //WITH_EDITOR
+	}
+	void Test_AttributeCaptureModes()
+	{
+		UGAGameEffectSpec* Spec = NewObject<UGAGameEffectSpec>();
+		TestTrue("Live capture by default", Spec->AttributeCapture == EAFAttributeCapture::Live);
+		Spec->AtributeModifier.Magnitude.CalculationType = EGAMagnitudeCalculation::AttributeBased;
+		Spec->AtributeModifier.Magnitude.AttributeBased.Source = EGAAttributeSource::Target;
+		Spec->AtributeModifier.Magnitude.AttributeBased.Attribute = FGAAttribute("Health");
+
+		FGAEffectContext LiveContext = UGABlueprintLibrary::MakeContext(DestActor, SourceActor, SourceActor, SourceActor, FHitResult());
+		Spec->CaptureAttributes(LiveContext);
+		TestTrue("Live spec captures nothing", LiveContext.Snapshot.IsEmpty());
+
+		//never loaded or saved, captures from magnitudes on application.
+		Spec->AttributeCapture = EAFAttributeCapture::Snapshot;
+		FGAEffectContext Context = UGABlueprintLibrary::MakeContext(DestActor, SourceActor, SourceActor, SourceActor, FHitResult());
+		Spec->CaptureAttributes(Context);
+		const float* Captured = Context.Snapshot.Find(EGAAttributeSource::Target, TEXT("Health"));
+		TestTrue("Runtime spec captured target attribute", Captured != nullptr);
+		if (Captured)
+		{
+			TestEqual("Captured current value", *Captured, DestComponent->GetAttributeValue(FGAAttribute("Health")));
+		}
+
+		TArray<FName> OwnedTags;
+		OwnedTags.Add("Ability.Fireball");
+		FGAEffectProperty Effect = CreateEffectSpec(OwnedTags, 10,
+			EGAAttributeMod::Subtract, "Health", UGAGameEffectSpec::StaticClass());
+		FAFFunctionModifier FuncMod;
+		UGABlueprintLibrary::ApplyGameEffectToActor(Effect, DestActor, SourceActor, SourceActor, FuncMod);
+		UGABlueprintLibrary::ApplyGameEffectToActor(Effect, TargetOne, SourceActor, SourceActor, FuncMod);
+		TestTrue("Instant effect handle cached", Effect.Handle.IsValid());
+		if (Effect.Handle.IsValid())
+		{
+			TestTrue("Cached instant effect has context of last application", Effect.Handle.GetContextRef().Target.Get() == TargetOne);
+		}
+	}
+	void Test_BatchCustomCalculation()
+	{
+		const int32 NumContexts = 10000;
+		FHitResult Hit(ForceInit);
+		FGAEffectContext Context = UGABlueprintLibrary::MakeContext(DestActor, SourceActor, nullptr, SourceActor, Hit);
+
+		TArray<FGAEffectHandle> Handles;
+		TArray<const FGAEffectContext*> Contexts;
+		Handles.SetNum(NumContexts);
+		Contexts.Init(&Context, NumContexts);
+
+		FGAMagnitude Magnitude;
+		Magnitude.CalculationType = EGAMagnitudeCalculation::CustomCalculation;
+
+		//handle only calculation has no effect to read from (ie. Duration, Period).
+		Magnitude.Custom.CustomCalculation = NewObject<UGACustomCalculationHandleTest>();
+		TestEqual("Handle Calculation Without Handle", Magnitude.GetFloatValue(Context), 0.0f);
+
+		//context only path, previously always returned 0.
+		Magnitude.Custom.CustomCalculation = NewObject<UGACustomCalculationTest>();
+		const float Expected = SourceComponent->GetAttributeValue(FGAAttribute("Health")) * 0.1f;
+		TestEqual("Custom Calculation From Context", Magnitude.GetFloatValue(Context), Expected);
+
+		TArray<float> LoopValues;
+		const double LoopStart = FPlatformTime::Seconds();
+		Magnitude.GetFloatValues(Handles, Contexts, LoopValues);
+		const double LoopTime = FPlatformTime::Seconds() - LoopStart;
+
+		Magnitude.Custom.CustomCalculation = NewObject<UGACustomCalculationBatchTest>();
+		TArray<float> BatchValues;
+		const double BatchStart = FPlatformTime::Seconds();
+		Magnitude.GetFloatValues(Handles, Contexts, BatchValues);
+		const double BatchTime = FPlatformTime::Seconds() - BatchStart;
+
+		TestEqual("Batch Num", BatchValues.Num(), NumContexts);
+		TestEqual("Default Adapter Value", LoopValues.Last(), Expected);
+		TestEqual("Batch Value", BatchValues.Last(), Expected);
+
+		UE_LOG(GameAttributes, Log, TEXT("Test_BatchCustomCalculation: %d magnitudes, default adapter %f ms, batch %f ms"),
+			NumContexts, LoopTime * 1000.0, BatchTime * 1000.0);
+	}
+
+	void Test_AlwaysTickAbilityCollected()
+	{
+		UAFAbilityTickManager* TickManager = UAFAbilityTickManager::Get();
+		const int32 NumTicking = TickManager->GetNumTickingAbilities(World);
+		TWeakObjectPtr<UGAAbilityBase> WeakAbility;
+		{
+			UGAAbilityBase* Ability = NewObject<UGAAbilityBase>(SourceComponent);
+			Ability->AbilityComponent = SourceComponent;
+			Ability->POwner = SourceActor;
+			Ability->World = World;
+			Ability->bAlwaysTick = true;
+			Ability->UpdateTickRegistration();
+			WeakAbility = Ability;
+		}
+		TestEqual("Always ticking ability registered", TickManager->GetNumTickingAbilities(World), NumTicking + 1);
+
+		//nothing else references ability, tick manager must not keep it alive.
+		CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+		TestFalse("Always ticking ability garbage collected", WeakAbility.IsValid());
+		TestEqual("Collected ability deregistered", TickManager->GetNumTickingAbilities(World), NumTicking);
+		TickWorld(SMALL_NUMBER);
+	}
+	void Test_CancelledAbilityStopsTicking()
+	{
+		TArray<FName> OwnedTags;
+		OwnedTags.Add("Ability.Fireball");
+		UAFAbilityTickManager* TickManager = UAFAbilityTickManager::Get();
+		const int32 NumTicking = TickManager->GetNumTickingAbilities(World);
+		UGAAbilityBase* Ability = CreateCooldownAbility(SourceComponent, SourceActor, FGAEffectProperty(), FGameplayTag());
+		Ability->ActivationEffect = CreateEffectDurationSpec(OwnedTags, 0, EGAAttributeMod::Add, "Health", EGAEffectStacking::Override,
+			TArray<FName>(), TArray<FName>(), FTagsInput(), UAFEffectApplicationRequirement::StaticClass(),
+			UAFEffectCustomApplication::StaticClass(), UGAffectSpecTestOne::StaticClass());
+
+		Ability->StartActivation(true);
+		TestTrue("Activating", Ability->IsActivating());
+		TestEqual("Activating ability registered", TickManager->GetNumTickingAbilities(World), NumTicking + 1);
+
+		Ability->CancelActivation();
+		TestFalse("Not activating after cancel", Ability->IsActivating());
+		TestEqual("Cancelled ability deregistered", TickManager->GetNumTickingAbilities(World), NumTicking);
+		TickWorld(SMALL_NUMBER);
+	}
+	UGAAbilityBase* CreateCooldownAbility(UAFAbilityComponent* InComponent, APawn* InOwner,
+		const FGAEffectProperty& InCooldown, const FGameplayTag& InGroup)
+	{
+		UGAAbilityBase* Ability = NewObject<UGAAbilityBase>(InComponent);
+		Ability->AbilityComponent = InComponent;
+		Ability->POwner = InOwner;
+		Ability->World = World;
+		Ability->CooldownEffect = InCooldown;
+		Ability->CooldownGroup = InGroup;
+		Ability->InitAbility();
+		return Ability;
+	}
+	void Test_AbilityCooldownGroups()
+	{
+		TArray<FName> OwnedTags;
+		OwnedTags.Add("Ability.Fireball");
+		FGAEffectProperty Cooldown = CreateEffectDurationSpec(OwnedTags, 0, EGAAttributeMod::Add, "Health", EGAEffectStacking::Override);
+		const FGameplayTag Group = RequestTag("Ability.Rifle");
+		UGAAbilityBase* First = CreateCooldownAbility(SourceComponent, SourceActor, Cooldown, Group);
+		UGAAbilityBase* Second = CreateCooldownAbility(SourceComponent, SourceActor, Cooldown, Group);
+		UGAAbilityBase* Ungrouped = CreateCooldownAbility(SourceComponent, SourceActor, Cooldown, FGameplayTag());
+		//same group on other owner, must not share cooldown.
+		UGAAbilityBase* Other = CreateCooldownAbility(DestComponent, DestActor, Cooldown, Group);
+
+		TestTrue("Can use before cooldown", First->CanUseAbility());
+		First->ApplyCooldownEffect();
+		TestTrue("First on cooldown", First->IsOnCooldown());
+		TestFalse("First can't be used", First->CanUseAbility());
+		TestTrue("Group shares cooldown", Second->IsOnCooldown());
+		TestFalse("Ungrouped not on cooldown", Ungrouped->IsOnCooldown());
+		TestFalse("Other owner not on cooldown", Other->IsOnCooldown());
+
+		TickWorld(11);
+		TestFalse("First cooldown expired", First->IsOnCooldown());
+		TestFalse("Group cooldown expired", Second->IsOnCooldown());
+
+		//client path, effect info arrives by replication and is removed by it.
+		FGAEffectContainer& OtherContainer = DestComponent->GameEffectContainer;
+		FAFEffectRepInfo RepInfo(World->GetTimeSeconds(), 0, 10, 0);
+		RepInfo.EffectClass = Cooldown.GetClass();
+		RepInfo.PostReplicatedAdd(OtherContainer);
+		TestTrue("Replicated cooldown cached", Other->IsOnCooldown());
+		TestFalse("Replicated cooldown blocks use", Other->CanUseAbility());
+		TestFalse("Replicated cooldown stays on its owner", First->IsOnCooldown());
+		RepInfo.PreReplicatedRemove(OtherContainer);
+		TestFalse("Replicated cooldown removed", Other->IsOnCooldown());
+		TickWorld(SMALL_NUMBER);
+	}
+	/* Net driver without server connection makes world (and components) listen server. */
+	void BeginServerNetMode()
+	{
+		World->DemoNetDriver = NewObject<UDemoNetDriver>(World);
+	}
+	void EndServerNetMode()
+	{
+		World->DemoNetDriver = nullptr;
+	}
+	void Test_AbilityCooldownOnServer()
+	{
+		TArray<FName> OwnedTags;
+		OwnedTags.Add("Ability.Fireball");
+		FGAEffectProperty Cooldown = CreateEffectDurationSpec(OwnedTags, 0, EGAAttributeMod::Add, "Health", EGAEffectStacking::Override);
+		UGAAbilityBase* Ability = CreateCooldownAbility(SourceComponent, SourceActor, Cooldown, FGameplayTag());
+
+		BeginServerNetMode();
+		TestTrue("Server net mode", SourceComponent->GetNetMode() != NM_Standalone && SourceComponent->GetNetMode() != NM_Client);
+		Ability->ApplyCooldownEffect();
+		//server doesn't keep replicated effect infos.
+		TestEqual("No replicated info on server", SourceComponent->GameEffectContainer.GetEndTime(Ability->CooldownEffectHandle), 0.0f);
+		TestTrue("On cooldown on server", Ability->IsOnCooldown());
+		TestFalse("Can't use on server", Ability->CanUseAbility());
+		EndServerNetMode();
+
+		TickWorld(11);
+		TestFalse("Server cooldown expired", Ability->IsOnCooldown());
+		TestTrue("Can use after cooldown", Ability->CanUseAbility());
+	}
+	void Test_ParallelAbilityUpdate()
+	{
+		const int32 NumCasters = 1000;
+		const float DamagePerCast = 1.0f / 1024.0f;
+		TArray<FName> OwnedTags;
+		OwnedTags.Add("Ability.Fireball");
+		FGAEffectProperty Effect = CreateEffectSpec(OwnedTags, DamagePerCast,
+			EGAAttributeMod::Subtract, "Health", UGAGameEffectSpec::StaticClass());
+
+		TArray<UAFParallelAbilityTest*> Casters;
+		for (int32 Idx = 0; Idx < NumCasters; Idx++)
+		{
+			UAFParallelAbilityTest* Ability = NewObject<UAFParallelAbilityTest>(SourceComponent);
+			Ability->AbilityComponent = SourceComponent;
+			Ability->POwner = SourceActor;
+			Ability->World = World;
+			Ability->DamageEffect = Effect;
+			Ability->DamageTarget = DestActor;
+			Ability->UpdateTickRegistration();
+			Casters.Add(Ability);
+		}
+		float PreVal = DestComponent->GetAttributeValue(FGAAttribute("Health"));
+		TestEqual("Target Health Pre: ", PreVal, 100.0f);
+
+		//charge is full after one second, every caster should hit exactly once.
+		TickWorld(1.05f);
+		float PostVal = DestComponent->GetAttributeValue(FGAAttribute("Health"));
+		TestEqual("Target Health After Casts: ", PostVal, 100.0f - (DamagePerCast * NumCasters));
+
+		//scaling, same frames with parallel phase forced to game thread and on workers.
+		IConsoleVariable* ParallelVar = IConsoleManager::Get().FindConsoleVariable(TEXT("AbilityFramework.ParallelAbilityUpdate"));
+		const int32 NumFrames = 100;
+		double Times[2] = { 0, 0 };
+		for (int32 Mode = 0; Mode < 2; Mode++)
+		{
+			if (ParallelVar)
+			{
+				ParallelVar->Set(Mode);
+			}
+			const double Start = FPlatformTime::Seconds();
+			for (int32 Frame = 0; Frame < NumFrames; Frame++)
+			{
+				World->Tick(ELevelTick::LEVELTICK_All, 0.001f);
+				GFrameCounter++;
+			}
+			Times[Mode] = FPlatformTime::Seconds() - Start;
+		}
+		if (ParallelVar)
+		{
+			ParallelVar->Set(1);
+		}
+		for (UAFParallelAbilityTest* Ability : Casters)
+		{
+			UAFAbilityTickManager::Get()->RemoveAbility(Ability);
+		}
+
+		UE_LOG(GameAttributes, Log, TEXT("Test_ParallelAbilityUpdate: %d casters, %d frames, game thread %f ms, parallel %f ms"),
+			NumCasters, NumFrames, Times[0] * 1000.0, Times[1] * 1000.0);
+	}
+	void Test_NonInstancedAbility()
+	{
+		TArray<FName> OwnedTags;
+		OwnedTags.Add("Ability.Fireball");
+		UAFNonInstancedAbilityTest* CDO = GetMutableDefault<UAFNonInstancedAbilityTest>();
+		//CDO is shared with everything else, restored at the end.
+		FGAEffectProperty SavedCooldown;
+		SavedCooldown = CDO->CooldownEffect;
+		CDO->CooldownEffect = CreateEffectDurationSpec(OwnedTags, 0, EGAAttributeMod::Add, "Health", EGAEffectStacking::Override);
+		CDO->ActivationCount = 0;
+
+		FAFNonInstancedAbilityContainer States;
+		States.Initialize(SourceComponent);
+		int32 Index = States.AddAbility(UAFNonInstancedAbilityTest::StaticClass());
+		TestTrue("Can use before activation", States.CanUseAbility(Index));
+		TestTrue("First activation", States.ActivateAbility(Index));
+		TestFalse("Can use on cooldown", States.CanUseAbility(Index));
+		TestFalse("Second activation", States.ActivateAbility(Index));
+		TestEqual("Activation count", CDO->ActivationCount, 1);
+		TestFalse("Activation doesn't write handle to CDO", CDO->CooldownEffect.Handle.IsValid());
+		TestFalse("Activation doesn't initialize CDO property", CDO->CooldownEffect.IsInitialized());
+		TickWorld(11);
+		TestTrue("Can use after cooldown", States.CanUseAbility(Index));
+
+		//memory of the same set of abilities for single AI, as objects and as states.
+		const int32 AbilitiesPerAI = 4;
+		SIZE_T InstancedBytes = 0;
+		for (int32 Idx = 0; Idx < AbilitiesPerAI; Idx++)
+		{
+			UAFNonInstancedAbilityTest* Ability = NewObject<UAFNonInstancedAbilityTest>(SourceComponent);
+			Ability->AbilityComponent = SourceComponent;
+			Ability->POwner = SourceActor;
+			Ability->World = World;
+			Ability->CooldownEffect = CDO->CooldownEffect;
+			Ability->InitAbility();
+			FArchiveCountMem CountMem(Ability);
+			InstancedBytes += Ability->GetClass()->GetStructureSize() + CountMem.GetMax();
+			Ability->MarkPendingKill();
+		}
+		FAFNonInstancedAbilityContainer AIStates;
+		AIStates.Initialize(SourceComponent);
+		for (int32 Idx = 0; Idx < AbilitiesPerAI; Idx++)
+		{
+			int32 StateIdx = AIStates.Abilities.AddDefaulted();
+			AIStates.Abilities[StateIdx].AbilityClass = UAFNonInstancedAbilityTest::StaticClass();
+		}
+		const SIZE_T NonInstancedBytes = AIStates.GetAllocatedSize();
+		TestTrue("Non-instanced is smaller", NonInstancedBytes < InstancedBytes);
+
+		UE_LOG(GameAttributes, Log, TEXT("Test_NonInstancedAbility: %d abilities per AI, instanced %d bytes, non-instanced %d bytes (%d per ability state)"),
+			AbilitiesPerAI, (int32)InstancedBytes, (int32)NonInstancedBytes, (int32)sizeof(FAFAbilityInstanceState));
+		CDO->CooldownEffect = SavedCooldown;
+		CDO->ActivationCount = 0;
+	}
+	void Test_NonInstancedAbilityOnServer()
+	{
+		TArray<FName> OwnedTags;
+		OwnedTags.Add("Ability.Fireball");
+		UAFNonInstancedAbilityTest* CDO = GetMutableDefault<UAFNonInstancedAbilityTest>();
+		FGAEffectProperty SavedCooldown;
+		SavedCooldown = CDO->CooldownEffect;
+		FGAEffectProperty SavedActivation;
+		SavedActivation = CDO->ActivationEffect;
+		CDO->CooldownEffect = CreateEffectDurationSpec(OwnedTags, 0, EGAAttributeMod::Add, "Health", EGAEffectStacking::Override);
+		CDO->ActivationEffect = CreateEffectDurationSpec(OwnedTags, 0, EGAAttributeMod::Add, "Health", EGAEffectStacking::Override,
+			TArray<FName>(), TArray<FName>(), FTagsInput(), UAFEffectApplicationRequirement::StaticClass(),
+			UAFEffectCustomApplication::StaticClass(), UGAffectSpecTestOne::StaticClass());
+
+		//AI owners only exist on server.
+		BeginServerNetMode();
+		FAFNonInstancedAbilityContainer States;
+		States.Initialize(SourceComponent);
+		int32 Index = States.AddAbility(UAFNonInstancedAbilityTest::StaticClass());
+		TestTrue("Activation on server", States.ActivateAbility(Index));
+		const FAFAbilityInstanceState& State = States.Abilities[Index];
+		const FGAEffectHandle ActivationHandle = State.ActivationHandle;
+		TestTrue("Activating on server", State.IsActivating(World->GetTimeSeconds()));
+		TestFalse("On cooldown on server", States.CanUseAbility(Index));
+		TestFalse("Second activation on server", States.ActivateAbility(Index));
+
+		States.FinishAbility(Index);
+		TestFalse("Activation effect removed", SourceComponent->GameEffectContainer.IsEffectActive(ActivationHandle));
+		TestTrue("Cooldown stays after finish", SourceComponent->GameEffectContainer.IsEffectActive(State.CooldownHandle));
+		TestFalse("Still on cooldown after finish", States.CanUseAbility(Index));
+		EndServerNetMode();
+
+		TickWorld(11);
+		TestTrue("Can use after cooldown", States.CanUseAbility(Index));
+		CDO->CooldownEffect = SavedCooldown;
+		CDO->ActivationEffect = SavedActivation;
+	}
+	void Test_AsyncTargetDataTrace()
+	{
+		const int32 NumTasks = 500;
+		double Times[2] = { 0, 0 };
+		for (int32 Mode = 0; Mode < 2; Mode++)
+		{
+			const bool bAsync = Mode == 1;
+			TArray<UGAAbilityTask_TargetData*> Tasks;
+			for (int32 Idx = 0; Idx < NumTasks; Idx++)
+			{
+				UGAAbilityBase* Ability = NewObject<UGAAbilityBase>(SourceComponent);
+				Ability->AbilityComponent = SourceComponent;
+				Ability->POwner = SourceActor;
+				Ability->World = World;
+				Tasks.Add(UGAAbilityTask_TargetData::CreateTargetDataTask(Ability, NAME_None,
+					false, false, false, EGASConfirmType::Instant, 10000, bAsync));
+			}
+			//game thread time spent in targeting.
+			const double Start = FPlatformTime::Seconds();
+			for (UGAAbilityTask_TargetData* Task : Tasks)
+			{
+				Task->ReadyForActivation();
+			}
+			Times[Mode] = FPlatformTime::Seconds() - Start;
+
+			if (bAsync)
+			{
+				TestTrue("Async trace pending after activation", Tasks[0]->IsActive());
+				//issued this frame, delivered in the next one.
+				TickWorld(0.02f);
+			}
+			TestTrue("Target data received", Tasks[0]->IsFinished());
+			TestTrue("Target data received", Tasks.Last()->IsFinished());
+		}
+		UE_LOG(GameAttributes, Log, TEXT("Test_AsyncTargetDataTrace: %d tasks, sync %f ms, async %f ms on game thread"),
+			NumTasks, Times[0] * 1000.0, Times[1] * 1000.0);
+	}
+	void Test_SpatialIndexQueries()
+	{
+		const int32 NumActors = 2000;
+		const int32 NumQueries = 1000;
+		const float Spacing = 200;
+		const float Radius = 500;
+		const int32 Side = FMath::CeilToInt(FMath::Sqrt((float)NumActors));
+		TArray<AGACharacterAttributeTest*> Actors;
+		for (int32 Idx = 0; Idx < NumActors; Idx++)
+		{
+			FVector Location((Idx % Side) * Spacing, (Idx / Side) * Spacing, 0);
+			AGACharacterAttributeTest* Actor = World->SpawnActor<AGACharacterAttributeTest>(Location, FRotator::ZeroRotator);
+			Actors.Add(Actor);
+		}
+		//actors created by test suite are in the index as well.
+		TArray<AActor*> AllActors;
+		for (TActorIterator<AGACharacterAttributeTest> It(World); It; ++It)
+		{
+			AllActors.Add(*It);
+		}
+
+		FRandomStream Random(1234);
+		TArray<FVector> Centers;
+		for (int32 Idx = 0; Idx < NumQueries; Idx++)
+		{
+			Centers.Add(FVector(Random.FRandRange(0, Side * Spacing), Random.FRandRange(0, Side * Spacing), 0));
+		}
+		UAFSpatialIndex* Index = UAFSpatialIndex::Get();
+		TArray<UAFAbilityComponent*> Found;
+		Index->QueryRadius(World, FVector::ZeroVector, 1, FGameplayTagContainer(), Found);
+
+		//results match brute force.
+		for (int32 Idx = 0; Idx < 10; Idx++)
+		{
+			Found.Reset();
+			Index->QueryRadius(World, Centers[Idx], Radius, FGameplayTagContainer(), Found);
+			int32 Expected = 0;
+			for (AActor* Actor : AllActors)
+			{
+				if (Actor && FVector::DistSquared(Actor->GetActorLocation(), Centers[Idx]) <= Radius * Radius)
+				{
+					Expected++;
+				}
+			}
+			TestEqual("Radius query count", Found.Num(), Expected);
+		}
+		//moved actor changes cell.
+		Actors[0]->SetActorLocation(FVector(-5000, -5000, 0));
+		GFrameCounter++;
+		Found.Reset();
+		Index->QueryRadius(World, FVector(-5000, -5000, 0), 10, FGameplayTagContainer(), Found);
+		TestEqual("Moved actor found", Found.Num(), 1);
+		Found.Reset();
+		Index->QueryBox(World, FBox(FVector(-5100, -5100, -100), FVector(-4900, -4900, 100)), FGameplayTagContainer(), Found);
+		TestEqual("Moved actor found in box", Found.Num(), 1);
+		Found.Reset();
+		Index->QueryCone(World, FVector(-5500, -5000, 0), FVector(1, 0, 0), 1000, 10, FGameplayTagContainer(), Found);
+		TestEqual("Moved actor found in cone", Found.Num(), 1);
+		Found.Reset();
+		Index->QueryCone(World, FVector(-5500, -5000, 0), FVector(-1, 0, 0), 1000, 10, FGameplayTagContainer(), Found);
+		TestEqual("Actor behind cone", Found.Num(), 0);
+		Found.Reset();
+		FGameplayTagContainer RequiredTags;
+		RequiredTags.AddTag(RequestTag("Damage"));
+		Index->QueryRadius(World, FVector(-5000, -5000, 0), 10, RequiredTags, Found);
+		TestEqual("Filtered by required tags", Found.Num(), 0);
+
+		double IndexTime = 0;
+		int32 IndexHits = 0;
+		{
+			const double Start = FPlatformTime::Seconds();
+			for (const FVector& Center : Centers)
+			{
+				Found.Reset();
+				Index->QueryRadius(World, Center, Radius, FGameplayTagContainer(), Found);
+				IndexHits += Found.Num();
+			}
+			IndexTime = FPlatformTime::Seconds() - Start;
+		}
+		double PhysicsTime = 0;
+		int32 PhysicsHits = 0;
+		{
+			TArray<FOverlapResult> Overlaps;
+			const double Start = FPlatformTime::Seconds();
+			for (const FVector& Center : Centers)
+			{
+				Overlaps.Reset();
+				Found.Reset();
+				World->OverlapMultiByObjectType(Overlaps, Center, FQuat::Identity,
+					FCollisionObjectQueryParams(ECC_Pawn), FCollisionShape::MakeSphere(Radius));
+				for (const FOverlapResult& Overlap : Overlaps)
+				{
+					if (IAFAbilityInterface* Interface = Cast<IAFAbilityInterface>(Overlap.GetActor()))
+					{
+						Found.AddUnique(Interface->GetAbilityComp());
+					}
+				}
+				PhysicsHits += Found.Num();
+			}
+			PhysicsTime = FPlatformTime::Seconds() - Start;
+		}
+		for (AGACharacterAttributeTest* Actor : Actors)
+		{
+			World->EditorDestroyActor(Actor, false);
+		}
+		UE_LOG(GameAttributes, Log, TEXT("Test_SpatialIndexQueries: %d actors, %d queries, index %f ms (%d hits), physics overlap %f ms (%d hits)"),
+			NumActors, NumQueries, IndexTime * 1000.0, IndexHits, PhysicsTime * 1000.0, PhysicsHits);
+	}
+	void Test_EffectFieldPulse()
+	{
+		TArray<FName> OwnedTags;
+		OwnedTags.Add("Ability.Fireball");
+		FGAEffectProperty Effect = CreateEffectSpec(OwnedTags, 5,
+			EGAAttributeMod::Subtract, "Health", UGAGameEffectSpec::StaticClass());
+		//actors are shared by whole suite, restored at the end.
+		const FTransform SourceTransform = SourceActor->GetActorTransform();
+		const FTransform DestTransform = DestActor->GetActorTransform();
+		SourceActor->SetActorLocation(FVector(-10000, 0, 0));
+
+		AGAEffectField* Field = World->SpawnActorDeferred<AGAEffectField>(AGAEffectField::StaticClass(),
+			FTransform(DestActor->GetActorLocation()), nullptr, SourceActor);
+		Field->Effect = Effect;
+		Field->Radius = 50;
+		Field->PulsePeriod = 1;
+		Field->bApplyEveryPulse = true;
+		Field->bIsFieldPersistent = true;
+		Field->Lifetime = 0;
+		Field->FinishSpawning(FTransform(DestActor->GetActorLocation()));
+
+		//first pulse on spawn.
+		TestEqual("Target Health after spawn pulse", DestComponent->GetAttributeValue(FGAAttribute("Health")), 95.0f);
+		TestEqual("Source outside field", SourceComponent->GetAttributeValue(FGAAttribute("Health")), 100.0f);
+		TickWorld(1.05f);
+		TestEqual("Target Health after second pulse", DestComponent->GetAttributeValue(FGAAttribute("Health")), 90.0f);
+
+		DestActor->SetActorLocation(FVector(10000, 0, 0));
+		TickWorld(1.0f);
+		TestEqual("Target Health after leaving field", DestComponent->GetAttributeValue(FGAAttribute("Health")), 90.0f);
+		Field->DestroyField();
+
+		//duration effect reapplied every pulse, every application must be removed with the field.
+		DestActor->SetActorLocation(FVector(0, 0, 0));
+		const int32 EffectsBefore = DestComponent->GameEffectContainer.GetEffectsNum();
+		AGAEffectField* DurationField = World->SpawnActorDeferred<AGAEffectField>(AGAEffectField::StaticClass(),
+			FTransform(DestActor->GetActorLocation()), nullptr, SourceActor);
+		DurationField->Effect = CreateEffectDurationSpec(OwnedTags, 0, EGAAttributeMod::Add, "Health", EGAEffectStacking::Add);
+		DurationField->Radius = 50;
+		DurationField->PulsePeriod = 1;
+		DurationField->bApplyEveryPulse = true;
+		DurationField->bRemoveOnExit = true;
+		DurationField->bIsFieldPersistent = true;
+		DurationField->Lifetime = 0;
+		DurationField->FinishSpawning(FTransform(DestActor->GetActorLocation()));
+		TickWorld(1.05f);
+		TickWorld(1.05f);
+		TestTrue("Duration effects applied by field", DestComponent->GameEffectContainer.GetEffectsNum() > EffectsBefore);
+		DurationField->DestroyField();
+		TestEqual("All field effects removed", DestComponent->GameEffectContainer.GetEffectsNum(), EffectsBefore);
+		SourceActor->SetActorTransform(SourceTransform);
+		DestActor->SetActorTransform(DestTransform);
+	}
+	void Test_AbilityTaskPooling()
+	{
+		UGAAbilityBase* Ability = NewObject<UGAAbilityBase>(SourceComponent);
+		Ability->AbilityComponent = SourceComponent;
+		Ability->POwner = SourceActor;
+		Ability->World = World;
+
+		UGAAbilityTask_TargetData* First = UGAAbilityTask_TargetData::CreateTargetDataTask(Ability, NAME_None,
+			false, false, false, EGASConfirmType::Instant, 10000);
+		UGAAbilityTask_TargetData* Second = UGAAbilityTask_TargetData::CreateTargetDataTask(Ability, NAME_None,
+			false, false, false, EGASConfirmType::Instant, 10000);
+		TestTrue("Unnamed tasks are not shared while active", First != Second);
+
+		//sync trace ends task right away.
+		const uint32 FirstSerial = First->GetPoolSerial();
+		First->ReadyForActivation();
+		TestTrue("Pooled task finished", First->IsFinished());
+		TestFalse("Pooled task not destroyed", First->IsPendingKill());
+		TestTrue("Serial changed on release", First->GetPoolSerial() != FirstSerial);
+
+		UGAAbilityTask_TargetData* Reused = UGAAbilityTask_TargetData::CreateTargetDataTask(Ability, NAME_None,
+			false, false, false, EGASConfirmType::Instant, 10000);
+		TestTrue("Ended task reused", Reused == First);
+		TestTrue("Reused task awaiting activation", Reused->GetState() == EGameplayTaskState::AwaitingActivation);
+		//holder from before recycle must not end task of new user.
+		TestFalse("Stale serial can't end task", Reused->EndTaskIfSerial(FirstSerial));
+		TestTrue("Reused task still awaiting activation", Reused->GetState() == EGameplayTaskState::AwaitingActivation);
+		Reused->ReadyForActivation();
+		TestTrue("Reused task finished again", Reused->IsFinished());
+
+		UGAAbilityTask_TargetData* Named = UGAAbilityTask_TargetData::CreateTargetDataTask(Ability, "Named",
+			false, false, false, EGASConfirmType::Instant, 10000);
+		TestTrue("Named task is not taken from pool", Named != First);
+		TestTrue("Named task is cached", UGAAbilityTask_TargetData::CreateTargetDataTask(Ability, "Named",
+			false, false, false, EGASConfirmType::Instant, 10000) == Named);
+	}
+	void Test_LatentActionScheduler()
+	{
+		UGAWaitAction* Short = UGAWaitAction::NewGAWaitAction(SourceActor, 0.5f);
+		UGAWaitAction* Long = UGAWaitAction::NewGAWaitAction(SourceActor, 1.0f);
+		TickWorld(0.6f);
+		TestTrue("Short wait finished", Short->IsPendingKill());
+		TestFalse("Long wait still waiting", Long->IsPendingKill());
+		TickWorld(0.5f);
+		TestTrue("Long wait finished", Long->IsPendingKill());
+	}
+	void Test_CuePoolSoak()
+	{
+		const int32 NumRounds = 200;
+		const int32 InstigatorsPerRound = 20;
+		UAFCueManager* Manager = UAFCueManager::Get(World);
+		UAFCueSet* TestCueSet = NewObject<UAFCueSet>();
+		FGameplayTagContainer CueTags;
+		CueTags.AddTag(RequestTag("GameplayCue.Burning"));
+		CueTags.AddTag(RequestTag("Damage.Fire"));
+		for (const FGameplayTag& Tag : CueTags)
+		{
+			TestCueSet->CueClasses.Add(Tag, AGAEffectCue::StaticClass());
+		}
+		Manager->SetCueSet(TestCueSet);
+		Manager->ResetCounters();
+		//every round releases 20 cues per tag, so both limits are hit.
+		const int32 SavedMaxIdle = Manager->GetMaxIdleCues();
+		const int32 SavedMaxIdlePerTag = Manager->GetMaxIdleCuesPerTag();
+		const int32 MaxIdleCues = 12;
+		const int32 MaxIdlePerTag = 8;
+		Manager->SetPoolLimits(MaxIdleCues, MaxIdlePerTag);
+
+		int32 MaxIdle = 0;
+		for (int32 Round = 0; Round < NumRounds; Round++)
+		{
+			RunCueSoakRound(Manager, CueTags, InstigatorsPerRound);
+			MaxIdle = FMath::Max(MaxIdle, Manager->GetNumIdleCues());
+		}
+		TestEqual("No cues playing", Manager->GetNumActiveCues(), 0);
+		TestTrue("Pool bounded by MaxIdleCues", MaxIdle <= MaxIdleCues);
+		TestEqual("Pool filled up to MaxIdleCues", Manager->GetNumIdleCues(), MaxIdleCues);
+		TestTrue("Cues evicted", Manager->GetNumEvicted() > 0);
+
+		//only per tag limit.
+		const uint32 EvictedBefore = Manager->GetNumEvicted();
+		Manager->SetPoolLimits(0, MaxIdlePerTag / 2);
+		RunCueSoakRound(Manager, CueTags, InstigatorsPerRound);
+		TestEqual("Pool bounded by MaxIdleCuesPerTag", Manager->GetNumIdleCues(), (MaxIdlePerTag / 2) * CueTags.Num());
+		TestTrue("Cues evicted per tag", Manager->GetNumEvicted() > EvictedBefore);
+
+		Manager->SetPoolLimits(SavedMaxIdle, SavedMaxIdlePerTag);
+		Manager->SetCueSet(nullptr);
+		Manager->LoadCueSet();
+	}
+	void RunCueSoakRound(UAFCueManager* Manager, const FGameplayTagContainer& CueTags, int32 InNumInstigators)
+	{
+		TArray<AActor*> Instigators;
+		for (int32 Idx = 0; Idx < InNumInstigators; Idx++)
+		{
+			AActor* Instigator = World->SpawnActor<AActor>();
+			Instigators.Add(Instigator);
+			FGAEffectCueParams CueParams(FHitResult(), Instigator, Instigator);
+			CueParams.CueTags = CueTags;
+			Manager->HandleCue(CueTags, CueParams);
+			//half is removed by effect, rest is still playing when instigator goes away.
+			if (Idx % 2 == 0)
+			{
+				Manager->HandleRemoveCue(CueTags, CueParams);
+			}
+		}
+		TestEqual("Cues playing", Manager->GetNumActiveCues(), InNumInstigators);
+		for (AActor* Instigator : Instigators)
+		{
+			Instigator->Destroy();
+		}
+		TestEqual("Instigators released", Manager->GetNumInstigators(), 0);
+	}
+	int32 CountDormantCues(UWorld* InWorld, int32& OutAwake)
+	{
+		int32 Dormant = 0;
+		OutAwake = 0;
+		for (TActorIterator<AGAEffectCue> It(InWorld); It; ++It)
+		{
+			if (It->IsDormant() && It->bHidden && !It->IsActorTickEnabled())
+			{
+				Dormant++;
+			}
+			else
+			{
+				OutAwake++;
+			}
+		}
+		return Dormant;
+	}
+	void Test_CuePrewarmDormancy()
+	{
+		const int32 PrewarmCount = 3;
+		const FGameplayTag CueTag = RequestTag("GameplayCue.Burning");
+		UAFCueSet* TestCueSet = NewObject<UAFCueSet>();
+		TestCueSet->CueClasses.Add(CueTag, AGAEffectCue::StaticClass());
+		TestCueSet->PrewarmCounts.Add(CueTag, PrewarmCount);
+		UAFCueManager* Manager = UAFCueManager::Get(World);
+		Manager->SetCueSet(TestCueSet);
+		Manager->Prewarm();
+		int32 Awake = 0;
+		TestEqual("Pool pre-warmed", Manager->GetNumIdleCues(), PrewarmCount);
+		TestEqual("Pre-warmed cues dormant", CountDormantCues(World, Awake), PrewarmCount);
+		TestEqual("No pre-warmed cue awake", Awake, 0);
+
+		//initializing and pre-warming other world must not touch pools of this one.
+		UWorld* OtherWorld = UWorld::CreateWorld(EWorldType::Game, false);
+		FWorldContext& OtherContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+		OtherContext.SetCurrentWorld(OtherWorld);
+		FURL URL;
+		OtherWorld->InitializeActorsForPlay(URL);
+		OtherWorld->BeginPlay();
+		UAFCueManager* OtherManager = UAFCueManager::Get(OtherWorld);
+		OtherManager->SetCueSet(TestCueSet);
+		OtherManager->Prewarm();
+		TestEqual("Other world pre-warmed", OtherManager->GetNumIdleCues(), PrewarmCount);
+		TestEqual("Other world cues spawned in other world", CountDormantCues(OtherWorld, Awake), PrewarmCount);
+		TestEqual("Pool kept after other world init", Manager->GetNumIdleCues(), PrewarmCount);
+
+		FGAEffectCueParams CueParams(FHitResult(), SourceActor, SourceActor);
+		CueParams.CueTags.AddTag(CueTag);
+		const uint32 Hits = Manager->GetNumPoolHits();
+		Manager->HandleCue(CueParams.CueTags, CueParams);
+		TestEqual("Pre-warmed cue used", Manager->GetNumPoolHits(), Hits + 1);
+		TestEqual("Used cue woken up", CountDormantCues(World, Awake), PrewarmCount - 1);
+		TestEqual("One cue awake", Awake, 1);
+		Manager->HandleRemoveCue(CueParams.CueTags, CueParams);
+		TestEqual("Released cue dormant again", CountDormantCues(World, Awake), PrewarmCount);
+		TestEqual("Nothing awake after release", Awake, 0);
+
+		GEngine->DestroyWorldContext(OtherWorld);
+		OtherWorld->DestroyWorld(false);
+		TestEqual("Pool kept after other world cleanup", Manager->GetNumIdleCues(), PrewarmCount);
+
+		Manager->SetCueSet(nullptr);
+		Manager->LoadCueSet();
+	}
+	void Test_CueRelevancyCulling()
+	{
+		UAFCueManager* Manager = UAFCueManager::Get(World);
+		UAFCueSet* TestCueSet = NewObject<UAFCueSet>();
+		const FGameplayTag CueTag = RequestTag("GameplayCue.Burning");
+		TestCueSet->CueClasses.Add(CueTag, AGAEffectCue::StaticClass());
+		FAFCueRelevancy Relevancy;
+		Relevancy.MaxConcurrent = 2;
+		TestCueSet->Relevancy.Add(CueTag, Relevancy);
+		Manager->SetCueSet(TestCueSet);
+
+		FGAEffectCueParams CueParams(FHitResult(), SourceActor, SourceActor);
+		CueParams.CueTags.AddTag(CueTag);
+		for (int32 Idx = 0; Idx < 3; Idx++)
+		{
+			Manager->HandleCue(CueParams.CueTags, CueParams);
+		}
+		TestEqual("Cues over MaxConcurrent culled", Manager->GetNumActiveCues(), 2);
+		//culled event still has to be removed.
+		for (int32 Idx = 0; Idx < 3; Idx++)
+		{
+			Manager->HandleRemoveCue(CueParams.CueTags, CueParams);
+		}
+		TestEqual("All cues removed", Manager->GetNumActiveCues(), 0);
+		TestEqual("Instigator released", Manager->GetNumInstigators(), 0);
+
+		Manager->SetCueSet(nullptr);
+		Manager->LoadCueSet();
+	}
+	void Test_CueDistanceCulling()
+	{
+		UAFCueManager* Manager = UAFCueManager::Get(World);
+		UAFCueSet* TestCueSet = NewObject<UAFCueSet>();
+		const FGameplayTag CueTag = RequestTag("GameplayCue.Burning");
+		TestCueSet->CueClasses.Add(CueTag, AGAEffectCue::StaticClass());
+		FAFCueRelevancy Relevancy;
+		Relevancy.MaxDistance = 1000;
+		TestCueSet->Relevancy.Add(CueTag, Relevancy);
+		Manager->SetCueSet(TestCueSet);
+
+		//local view at origin, view locations are cached per frame.
+		APlayerController* PC = World->SpawnActor<APlayerController>(FVector::ZeroVector, FRotator::ZeroRotator);
+		GFrameCounter++;
+
+		FGAEffectCueParams NearParams(FHitResult(), SourceActor, SourceActor);
+		NearParams.CueTags.AddTag(CueTag);
+		NearParams.HitResult.Location = FVector(100, 0, 0);
+		FGAEffectCueParams FarParams(FHitResult(), DestActor, DestActor);
+		FarParams.CueTags.AddTag(CueTag);
+		FarParams.HitResult.Location = FVector(100000, 0, 0);
+
+		Manager->HandleCue(NearParams.CueTags, NearParams);
+		Manager->HandleCue(FarParams.CueTags, FarParams);
+		TestEqual("Cue outside MaxDistance culled", Manager->GetNumActiveCues(), 1);
+		TestEqual("Both events handled", Manager->GetNumHandled(CueTag), (uint32)2);
+
+		Manager->HandleRemoveCue(NearParams.CueTags, NearParams);
+		Manager->HandleRemoveCue(FarParams.CueTags, FarParams);
+		TestEqual("All cues removed", Manager->GetNumActiveCues(), 0);
+		TestEqual("Instigators released", Manager->GetNumInstigators(), 0);
+
+		PC->Destroy();
+		GFrameCounter++;
+		Manager->SetCueSet(nullptr);
+		Manager->LoadCueSet();
+	}
+	void Test_CueBatchLimit()
+	{
+		const FGameplayTag CueTag = RequestTag("GameplayCue.Burning");
+		//remote connection's controller, spawned in server net mode so it's not local.
+		BeginServerNetMode();
+		APlayerController* PC = World->SpawnActor<APlayerController>(FVector::ZeroVector, FRotator::ZeroRotator);
+		UAFCueReplicationComponent* Replication = NewObject<UAFCueReplicationComponent>(PC);
+		Replication->CueNetCullDistance = 0;
+		Replication->MaxCueEventsPerFlush = 8;
+		Replication->RegisterComponent();
+
+		FGAEffectCueParams Params(FHitResult(), SourceActor, SourceActor);
+		Params.CueTags.AddTag(CueTag);
+		const int32 NumEvents = 20;
+		for (int32 Idx = 0; Idx < NumEvents; Idx++)
+		{
+			UAFCueReplicationComponent::ReplicateCue(World, Params.CueTags, Params, false);
+		}
+		TestEqual("Burst queued", Replication->GetNumPendingCueEvents(), NumEvents);
+		Replication->FlushCueEvents();
+		TestEqual("Events over limit carried over", Replication->GetNumPendingCueEvents(), NumEvents - 8);
+		Replication->FlushCueEvents();
+		Replication->FlushCueEvents();
+		TestEqual("Carried over events sent", Replication->GetNumPendingCueEvents(), 0);
+		PC->Destroy();
+		EndServerNetMode();
+	}
+	void Test_CueStartBudget()
+	{
+		UAFCueManager* Manager = UAFCueManager::Get(World);
+		UAFCueSet* TestCueSet = NewObject<UAFCueSet>();
+		const FGameplayTag LowTag = RequestTag("GameplayCue.Burning");
+		const FGameplayTag HighTag = RequestTag("Damage.Fire");
+		TestCueSet->CueClasses.Add(LowTag, AGAEffectCue::StaticClass());
+		TestCueSet->CueClasses.Add(HighTag, AGAEffectCue::StaticClass());
+		FAFCueRelevancy HighRelevancy;
+		HighRelevancy.Priority = 10;
+		TestCueSet->Relevancy.Add(HighTag, HighRelevancy);
+		Manager->SetCueSet(TestCueSet);
+		const int32 SavedMaxStarts = Manager->GetMaxCueStartsPerFrame();
+		Manager->SetMaxCueStartsPerFrame(1);
+		GFrameCounter++;
+
+		FGAEffectCueParams LowParams(FHitResult(), SourceActor, SourceActor);
+		LowParams.CueTags.AddTag(LowTag);
+		FGAEffectCueParams HighParams(FHitResult(), DestActor, DestActor);
+		HighParams.CueTags.AddTag(HighTag);
+
+		Manager->HandleCue(LowParams.CueTags, LowParams);
+		Manager->HandleCue(LowParams.CueTags, LowParams);
+		TestEqual("One start per frame", Manager->GetNumActiveCues(), 1);
+		TestEqual("Over budget deferred", Manager->GetNumPendingCues(), 1);
+
+		//budget is free again, but deferred cue is waiting so new one must queue behind it.
+		GFrameCounter++;
+		Manager->HandleCue(HighParams.CueTags, HighParams);
+		TestEqual("New cue does not skip the queue", Manager->GetNumPendingCues(), 2);
+		TestEqual("High priority cue not started yet", Manager->GetNumActiveCues(HighTag), 0);
+
+		TickWorld(0.01f);
+		TestEqual("High priority started first", Manager->GetNumActiveCues(HighTag), 1);
+		TestEqual("Low priority still deferred", Manager->GetNumActiveCues(LowTag), 1);
+		TestEqual("One cue pending", Manager->GetNumPendingCues(), 1);
+
+		TickWorld(0.01f);
+		TestEqual("Queue drained", Manager->GetNumPendingCues(), 0);
+		TestEqual("Every cue started", Manager->GetNumActiveCues(), 3);
+
+		Manager->HandleRemoveCue(LowParams.CueTags, LowParams);
+		Manager->HandleRemoveCue(LowParams.CueTags, LowParams);
+		Manager->HandleRemoveCue(HighParams.CueTags, HighParams);
+		TestEqual("All cues removed", Manager->GetNumActiveCues(), 0);
+		TestEqual("Instigators released", Manager->GetNumInstigators(), 0);
+
+		Manager->SetMaxCueStartsPerFrame(SavedMaxStarts);
+		Manager->SetCueSet(nullptr);
+		Manager->LoadCueSet();
+	}
+	void Test_EffectCues()
+	{
+		UAFCueManager* Manager = UAFCueManager::Get(World);
+		UAFCueSet* TestCueSet = NewObject<UAFCueSet>();
+		const FGameplayTag CueTag = RequestTag("GameplayCue.Burning");
+		TestCueSet->CueClasses.Add(CueTag, AGAEffectCue::StaticClass());
+		Manager->SetCueSet(TestCueSet);
+
+		TArray<FName> OwnedTags;
+		OwnedTags.Add("Ability.Fireball");
+		FGAEffectProperty Effect = CreateEffectDurationSpec(OwnedTags, 5,
+			EGAAttributeMod::Add, TEXT("Health"), EGAEffectStacking::Override);
+		UGAGameEffectSpec* Spec = Effect.GetClass().GetDefaultObject();
+		Spec->Cues.CueTags.AddTag(CueTag);
+		FAFFunctionModifier FuncMod;
+
+		//removed with effect.
+		UGABlueprintLibrary::ApplyGameEffectToActor(Effect, DestActor, SourceActor, SourceActor, FuncMod);
+		TestEqual("Effect cue started", Manager->GetNumActiveCues(), 1);
+		FGAEffectContext Context = UGABlueprintLibrary::MakeContext(DestActor, SourceActor, DestActor, SourceActor, FHitResult(ForceInit));
+		DestComponent->RemoveEffect(Effect, Context);
+		TestEqual("Effect cue removed with effect", Manager->GetNumActiveCues(), 0);
+
+		//removed when effect expires.
+		UGABlueprintLibrary::ApplyGameEffectToActor(Effect, DestActor, SourceActor, SourceActor, FuncMod);
+		TestEqual("Effect cue started again", Manager->GetNumActiveCues(), 1);
+		TickWorld(11.0f);
+		TestEqual("Effect cue removed on expiration", Manager->GetNumActiveCues(), 0);
+		TestEqual("Instigator released", Manager->GetNumInstigators(), 0);
+
+		Spec->Cues.CueTags = FGameplayTagContainer();
+		Manager->SetCueSet(nullptr);
+		Manager->LoadCueSet();
+	}
+	void Test_CueClassStreaming()
+	{
+		UAFCueManager* Manager = UAFCueManager::Get(World);
+		UAFCueSet* TestCueSet = NewObject<UAFCueSet>();
+		const FGameplayTag ResidentTag = RequestTag("GameplayCue.Burning");
+		const FGameplayTag StreamedTag = RequestTag("Damage.Fire");
+		TestCueSet->CueClasses.Add(ResidentTag, AGAEffectCue::StaticClass());
+		TestCueSet->CueClasses.Add(StreamedTag, TAssetSubclassOf<AGAEffectCue>(FStringAssetReference(TEXT("/Game/AFTestMissingCue.AFTestMissingCue_C"))));
+		Manager->SetCueSet(TestCueSet);
+
+		FGAEffectCueParams CueParams(FHitResult(), SourceActor, SourceActor);
+		CueParams.CueTags.AddTag(ResidentTag);
+		CueParams.CueTags.AddTag(StreamedTag);
+		Manager->HandleCue(CueParams.CueTags, CueParams);
+		TestEqual("Only resident cue plays", Manager->GetNumActiveCues(), 1);
+		TestEqual("Missing class requested once", Manager->GetNumRequestedCueClasses(), 1);
+		Manager->HandleCue(CueParams.CueTags, CueParams);
+		TestEqual("Request not repeated", Manager->GetNumRequestedCueClasses(), 1);
+
+		Manager->HandleRemoveCue(CueParams.CueTags, CueParams);
+		Manager->HandleRemoveCue(CueParams.CueTags, CueParams);
+		TestEqual("All cues removed", Manager->GetNumActiveCues(), 0);
+		TestEqual("Instigator released", Manager->GetNumInstigators(), 0);
+
+		Manager->SetCueSet(nullptr);
+		TestEqual("Requests dropped with cue set", Manager->GetNumRequestedCueClasses(), 0);
+		Manager->LoadCueSet();
+	}
+	/* Starts NumCues cues in one frame, offsets animated component of each and ticks sequences once. */
+	double RunCueSequenceTick(UAFCueManager* Manager, const FGameplayTag& InCueTag, int32 InNumCues,
+		TArray<AActor*>& OutInstigators, TArray<AAFTestSequenceCue*>& OutCues)
+	{
+		for (int32 Idx = 0; Idx < InNumCues; Idx++)
+		{
+			AActor* Instigator = World->SpawnActor<AActor>();
+			OutInstigators.Add(Instigator);
+			FGAEffectCueParams CueParams(FHitResult(), Instigator, Instigator);
+			CueParams.CueTags.AddTag(InCueTag);
+			Manager->HandleCue(CueParams.CueTags, CueParams);
+		}
+		for (TActorIterator<AAFTestSequenceCue> It(World); It; ++It)
+		{
+			if (!It->IsDormant())
+			{
+				It->Animated->SetRelativeLocation(FVector(OutCues.Num() * 10.0f, 0, 0));
+				OutCues.Add(*It);
+			}
+		}
+		const double StartTime = FPlatformTime::Seconds();
+		Manager->TickSequenceGroups(0.016f);
+		return (FPlatformTime::Seconds() - StartTime) * 1000.0;
+	}
+	void Test_CueSequenceSharing()
+	{
+		const int32 NumCues = 200;
+		UAFCueManager* Manager = UAFCueManager::Get(World);
+		UAFCueSet* TestCueSet = NewObject<UAFCueSet>();
+		const FGameplayTag CueTag = RequestTag("GameplayCue.Burning");
+		TestCueSet->CueClasses.Add(CueTag, AAFTestSequenceCue::StaticClass());
+		AAFTestSequenceCue* CueCDO = GetMutableDefault<AAFTestSequenceCue>();
+
+		//baseline, every cue evaluates own sequence.
+		CueCDO->bShareSequenceEvaluation = false;
+		Manager->SetCueSet(TestCueSet);
+		TArray<AActor*> Instigators;
+		TArray<AAFTestSequenceCue*> Cues;
+		const double UnsharedMs = RunCueSequenceTick(Manager, CueTag, NumCues, Instigators, Cues);
+		TestEqual("Unshared cues playing", Cues.Num(), NumCues);
+		TestEqual("Unshared cues don't copy leader", Cues.Num() > 1 ? Cues[1]->Animated->RelativeLocation.X : 0.0f, 10.0f);
+		for (AActor* Instigator : Instigators)
+		{
+			Instigator->Destroy();
+		}
+		TestEqual("Groups released", Manager->GetNumSequenceGroups(), 0);
+
+		//opted in, started in one frame, share evaluation of leader.
+		CueCDO->bShareSequenceEvaluation = true;
+		Manager->SetCueSet(TestCueSet);
+		Instigators.Reset();
+		Cues.Reset();
+		const double SharedMs = RunCueSequenceTick(Manager, CueTag, NumCues, Instigators, Cues);
+		TestEqual("Shared cues playing", Cues.Num(), NumCues);
+		int32 NumMirrored = 0;
+		for (AAFTestSequenceCue* Cue : Cues)
+		{
+			if (Cue->Animated->RelativeLocation.Equals(Cues[0]->Animated->RelativeLocation))
+			{
+				NumMirrored++;
+			}
+		}
+		TestEqual("Followers mirror leader", NumMirrored, NumCues);
+		UE_LOG(GameAttributes, Log, TEXT("Test_CueSequenceSharing: %d cues, unshared tick %.3f ms, shared tick %.3f ms"),
+			NumCues, UnsharedMs, SharedMs);
+
+		for (AActor* Instigator : Instigators)
+		{
+			Instigator->Destroy();
+		}
+		TestEqual("No cues playing", Manager->GetNumActiveCues(), 0);
+		TestEqual("Groups released", Manager->GetNumSequenceGroups(), 0);
+
+		Manager->SetCueSet(nullptr);
+		Manager->LoadCueSet();
+	}
+	void Test_CueManagerPerWorld()
+	{
+		UWorld* OtherWorld = UWorld::CreateWorld(EWorldType::Game, false);
+		FWorldContext& OtherContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+		OtherContext.SetCurrentWorld(OtherWorld);
+		FURL URL;
+		OtherWorld->InitializeActorsForPlay(URL);
+		OtherWorld->BeginPlay();
+
+		UAFCueManager* Manager = UAFCueManager::Get(World);
+		UAFCueManager* OtherManager = UAFCueManager::Get(OtherWorld);
+		TestTrue("Every world has own manager", Manager != OtherManager);
+		TestTrue("Same manager for same world", Manager == UAFCueManager::Get(World));
+
+		const FGameplayTag CueTag = RequestTag("GameplayCue.Burning");
+		UAFCueSet* TestCueSet = NewObject<UAFCueSet>();
+		TestCueSet->CueClasses.Add(CueTag, AGAEffectCue::StaticClass());
+		Manager->SetCueSet(TestCueSet);
+		OtherManager->SetCueSet(TestCueSet);
+
+		AActor* OtherInstigator = OtherWorld->SpawnActor<AActor>();
+		FGAEffectCueParams CueParams(FHitResult(), OtherInstigator, OtherInstigator);
+		CueParams.CueTags.AddTag(CueTag);
+		OtherManager->HandleCue(CueParams.CueTags, CueParams);
+		TestEqual("Cue plays in its world", OtherManager->GetNumActiveCues(), 1);
+		TestEqual("Other world pool untouched", Manager->GetNumActiveCues(), 0);
+		int32 CuesInOtherWorld = 0;
+		for (TActorIterator<AGAEffectCue> It(OtherWorld); It; ++It)
+		{
+			CuesInOtherWorld++;
+		}
+		TestEqual("Cue actor spawned into instigator world", CuesInOtherWorld, 1);
+
+		const int32 NumManagers = UAFCueManager::GetNumWorldManagers();
+		GEngine->DestroyWorldContext(OtherWorld);
+		OtherWorld->DestroyWorld(false);
+		TestEqual("Manager destroyed with world", UAFCueManager::GetNumWorldManagers(), NumManagers - 1);
+		TestTrue("Manager not recreated after cleanup", UAFCueManager::Get(OtherWorld) == nullptr);
+		TestEqual("No manager registered for cleaned up world", UAFCueManager::GetNumWorldManagers(), NumManagers - 1);
+
+		Manager->SetCueSet(nullptr);
+		Manager->LoadCueSet();
+	}
+	void Test_CueCounters()
+	{
+		UAFCueManager* Manager = UAFCueManager::Get(World);
+		UAFCueSet* TestCueSet = NewObject<UAFCueSet>();
+		const FGameplayTag CueTag = RequestTag("GameplayCue.Burning");
+		TestCueSet->CueClasses.Add(CueTag, AGAEffectCue::StaticClass());
+		Manager->SetCueSet(TestCueSet);
+		Manager->ResetCounters();
+
+		FGAEffectCueParams CueParams(FHitResult(), SourceActor, SourceActor);
+		CueParams.CueTags.AddTag(CueTag);
+		Manager->HandleCue(CueParams.CueTags, CueParams);
+		Manager->HandleRemoveCue(CueParams.CueTags, CueParams);
+		Manager->HandleCue(CueParams.CueTags, CueParams);
+		Manager->HandleRemoveCue(CueParams.CueTags, CueParams);
+		TestEqual("Handled per tag", Manager->GetNumHandled(CueTag), 2u);
+		TestEqual("First cue spawned", Manager->GetNumPoolMisses(), 1u);
+		TestEqual("Second cue reused", Manager->GetNumPoolHits(), 1u);
+		TestTrue("Spawn time measured", Manager->GetAverageSpawnTimeMs() >= 0.0);
+		Manager->DumpCounters(*GLog);
+		Manager->ResetCounters();
+		TestEqual("Counters reset", Manager->GetNumHandled(CueTag), 0u);
+
+		Manager->SetCueSet(nullptr);
+		Manager->LoadCueSet();
+	}
+	void Test_EffectEventParentTagFanOut()
+	{
+		const FGameplayTag DamageTag = RequestTag("Damage");
+		const FGameplayTag FireTag = RequestTag("Damage.Fire");
+		int32 DamageCalls = 0;
+		int32 FireCalls = 0;
+		int32 OnceCalls = 0;
+
+		FAFEffectEventTable& Table = FAFEffectEventTable::FindOrAdd(SourceActor);
+		FDelegateHandle DamageHandle = Table.AddEventListener(DamageTag,
+			FAFEffectEventListener::CreateLambda([&DamageCalls](FAFEventData) { DamageCalls++; }));
+		FDelegateHandle FireHandle = Table.AddEventListener(FireTag,
+			FAFEffectEventListener::CreateLambda([&FireCalls](FAFEventData) { FireCalls++; }));
+		FDelegateHandle OnceHandle;
+		OnceHandle = Table.AddEventListener(FireTag,
+			FAFEffectEventListener::CreateLambda([&, FireTag](FAFEventData)
+		{
+			OnceCalls++;
+			FAFEffectEventTable::Find(SourceActor)->RemoveEventListener(FireTag, OnceHandle);
+		}));
+		TestEqual("Listeners bound", Table.GetNumListeners(), 3);
+
+		FAFEventData EventData;
+		Table.BroadcastEvent(FireTag, EventData);
+		TestEqual("Parent listener fires for child tag", DamageCalls, 1);
+		TestEqual("Child listener fires", FireCalls, 1);
+		TestEqual("Listener removed itself", OnceCalls, 1);
+
+		Table.BroadcastEvent(DamageTag, EventData);
+		TestEqual("Parent listener fires for own tag", DamageCalls, 2);
+		TestEqual("Child listener doesn't fire for parent tag", FireCalls, 1);
+
+		Table.BroadcastEvent(FireTag, EventData);
+		TestEqual("Removed listener doesn't fire", OnceCalls, 1);
+		TestEqual("Parent listener fires again", DamageCalls, 3);
+
+		Table.RemoveEventListener(DamageTag, DamageHandle);
+		Table.BroadcastEvent(FireTag, EventData);
+		TestEqual("Parent listener removed from child list", DamageCalls, 3);
+		TestEqual("Child listener still fires", FireCalls, 3);
+
+		FAFEffectEventTable::Find(SourceActor)->RemoveEventListener(FireTag, FireHandle);
+		TestTrue("Empty table released", FAFEffectEventTable::Find(SourceActor) == nullptr);
+	}
+	void Test_EffectEventTableLifetime()
+	{
+		const FGameplayTag DamageTag = RequestTag("Damage");
+		const FGameplayTag FireTag = RequestTag("Damage.Fire");
+		int32 DamageCalls = 0;
+		int32 SecondCalls = 0;
+
+		//events component fires itself reach table listeners.
+		FAFEffectEventTable& Table = FAFEffectEventTable::FindOrAdd(SourceComponent);
+		Table.AddEventListener(DamageTag,
+			FAFEffectEventListener::CreateLambda([&DamageCalls](FAFEventData) { DamageCalls++; }));
+		FAFEventData EventData;
+		SourceComponent->NativeTriggerTagEvent(FireTag, EventData);
+		TestEqual("Component event routed to table", DamageCalls, 1);
+
+		//removing owner from listener is deferred until broadcast ends.
+		FAFEffectEventTable::FindOrAdd(SourceComponent).AddEventListener(FireTag,
+			FAFEffectEventListener::CreateLambda([&](FAFEventData) { FAFEffectEventTable::Remove(SourceComponent); }));
+		FAFEffectEventTable::FindOrAdd(SourceComponent).AddEventListener(FireTag,
+			FAFEffectEventListener::CreateLambda([&SecondCalls](FAFEventData) { SecondCalls++; }));
+		SourceComponent->NativeTriggerTagEvent(FireTag, EventData);
+		TestEqual("Listener after removal not called", SecondCalls, 0);
+		TestTrue("Removed table released", FAFEffectEventTable::Find(SourceComponent) == nullptr);
+		SourceComponent->NativeTriggerTagEvent(FireTag, EventData);
+		TestEqual("Released table unbound from component", DamageCalls, 2);
+
+		FAFEffectEventTable::FindOrAdd(SourceActor).AddEventListener(DamageTag,
+			FAFEffectEventListener::CreateLambda([](FAFEventData) {}));
+		FAFEffectEventTable::HandleWorldCleanup(World, true, true);
+		TestTrue("Table released on world cleanup", FAFEffectEventTable::Find(SourceActor) == nullptr);
+	}
+	void Test_CueReplicationBandwidth()
+	{
+		const int32 NumClients = 32;
+		const int32 NumInstigators = 64;
+		const int32 CuesPerInstigator = 4;
+		const float CullDistance = 15000;
+		const float WorldHalfSize = 40000;
+		//approximate bunch header and RPC function index, paid by every RPC.
+		const int64 RPCOverheadBits = 64;
+		const FGameplayTag CueTag = RequestTag("GameplayCue.Burning");
+		FRandomStream Rand(1234);
+		UAFTestPackageMap* PackageMap = NewObject<UAFTestPackageMap>();
+
+		TArray<FVector> Views;
+		for (int32 Idx = 0; Idx < NumClients; Idx++)
+		{
+			Views.Add(FVector(Rand.FRandRange(-WorldHalfSize, WorldHalfSize), Rand.FRandRange(-WorldHalfSize, WorldHalfSize), 0));
+		}
+		TArray<FAFCueEventBatch> Batches;
+		Batches.SetNum(NumClients);
+		int64 BaselineBits = 0;
+		TArray<AActor*> Instigators;
+		for (int32 InstigatorIdx = 0; InstigatorIdx < NumInstigators; InstigatorIdx++)
+		{
+			const FVector InstigatorLocation(Rand.FRandRange(-WorldHalfSize, WorldHalfSize), Rand.FRandRange(-WorldHalfSize, WorldHalfSize), 0);
+			AActor* Instigator = World->SpawnActor<AActor>();
+			Instigators.Add(Instigator);
+			for (int32 CueIdx = 0; CueIdx < CuesPerInstigator; CueIdx++)
+			{
+				FGAEffectCueParams CueParams(FHitResult(), Instigator, Instigator);
+				CueParams.HitResult.Location = InstigatorLocation + Rand.GetUnitVector() * 500;
+				CueParams.HitResult.ImpactPoint = CueParams.HitResult.Location;
+				CueParams.HitResult.ImpactNormal = FVector::UpVector;
+				CueParams.HitResult.Normal = FVector::UpVector;
+				CueParams.Period = 1;
+				CueParams.Duration = 5;
+				CueParams.CueTags.AddTag(CueTag);
+
+				FAFPackedCueEvent Event = FAFPackedCueEvent::Pack(CueTag, CueParams, false);
+
+				//previous path, multicast RPC per cue with FGAEffectCueParams parameter.
+				//RPC parameters are written like FRepLayout does: bit per parameter, then every property of struct.
+				FNetBitWriter Baseline(PackageMap, 0);
+				Baseline.WriteBit(1);
+				for (TFieldIterator<UProperty> It(FGAEffectCueParams::StaticStruct()); It; ++It)
+				{
+					It->NetSerializeItem(Baseline, PackageMap, It->ContainerPtrToValuePtr<void>(&CueParams));
+				}
+
+				for (int32 ClientIdx = 0; ClientIdx < NumClients; ClientIdx++)
+				{
+					if (FVector::DistSquared(Views[ClientIdx], CueParams.HitResult.Location) > FMath::Square(CullDistance))
+					{
+						continue;
+					}
+					BaselineBits += RPCOverheadBits + Baseline.GetNumBits();
+					Batches[ClientIdx].Events.Add(Event);
+				}
+			}
+		}
+
+		int64 BatchedBits = 0;
+		int32 NumEvents = 0;
+		for (FAFCueEventBatch& Batch : Batches)
+		{
+			if (Batch.Events.Num() == 0)
+			{
+				continue;
+			}
+			//ClientReceiveCueBatch, bit for parameter, array count and events.
+			FNetBitWriter Writer(PackageMap, 0);
+			Writer.WriteBit(1);
+			uint16 Count = Batch.Events.Num();
+			Writer << Count;
+			for (FAFPackedCueEvent& Event : Batch.Events)
+			{
+				bool bSuccess = true;
+				Event.NetSerialize(Writer, PackageMap, bSuccess);
+			}
+			BatchedBits += RPCOverheadBits + Writer.GetNumBits();
+			NumEvents += Batch.Events.Num();
+		}
+
+		//packed event survives round trip.
+		{
+			FBitWriter Writer(0, true);
+			FAFPackedCueEvent Event = Batches.Num() > 0 && Batches[0].Events.Num() > 0 ? Batches[0].Events[0] : FAFPackedCueEvent();
+			bool bSuccess = true;
+			Event.NetSerialize(Writer, PackageMap, bSuccess);
+			FBitReader Reader(Writer.GetData(), Writer.GetNumBits());
+			FAFPackedCueEvent Read;
+			Read.NetSerialize(Reader, PackageMap, bSuccess);
+			TestTrue("Location quantized", Read.Location.Equals(Event.Location, 0.2f));
+			TestEqual("Tag index", Read.TagIndex, Event.TagIndex);
+			TestTrue("Instigator serialized trough package map", Event.Instigator.IsValid() && Read.Instigator == Event.Instigator);
+			TestEqual("Duration", Read.Duration, Event.Duration);
+		}
+
+		TestTrue("Batched cues use less bandwidth", BatchedBits < BaselineBits);
+		UE_LOG(GameAttributes, Log, TEXT("Test_CueReplicationBandwidth: %d clients, %d relevant cue events, RPC per cue %lld bytes, batched %lld bytes"),
+			NumClients, NumEvents, BaselineBits / 8, BatchedBits / 8);
+		for (AActor* Instigator : Instigators)
+		{
+			Instigator->Destroy();
+		}
+	}
 };
 #define ADD_TEST(Name) \
 	TestFunctions.Add(&GameEffectsTestSuite::Name); \
@@ -1571,6 +2979,39 @@ public:
 		ADD_TEST(Test_EffectStatckingDurationDifferentEffects);
 		ADD_TEST(Test_EffectStatckingDurationSameEffects);
 		ADD_TEST(Test_StrongerOverrideNonStackingHealthBonus);
+		ADD_TEST(Test_ManyPeriodicEffects);
+		ADD_TEST(Test_EffectExtensionPool);
+		ADD_TEST(Test_BakedCurveExtrapolation);
+		ADD_TEST(Test_AttributeCaptureModes);
+		ADD_TEST(Test_BatchCustomCalculation);
+		ADD_TEST(Test_ParallelAbilityUpdate);
+		ADD_TEST(Test_AlwaysTickAbilityCollected);
+		ADD_TEST(Test_CancelledAbilityStopsTicking);
+		ADD_TEST(Test_AbilityCooldownGroups);
+		ADD_TEST(Test_AbilityCooldownOnServer);
+		ADD_TEST(Test_NonInstancedAbility);
+		ADD_TEST(Test_NonInstancedAbilityOnServer);
+		ADD_TEST(Test_AsyncTargetDataTrace);
+		ADD_TEST(Test_SpatialIndexQueries);
+		ADD_TEST(Test_EffectFieldPulse);
+		ADD_TEST(Test_AbilityTaskPooling);
+		ADD_TEST(Test_LatentActionScheduler);
+#if WITH_AF_CUES
+		ADD_TEST(Test_CuePoolSoak);
+		ADD_TEST(Test_CuePrewarmDormancy);
+		ADD_TEST(Test_CueRelevancyCulling);
+		ADD_TEST(Test_CueDistanceCulling);
+		ADD_TEST(Test_CueStartBudget);
+		ADD_TEST(Test_CueBatchLimit);
+		ADD_TEST(Test_EffectCues);
+		ADD_TEST(Test_CueClassStreaming);
+		ADD_TEST(Test_CueSequenceSharing);
+		ADD_TEST(Test_CueManagerPerWorld);
+		ADD_TEST(Test_CueCounters);
+#endif //WITH_AF_CUES
+		ADD_TEST(Test_CueReplicationBandwidth);
+		ADD_TEST(Test_EffectEventParentTagFanOut);
+		ADD_TEST(Test_EffectEventTableLifetime);
 	};
 	virtual uint32 GetTestFlags() const override 
 	{
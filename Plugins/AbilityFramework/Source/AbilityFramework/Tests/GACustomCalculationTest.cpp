@@ -3,6 +3,7 @@
 #include "AbilityFramework.h"
 #include "GAAttributesTest.h"
 #include "GACustomCalculationTest.h"
+#include "../AFAbilityComponent.h"
 
 
 
@@ -19,4 +20,49 @@ float UGACustomCalculationTest::NativeCalculateMagnitude(const FGAEffectHandle&
 		return MagicBonus - MagicResistance;*/
 	}
 	return 0;
-}
\ No newline at end of file
+}
+float UGACustomCalculationTest::NativeCalculateMagnitudeFromContext(const FGAEffectHandle& HandleIn, const FGAEffectContext& InContext)
+{
+	UGAAttributesTest* InstAttr = Cast<UGAAttributesTest>(InContext.GetInstigatorAttributes());
+	if (InstAttr)
+	{
+		return InstAttr->Health.GetFinalValue() * 0.1f;
+	}
+	return 0;
+}
+
+float UGACustomCalculationHandleTest::NativeCalculateMagnitude(const FGAEffectHandle& HandleIn)
+{
+	UGAAttributesTest* InstAttr = Cast<UGAAttributesTest>(HandleIn.GetContext().GetInstigatorAttributes());
+	if (InstAttr)
+	{
+		return InstAttr->Health.GetFinalValue();
+	}
+	return 0;
+}
+
+void UGACustomCalculationBatchTest::NativeCalculateMagnitudes(const TArray<FGAEffectHandle>& InHandles,
+	const TArray<const FGAEffectContext*>& InContexts, TArray<float>& OutMagnitudes)
+{
+	const int32 Num = InContexts.Num();
+	OutMagnitudes.SetNumUninitialized(Num, false);
+	//most of the batch comes from the same instigator, so resolve attributes only when it changes.
+	const UAFAbilityComponent* LastComp = nullptr;
+	float LastHealth = 0;
+	for (int32 Idx = 0; Idx < Num; Idx++)
+	{
+		const FGAEffectContext* Context = InContexts[Idx];
+		const UAFAbilityComponent* Comp = Context->InstigatorComp.Get();
+		if (Comp != LastComp)
+		{
+			UGAAttributesTest* InstAttr = Cast<UGAAttributesTest>(Context->GetInstigatorAttributes());
+			LastHealth = InstAttr ? InstAttr->Health.GetFinalValue() : 0;
+			LastComp = Comp;
+		}
+		OutMagnitudes[Idx] = LastHealth;
+	}
+	for (int32 Idx = 0; Idx < Num; Idx++)
+	{
+		OutMagnitudes[Idx] *= 0.1f;
+	}
+}
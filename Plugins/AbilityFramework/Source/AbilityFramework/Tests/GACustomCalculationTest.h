@@ -15,5 +15,32 @@ class ABILITYFRAMEWORK_API UGACustomCalculationTest : public UGACustomCalculatio
 	
 public:
 	virtual float NativeCalculateMagnitude(const FGAEffectHandle& HandleIn) override;
-	
+	/* 10% of instigator Health. Used by batch benchmark trough default loop. */
+	virtual float NativeCalculateMagnitudeFromContext(const FGAEffectHandle& HandleIn, const FGAEffectContext& InContext) override;
+};
+
+/*
+	Same formula as UGACustomCalculationTest, but resolves attributes for whole batch first
+	and then runs formula over plain array.
+*/
+UCLASS()
+class ABILITYFRAMEWORK_API UGACustomCalculationBatchTest : public UGACustomCalculationTest
+{
+	GENERATED_BODY()
+
+public:
+	virtual void NativeCalculateMagnitudes(const TArray<FGAEffectHandle>& InHandles,
+		const TArray<const FGAEffectContext*>& InContexts, TArray<float>& OutMagnitudes) override;
+};
+
+/*
+	Calculation written before context path existed, reads everything from handle.
+*/
+UCLASS()
+class ABILITYFRAMEWORK_API UGACustomCalculationHandleTest : public UGACustomCalculation
+{
+	GENERATED_BODY()
+
+public:
+	virtual float NativeCalculateMagnitude(const FGAEffectHandle& HandleIn) override;
 };
@@ -1,5 +1,6 @@
 // Fill out your copyright notice in the Description page of Project Settings.
 
+#include "Abilities/GAAbilityBase.h"
 #include "ARAICharacter.h"
 
 
@@ -15,7 +16,22 @@ AARAICharacter::AARAICharacter()
 void AARAICharacter::BeginPlay()
 {
 	Super::BeginPlay();
-	
+	AbilityStates.Initialize(Abilities);
+	for (TSubclassOf<UGAAbilityBase> AbilityClass : DefaultAbilities)
+	{
+		if (!AbilityClass)
+		{
+			continue;
+		}
+		if (AbilityClass->GetDefaultObject<UGAAbilityBase>()->Instancing == EAFAbilityInstancing::NonInstanced)
+		{
+			AbilityStates.AddAbility(AbilityClass);
+		}
+		else
+		{
+			Abilities->NativeAddAbility(AbilityClass, nullptr, FGameplayTag(), false);
+		}
+	}
 }
 
 // Called every frame
@@ -32,6 +48,19 @@ void AARAICharacter::SetupPlayerInputComponent(UInputComponent* PlayerInputCompo
 
 }
 
+bool AARAICharacter::ActivateNonInstancedAbility(FGameplayTag InAbilityTag)
+{
+	return AbilityStates.ActivateAbility(AbilityStates.FindAbility(InAbilityTag));
+}
+void AARAICharacter::FinishNonInstancedAbility(FGameplayTag InAbilityTag)
+{
+	AbilityStates.FinishAbility(AbilityStates.FindAbility(InAbilityTag));
+}
+bool AARAICharacter::CanUseNonInstancedAbility(FGameplayTag InAbilityTag) const
+{
+	return AbilityStates.CanUseAbility(AbilityStates.FindAbility(InAbilityTag));
+}
+
 /* IAFAbilityInterface- BEGIN */
 
 class UGAAttributesBase* AARAICharacter::GetAttributes()
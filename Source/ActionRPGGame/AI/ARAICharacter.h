@@ -7,6 +7,7 @@
 #include "GameplayTags.h"
 #include "AFAbilityComponent.h"
 #include "AFAbilityInterface.h"
+#include "Abilities/AFNonInstancedAbility.h"
 
 #include "ARAICharacter.generated.h"
 
@@ -17,6 +18,14 @@ class ACTIONRPGGAME_API AARAICharacter : public ACharacter, public IAFAbilityInt
 protected:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Camera, meta = (AllowPrivateAccess = "true"))
 		class UAFAbilityComponent* Abilities;
+	/*
+		Abilities given on BeginPlay. NonInstanced ones only get entry in AbilityStates,
+		instanced ones are added to component as usual.
+	*/
+	UPROPERTY(EditAnywhere, Category = "Abilities")
+		TArray<TSubclassOf<class UGAAbilityBase>> DefaultAbilities;
+	UPROPERTY()
+		FAFNonInstancedAbilityContainer AbilityStates;
 public:
 	// Sets default values for this character's properties
 	AARAICharacter();
@@ -33,6 +42,13 @@ public:
 	virtual void SetupPlayerInputComponent(class UInputComponent* PlayerInputComponent) override;
 
 	
+	UFUNCTION(BlueprintCallable, Category = "AbilityFramework|Abilities")
+		bool ActivateNonInstancedAbility(FGameplayTag InAbilityTag);
+	UFUNCTION(BlueprintCallable, Category = "AbilityFramework|Abilities")
+		void FinishNonInstancedAbility(FGameplayTag InAbilityTag);
+	UFUNCTION(BlueprintPure, Category = "AbilityFramework|Abilities")
+		bool CanUseNonInstancedAbility(FGameplayTag InAbilityTag) const;
+
 	/* IAFAbilityInterface- BEGIN */
 	UFUNCTION(BlueprintCallable, Category = "AbilityFramework|Attributes")
 		virtual class UGAAttributesBase* GetAttributes() override;
@@ -3,12 +3,14 @@
 #include "ARPlayerController.h"
 #include "ARUIComponent.h"
 #include "ARUIAbilityManagerComponent.h"
+#include "AFCueReplication.h"
 
 AARPlayerController::AARPlayerController(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
 {
 	UIComponent = ObjectInitializer.CreateDefaultSubobject<UARUIComponent>(this, "UIComponent");
 	UIAbilityManagerComponent = ObjectInitializer.CreateDefaultSubobject<UARUIAbilityManagerComponent>(this, "UIAbilityManagerComponent");
+	CueReplication = ObjectInitializer.CreateDefaultSubobject<UAFCueReplicationComponent>(this, "CueReplication");
 }
 
 void AARPlayerController::SetupInputComponent()
@@ -18,6 +18,8 @@ public:
 		class UARUIComponent* UIComponent;
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components|UI")
 		class UARUIAbilityManagerComponent* UIAbilityManagerComponent;
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components|Cues")
+		class UAFCueReplicationComponent* CueReplication;
 
 public:
 	AARPlayerController(const FObjectInitializer& ObjectInitializer);
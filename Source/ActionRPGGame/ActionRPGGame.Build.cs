@@ -40,5 +40,7 @@ public class ActionRPGGame : ModuleRules
             );
         PublicDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject", "Engine", "InputCore",
             "GameplayTags", "AbilityFramework", "SlateCore" });
+        //dedicated server never creates widgets.
+        Definitions.Add(Target.Type == TargetRules.TargetType.Server ? "WITH_AR_UI=0" : "WITH_AR_UI=1");
 	}
 }
@@ -9,6 +9,7 @@
 #include "Engine/AssetManager.h"
 #include "ARAbilityBase.h"
 #include "ARAbilityUIData.h"
+#include "AFCueManager.h"
 // Sets default values for this component's properties
 UARUIAbilityManagerComponent::UARUIAbilityManagerComponent()
 {
@@ -38,29 +39,35 @@ void UARUIAbilityManagerComponent::BeginPlay()
 
 	ActiveSet = 0;
 
-	
-	if (AbilitySetConfigClass)
-	{
-		AbilitySetConfigWidget = CreateWidget<UUserWidget>(Cast<APlayerController>(GetOwner()), AbilitySetConfigClass);
-		//AbilitySetConfigWidget->InitializeWidget(this);
-		AbilitySetConfigWidget->AddToViewport();
-	}
-	if (AbilityWidgetClass)
-	{
-		AbilityWidget = CreateWidget<UARAbilityInfoWidget>(Cast<APlayerController>(GetOwner()), AbilityWidgetClass);
-		AbilityWidget->InitializeWidget(this);
-	}
-	if (WeaponWidgetClass)
+#if WITH_AR_UI
+	APlayerController* OwningPC = Cast<APlayerController>(GetOwner());
+	//listen server has controllers of remote players too.
+	if (OwningPC && OwningPC->IsLocalController())
 	{
-		WeaponWidget = CreateWidget<UARWeaponInfoWidget>(Cast<APlayerController>(GetOwner()), WeaponWidgetClass);
-		WeaponWidget->InitializeWidget(this);
-	}
+		if (AbilitySetConfigClass)
+		{
+			AbilitySetConfigWidget = CreateWidget<UUserWidget>(OwningPC, AbilitySetConfigClass);
+			//AbilitySetConfigWidget->InitializeWidget(this);
+			AbilitySetConfigWidget->AddToViewport();
+		}
+		if (AbilityWidgetClass)
+		{
+			AbilityWidget = CreateWidget<UARAbilityInfoWidget>(OwningPC, AbilityWidgetClass);
+			AbilityWidget->InitializeWidget(this);
+		}
+		if (WeaponWidgetClass)
+		{
+			WeaponWidget = CreateWidget<UARWeaponInfoWidget>(OwningPC, WeaponWidgetClass);
+			WeaponWidget->InitializeWidget(this);
+		}
 
-	if (WeaponCrosshairWidgetClass)
-	{
-		WeaponCrosshairWidget = CreateWidget<UUserWidget>(Cast<APlayerController>(GetOwner()), WeaponCrosshairWidgetClass);
-		WeaponCrosshairWidget->AddToViewport();
+		if (WeaponCrosshairWidgetClass)
+		{
+			WeaponCrosshairWidget = CreateWidget<UUserWidget>(OwningPC, WeaponCrosshairWidgetClass);
+			WeaponCrosshairWidget->AddToViewport();
+		}
 	}
+#endif //WITH_AR_UI
 	APlayerController* MyPC = Cast<APlayerController>(GetOwner());
 	if (!MyPC)
 		return;
@@ -138,6 +145,13 @@ void UARUIAbilityManagerComponent::NativeEquipAbility(const FGameplayTag& InAbil
 		AbilityComp->OnAbilityAdded.AddDynamic(this, &UARUIAbilityManagerComponent::OnAbilityReady);
 	}
 	TSubclassOf<UGAAbilityBase> AbilityClass = AbilityData->Items.FindRef(InAbilityTag).AbilityClass;
+#if WITH_AF_CUES
+	//so first use of ability doesn't wait for it's cues to stream in.
+	if (UAFCueManager* CueManager = UAFCueManager::Get(GetWorld()))
+	{
+		CueManager->PreloadAbilityCues(AbilityClass);
+	}
+#endif //WITH_AF_CUES
 	FARAbilityEquipInfo ABInfo(AbilitySet, AbilityIndex, GetInputTag(AbilitySet, AbilityIndex));
 	AwatingAbilityConfimation.Add(InAbilityTag, ABInfo);
 	AbilityComp->NativeAddAbilityFromTag(InAbilityTag, nullptr, GetInputTag(AbilitySet, AbilityIndex));